@@ -0,0 +1,23 @@
+#include "object3d.hlsli"
+
+ConstantBuffer<TransformationMatrix> gTransformationMatrix : register(b0);
+
+
+// 圧縮した頂点（VertexFormat::PackedQuantized / PackedHalf）
+// 位置はUNORMかhalfのままWVPに掛ける（量子化の復元はWVPに含めてある）
+// UVはhalf、法線は八面体写像のSNORM2つ
+struct VertexShaderInput
+{
+    float32_t4 position : POSITION0;
+    float32_t2 texcoord : TEXCOORD0;
+    float32_t2 normal : NORMAL0;
+};
+
+VertexShaderOutput main(VertexShaderInput input)
+{
+    VertexShaderOutput output;
+    output.position = mul(input.position, gTransformationMatrix.WVP);
+    output.texcoord = input.texcoord;
+    output.normal = normalize(mul(DecodeOctahedral(input.normal), (float32_t3x3)gTransformationMatrix.World));
+    return output;
+}
\ No newline at end of file
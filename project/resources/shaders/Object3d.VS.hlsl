@@ -1,9 +1,5 @@
 #include "object3d.hlsli"
 
-struct TransformationMatrix
-{
-    float32_t4x4 WVP;
-};
 ConstantBuffer<TransformationMatrix> gTransformationMatrix : register(b0);
 
 
@@ -12,6 +8,7 @@ struct VertexShaderInput
 {
     float32_t4 position : POSITION0;
     float32_t2 texcoord : TEXCOORD0;
+    float32_t3 normal : NORMAL0;
 };
 
 VertexShaderOutput main(VertexShaderInput input)
@@ -19,6 +16,6 @@ VertexShaderOutput main(VertexShaderInput input)
     VertexShaderOutput output;
     output.position = mul(input.position, gTransformationMatrix.WVP);
     output.texcoord = input.texcoord;
+    output.normal = normalize(mul(input.normal, (float32_t3x3)gTransformationMatrix.World));
     return output;
-}
-
+}
\ No newline at end of file
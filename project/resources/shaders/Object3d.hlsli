@@ -1,5 +1,23 @@
+
 struct VertexShaderOutput
 {
     float32_t4 position : SV_Position;
     float32_t2 texcoord : TEXCOORD0;
-};
\ No newline at end of file
+    float32_t3 normal : NORMAL0;
+};
+
+struct TransformationMatrix
+{
+    float32_t4x4 WVP;
+    float32_t4x4 World;
+};
+
+// 八面体写像から法線へ（VertexCompression::DecodeOctahedralと同じ計算）
+float32_t3 DecodeOctahedral(float32_t2 encoded)
+{
+    float32_t3 normal = float32_t3(encoded.x, encoded.y, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float32_t t = max(-normal.z, 0.0f);
+    normal.x += normal.x >= 0.0f ? -t : t;
+    normal.y += normal.y >= 0.0f ? -t : t;
+    return normalize(normal);
+}
\ No newline at end of file
@@ -15,6 +15,8 @@
 #define DIRECTINPUT_VERSION   0x0800 //DirectInput
 #include <dinput.h>
 #include <iostream>
+#include <format>
+#include <algorithm>
 
 
 #include <combaseapi.h> // CoInitializeEx
@@ -23,13 +25,22 @@
 #include"WinApp.h"
 #include"DirectXCommon.h"
 #include"StringUtility.h"
+#include"Logger.h"
 
 #include"TextureManager.h"
+#include"MaterialLibrary.h"
+#include"ObjLoader.h"
+#include"MeshCache.h"
+#include"MeshSimplifier.h"
+#include"MeshletUtility.h"
+#include"VertexCompression.h"
 #include"Sprite.h"
 #include"SpriteCommon.h"
 
 
 #include "Matrix4x4.h"
+#include "Culling.h"
+#include "TransformHierarchy.h"
 #include "Vector2.h"
 #include "Vector4.h"
 
@@ -74,17 +85,15 @@ struct Matrix3x3
 	float m[3][3] = { 0 };
 };
 
-struct Transform
-{
-	Vector3 scale;
-	Vector3 rotate;
-	Vector3 translate;
-};
+// モデルの頂点バッファの形式
+// 圧縮するとGPUが毎フレーム読む量が36バイトから16バイトになる。Floatにすると圧縮しない頂点で描けるので、見た目や速さを比べるときに切り替える
+constexpr VertexFormat kModelVertexFormat = VertexFormat::PackedQuantized;
+
 // transformの初期化
 Transform transform
 {
 	{ 1.0f, 1.0f, 1.0f }, // scale
-	{ 0.0f, 0.0f, 0.0f }, // rotate
+	{ 0.0f, 3.0f, 0.0f }, // rotate（y軸回転は固定）
 	{ 0.0f, 0.0f, 0.0f }  // translate
 };
 
@@ -106,14 +115,6 @@ Transform cameraTransform
 };
 
 
-// 頂点データ
-struct VertexData
-{
-	Vector4 position; // 頂点座標
-	Vector2 texcoord; // テクスチャ座標
-	Vector3 normal; // 正規化座標
-};
-
 struct Material
 {
 	Vector4 color;
@@ -135,17 +136,6 @@ struct DirectionalLight
 	float intensity; // 輝度
 };
 
-struct MaterialData
-{
-	std::string textureFilePath;
-};
-
-struct ModelData
-{
-	std::vector<VertexData> vertices;
-	MaterialData material;
-};
-
 // チャンクヘッダ
 struct ChunkHeader
 {
@@ -273,187 +263,6 @@ Microsoft::WRL::ComPtr <ID3D12DescriptorHeap> CreateDescriptorHeap
 
 
 
-// 正規化関数
-void Normalize(float& x, float& y, float& z)
-{
-	float len = std::sqrt(x * x + y * y + z * z);
-	if (len > 0.00001f)
-	{
-		x /= len;
-		y /= len;
-		z /= len;
-	}
-}
-
-// 球を描画する関数
-void DrawSphere(VertexData vertexData[])
-{
-	const uint32_t kSubdivision = 20;
-	const float kLonEvery = 2.0f * float(M_PI) / float(kSubdivision);
-	const float kLatEvery = float(M_PI) / float(kSubdivision);
-
-	for (uint32_t latIndex = 0; latIndex < kSubdivision; ++latIndex)
-	{
-		float lat = float(M_PI) / 2.0f - kLatEvery * latIndex;
-		float latNext = float(M_PI) / 2.0f - kLatEvery * (latIndex + 1);
-
-		for (uint32_t lonIndex = 0; lonIndex < kSubdivision; ++lonIndex)
-		{
-			uint32_t start = (latIndex * kSubdivision + lonIndex) * 6;
-			float lon = kLonEvery * lonIndex;
-			float lonNext = kLonEvery * (lonIndex + 1);
-
-			// a
-			VertexData a;
-			a.position = { cos(lat) * cos(lon), sin(lat), cos(lat) * sin(lon), 1.0f };
-			a.texcoord = { 1.0f - (lon / (2.0f * float(M_PI))), 1.0f - ((lat + float(M_PI) / 2.0f) / float(M_PI)) };
-			a.normal = { a.position.x, a.position.y, a.position.z };
-
-			// b
-			VertexData b;
-			b.position = { cos(latNext) * cos(lon), sin(latNext), cos(latNext) * sin(lon), 1.0f };
-			b.texcoord = { 1.0f - (lon / (2.0f * float(M_PI))), 1.0f - ((latNext + float(M_PI) / 2.0f) / float(M_PI)) };
-			b.normal = { b.position.x, b.position.y, b.position.z };
-
-			// c
-			VertexData c;
-			c.position = { cos(lat) * cos(lonNext), sin(lat), cos(lat) * sin(lonNext), 1.0f };
-			c.texcoord = { 1.0f - (lonNext / (2.0f * float(M_PI))), 1.0f - ((lat + float(M_PI) / 2.0f) / float(M_PI)) };
-			c.normal = { c.position.x, c.position.y, c.position.z };
-
-			// d
-			VertexData d;
-			d.position = { cos(latNext) * cos(lonNext), sin(latNext), cos(latNext) * sin(lonNext), 1.0f };
-			d.texcoord = { 1.0f - (lonNext / (2.0f * float(M_PI))), 1.0f - ((latNext + float(M_PI) / 2.0f) / float(M_PI)) };
-			d.normal = { d.position.x, d.position.y, d.position.z };
-
-			// 三角形1: a, b, c
-			vertexData[start + 0] = a;
-			vertexData[start + 1] = b;
-			vertexData[start + 2] = c;
-
-			// 三角形2: c, b, d
-			vertexData[start + 3] = d;
-
-		}
-	}
-}
-
-
-// mtlファイルを読む関数
-MaterialData LoadMaterialTemplateFile(const std::string& directoryPath, const std::string& filename)
-{
-	MaterialData materialData; // 構築するMaterialData
-	std::string line; // ファイルから読んだ１行を格納するもの
-	std::ifstream file(directoryPath + "/" + filename); // ファイルを開く
-	assert(file.is_open()); // とりあえず聞けなかったら止める
-
-	while (std::getline(file, line))
-	{
-		std::string identifier;
-		std::istringstream s(line);
-		s >> identifier;
-
-		// identifierに大路多処理
-		if (identifier == "map_Kd")
-		{
-			std::string textureFilename;
-			s >> textureFilename;
-			// 連結してファイルパスにする
-			materialData.textureFilePath = directoryPath + "/" + textureFilename;
-		}
-
-	}
-
-	return materialData;
-}
-
-// objファイルを読む関数
-
-ModelData LoadObjFile(const std::string& directoryPath, const std::string& filename)
-{
-	//1.中で必要となる変数の宣言
-	ModelData modelData;//構築するModelData
-	std::vector<Vector4>positions;//座標
-	std::vector<Vector3>normals;//法線
-	std::vector<Vector2>texcoords;//テクスチャー座標
-	std::string line;//ファイルから読んだ1行を格納するもの
-
-	//2.ファイルを開く
-	std::fstream file(directoryPath + "/" + filename);//ファイルを開く
-	assert(file.is_open());//とりあえず開けなかったら止める
-
-	//3.実際にファイルを読み込み、ModelDataを構築していく
-	while (std::getline(file, line))
-	{
-		std::string identifier;
-		std::istringstream s(line);
-		s >> identifier;//先頭の識別子を読む
-
-		//identifierに応じた処理
-		if (identifier == "v")
-		{
-			Vector4 position;
-			s >> position.x >> position.y >> position.z;
-			position.x *= -1.0f;
-			position.w = 1.0f;
-			positions.push_back(position);
-		} else if (identifier == "vt")
-		{
-			Vector2 texcoord;
-			s >> texcoord.x >> texcoord.y;
-			texcoord.y = 1.0f - texcoord.y;
-			texcoords.push_back(texcoord);
-		} else if (identifier == "vn")
-		{
-			Vector3 normal;
-			s >> normal.x >> normal.y >> normal.z;
-			normal.x *= -1.0f;
-			normals.push_back(normal);
-		} else if (identifier == "f")
-		{
-			VertexData triangle[3];
-			//面は三角形限定。その他は未対応
-			for (int32_t faceVertex = 0; faceVertex < 3; ++faceVertex)
-			{
-				std::string vertexDefinition;
-				s >> vertexDefinition;
-				//頂点の要素へのindexは「位置/UV/法線」で格納しているので、分解してIndexを取得する
-				std::istringstream v(vertexDefinition);
-				uint32_t elementIndices[3];
-				for (int32_t element = 0; element < 3; ++element)
-				{
-					std::string index;
-					std::getline(v, index, '/');//  /区切りでインデックスを読んでいく
-					elementIndices[element] = std::stoi(index);
-				}
-				//要素へのIndexから、実際の要素の値を取得して、頂点を構築する
-				Vector4 position = positions[elementIndices[0] - 1];
-				Vector2 texcoord = texcoords[elementIndices[1] - 1];
-				Vector3 normal = normals[elementIndices[2] - 1];
-				VertexData vertex = { position,texcoord,normal };
-				modelData.vertices.push_back(vertex);
-				triangle[faceVertex] = { position,texcoord,normal };
-			}
-			//頂点を逆順で登録することで、周り順を逆にする
-			modelData.vertices.push_back(triangle[2]);
-			modelData.vertices.push_back(triangle[1]);
-			modelData.vertices.push_back(triangle[0]);
-		} else if (identifier == "mtllib")
-		{
-			//materialTemplateLibraryファイルの名前を取得する
-			std::string materialFilename;
-			s >> materialFilename;
-			//基本的にobjファイルと同一階層にmtlは存在させるので、ディレクトリ名とファイル名を渡す
-			modelData.material = LoadMaterialTemplateFile(directoryPath, materialFilename);
-
-		}
-	}
-
-	//4.ModelDataを返す
-	return modelData;
-}
-
 /**/
 // 音声データの読み込み
 SoundData SoundLoadWave(const char* filename)
@@ -657,52 +466,92 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 	
 	// テクスチャの読み込み
 	std::string textureFilePath = "Resources/uvChecker.png";
-	uint32_t textureIndex = 0;
 	TextureManager::GetInstance()->LoadTexture(textureFilePath);
 
 	//* モデル *//
 
-	// インデックス
-	Microsoft::WRL::ComPtr<ID3D12Resource> indexVertexResource = dxCommon->CreateBufferResource(sizeof(uint32_t) * 2400);
+	// モデル読み込み（変換済みのキャッシュをマップして、そのままアップロード用のリソースにコピーする）
+	MeshCache modelMesh;
+	const bool isModelLoaded = ObjLoader::LoadCookedMesh("Resources", "plane.obj", modelMesh);
+	assert(isModelLoaded);
+	const uint32_t modelVertexCount = modelMesh.GetVertexCount();
+	const uint32_t modelIndexCount = modelMesh.GetIndexCount();
+	const uint32_t modelIndexSize = modelMesh.GetIndexSize();
+	// モデルのローカル空間のAABB（カリング用）
+	const AABB modelBounds = modelMesh.GetBounds();
+	// 頂点バッファの形式
+	const VertexFormat modelVertexFormat = kModelVertexFormat;
+	const uint32_t modelVertexStride = VertexCompression::GetVertexStride(modelVertexFormat);
+	// 量子化した位置を元に戻す行列（WVPの前に掛ける）
+	const Matrix4x4 modelDequantizeMatrix = VertexCompression::MakeDequantizeMatrix(modelBounds, modelVertexFormat);
+	// 頂点バッファ用リソースを作成
+	Microsoft::WRL::ComPtr<ID3D12Resource> vertexResource = dxCommon->CreateBufferResource(size_t(modelVertexStride) * modelVertexCount);
+
+	// 頂点バッファビューを作成する
+	D3D12_VERTEX_BUFFER_VIEW vertexBufferView = {};
+	vertexBufferView.BufferLocation = vertexResource->GetGPUVirtualAddress();
+	vertexBufferView.SizeInBytes = modelVertexStride * modelVertexCount;
+	vertexBufferView.StrideInBytes = modelVertexStride;
+	// 頂点リソースにデータを書き込む
+	void* vertexData = nullptr;
+	// 書き込むためのアドレスを取得
+	vertexResource->Map(0, nullptr, &vertexData);
+	if (modelVertexFormat == VertexFormat::Float)
+	{
+		std::memcpy(vertexData, modelMesh.GetVertices(), sizeof(VertexData) * modelVertexCount);
+	}
+	else
+	{
+		// キャッシュの頂点を圧縮しながら書き込む
+		PackedVertexData* packedVertexData = static_cast<PackedVertexData*>(vertexData);
+		VertexCompression::EncodeVertices(modelMesh.GetVertices(), modelVertexCount, modelBounds, modelVertexFormat, packedVertexData);
+		const VertexCompressionError compressionError = VertexCompression::MeasureError(modelMesh.GetVertices(), packedVertexData, modelVertexCount, modelBounds, modelVertexFormat);
+		Logger::Log(std::format("VertexCompression: {} bytes -> {} bytes, position error {:.6f}, texcoord error {:.6f}, normal error {:.4f} deg\n",
+			sizeof(VertexData) * modelVertexCount, size_t(modelVertexStride) * modelVertexCount,
+			compressionError.maxPositionError, compressionError.maxTexcoordError, compressionError.maxNormalErrorDegrees));
+	}
+
+	// インデックス（頂点が65536個未満なら16bit）
+	Microsoft::WRL::ComPtr<ID3D12Resource> indexVertexResource = dxCommon->CreateBufferResource(size_t(modelIndexSize) * modelIndexCount);
 
 	D3D12_INDEX_BUFFER_VIEW indexBufferViewVertex{};
 	// リソースの先頭のアドレスから使う
 	indexBufferViewVertex.BufferLocation = indexVertexResource->GetGPUVirtualAddress();
-	// 使用するリソースのサイズはインデックス６つ分のサイズ
-	indexBufferViewVertex.SizeInBytes = sizeof(uint32_t) * 2400;
-	// インデックスはuint32_tとする
-	indexBufferViewVertex.Format = DXGI_FORMAT_R32_UINT;
+	// 使用するリソースのサイズはモデルのインデックス分のサイズ
+	indexBufferViewVertex.SizeInBytes = modelIndexSize * modelIndexCount;
+	indexBufferViewVertex.Format = modelIndexSize == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
 
 	// インデックスリソースにデータを書き込む
-	uint32_t* indexDataVertex = nullptr;
-	indexVertexResource->Map(0, nullptr, reinterpret_cast<void**>(&indexDataVertex));
-
-	// 球のインデックスデータを設定する
-	for (uint32_t i = 0; i < 2400; i += 6)
+	void* indexDataVertex = nullptr;
+	indexVertexResource->Map(0, nullptr, &indexDataVertex);
+	std::memcpy(indexDataVertex, modelMesh.GetIndices(), size_t(modelIndexSize) * modelIndexCount);
+
+	// サブメッシュ（マテリアルごとの描画範囲）と、マテリアルのテクスチャ
+	const std::vector<MeshCacheSubmesh> modelSubmeshes(modelMesh.GetSubmeshes(), modelMesh.GetSubmeshes() + modelMesh.GetSubmeshCount());
+	// LOD（詳細度ごとのサブメッシュの範囲。頂点バッファとインデックスバッファは全LODで共有する）
+	std::vector<MeshLod> modelLods;
+	for (uint32_t i = 0; i < modelMesh.GetLodCount(); ++i)
 	{
-		indexDataVertex[i + 0] = i + 0;
-		indexDataVertex[i + 1] = i + 1;
-		indexDataVertex[i + 2] = i + 2;
-		indexDataVertex[i + 3] = i + 2;
-		indexDataVertex[i + 4] = i + 1;
-		indexDataVertex[i + 5] = i + 3;
+		modelLods.push_back({ modelMesh.GetLods()[i].submeshOffset, modelMesh.GetLods()[i].submeshCount, modelMesh.GetLods()[i].error });
 	}
-
-	// モデル読み込み
-	ModelData modelData = LoadObjFile("Resources", "plane.obj");
-	// 頂点バッファ用リソースを作成
-	Microsoft::WRL::ComPtr<ID3D12Resource> vertexResource = dxCommon->CreateBufferResource(sizeof(VertexData) * modelData.vertices.size());
-
-	// 頂点バッファビューを作成する
-	D3D12_VERTEX_BUFFER_VIEW vertexBufferView = {};
-	vertexBufferView.BufferLocation = vertexResource->GetGPUVirtualAddress();
-	vertexBufferView.SizeInBytes = UINT(sizeof(VertexData) * modelData.vertices.size());
-	vertexBufferView.StrideInBytes = sizeof(VertexData);
-	// 頂点リソースにデータを書き込む
-	VertexData* vertexData = nullptr;
-	// 書き込むためのアドレスを取得
-	vertexResource->Map(0, nullptr, reinterpret_cast<void**>(&vertexData));
-	std::memcpy(vertexData, modelData.vertices.data(), sizeof(VertexData) * modelData.vertices.size());
+	// 画面上で許すLODの誤差（ピクセル）
+	const float kModelLodPixelError = 1.0f;
+	// メッシュレット（描画ごとにCPUでカリングし、残った範囲だけを描画する）
+	const std::vector<Meshlet> modelMeshlets(modelMesh.GetMeshlets(), modelMesh.GetMeshlets() + modelMesh.GetMeshletCount());
+	const std::vector<MeshletBounds> modelMeshletBounds(modelMesh.GetMeshletBounds(), modelMesh.GetMeshletBounds() + modelMesh.GetMeshletCount());
+	std::vector<IndexRange> modelDrawRanges(modelMeshlets.size());
+	// マテリアル（共有のMaterialLibraryのハンドル）と、そのテクスチャ
+	const std::vector<MaterialHandle> modelMaterials = modelMesh.LoadMaterialHandles("Resources");
+	std::vector<TextureHandle> modelTextures;
+	std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> modelTextureHandles;
+	for (MaterialHandle material : modelMaterials)
+	{
+		// テクスチャのないマテリアルはuvCheckerを使う
+		modelTextures.push_back(MaterialLibrary::GetInstance()->GetTexture(material, textureFilePath));
+		modelTextureHandles.push_back(TextureManager::GetInstance()->GetSrvHandleGPU(modelTextures.back()));
+	}
+	// アップロード用のリソースにコピーしたら、キャッシュのマップは要らない
+	modelMesh.Close();
 
 
 	// マテリアル用のリソースを作る。今回はcolor１つ分のサイズを用意する
@@ -880,6 +729,11 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 	//SoundPlayWave(xAudio2, soundData1);
 
 
+	// 親子関係を持つTransform。変更があったノードだけ毎フレーム更新する
+	TransformHierarchy transformHierarchy;
+	const uint32_t cameraNode = transformHierarchy.AddNode(cameraTransform);
+	const uint32_t modelNode = transformHierarchy.AddNode(transform);
+
 	MSG msg{};
 	// ウィンドウのｘボタンが押されるまでループ
 	while (msg.message != WM_QUIT)
@@ -899,6 +753,9 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 		// 入力の更新
 		input->Update();
 
+		// デコードが済んだテクスチャの転送（1フレームに転送する量には上限がある）
+		TextureManager::GetInstance()->Update();
+
 		// デバックカメラ
 		//debugCamera->Update(windowAPI->GetHwnd());
 
@@ -910,19 +767,38 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 			//sprite->ChangeTexture("Resources/uvChecker.png");
 		}
 
-		// y軸回転処理
-		transform.rotate.y = 3.00f;
+		// 変更されたTransformのワールド行列だけ作り直す
+		transformHierarchy.Update();
 
-		Matrix4x4 worldMatrix = MakeAffine(transform.scale, transform.rotate, transform.translate);
-		Matrix4x4 cameraMatrix = MakeAffine(cameraTransform.scale, cameraTransform.rotate, cameraTransform.translate);
-		Matrix4x4 viewMatrix = Inverse(cameraMatrix);
+		const Matrix4x4& worldMatrix = transformHierarchy.GetWorldMatrix(modelNode);
+		const Matrix4x4& cameraMatrix = transformHierarchy.GetWorldMatrix(cameraNode);
+		// カメラは拡大縮小しないので回転の転置と平行移動の反転だけで逆行列が求まる
+		Matrix4x4 viewMatrix = InverseRigid(cameraMatrix);
 		//viewMatrix = debugCamera->GetViewMatrix(); // デバッグカメラのビュー行列を取得
 		Matrix4x4 projectionMatrix = PerspectiveFov(0.45f, float(winApp->kClientWidth) / float(winApp->kClientHeight), 0.1f, 100.0f);
 		// WVPmatrixを作る
-		Matrix4x4 worldViewProjectionMatrix = Multipty(worldMatrix, Multipty(viewMatrix, projectionMatrix));
+		Matrix4x4 viewProjectionMatrix = Multipty(viewMatrix, projectionMatrix);
+		Matrix4x4 worldViewProjectionMatrix = Multipty(worldMatrix, viewProjectionMatrix);
 		*wvpData = worldViewProjectionMatrix;
-		transData->WVP = worldViewProjectionMatrix;   // WVP行列を設定
+		transData->WVP = Multipty(modelDequantizeMatrix, worldViewProjectionMatrix);   // WVP行列を設定（圧縮した位置の復元も含める）
 		transData->World = worldMatrix; // World行列を設定
+		// 視錐台の外にあるモデルは描画しない
+		const Frustum frustum = Culling::ExtractFrustum(viewProjectionMatrix);
+		const AABB modelWorldBounds = Culling::TransformAABB(modelBounds, worldMatrix);
+		const bool isModelVisible = Culling::IsVisible(frustum, modelWorldBounds);
+		// 画面上の誤差からLODを選ぶ（距離は境界ボックスを囲む球の表面まで）
+		const Vector3 modelCenter = (modelWorldBounds.min + modelWorldBounds.max) * 0.5f;
+		const float modelRadius = VectorMath::Length(modelWorldBounds.max - modelWorldBounds.min) * 0.5f;
+		const Vector3 cameraPosition = { cameraMatrix.m[3][0], cameraMatrix.m[3][1], cameraMatrix.m[3][2] };
+		const float modelDistance = VectorMath::Length(modelCenter - cameraPosition) - modelRadius;
+		const float modelScale = (std::max)({
+			VectorMath::Length(Vector3{ worldMatrix.m[0][0], worldMatrix.m[0][1], worldMatrix.m[0][2] }),
+			VectorMath::Length(Vector3{ worldMatrix.m[1][0], worldMatrix.m[1][1], worldMatrix.m[1][2] }),
+			VectorMath::Length(Vector3{ worldMatrix.m[2][0], worldMatrix.m[2][1], worldMatrix.m[2][2] }) });
+		const float projectionScale = float(winApp->kClientHeight) * 0.5f * projectionMatrix.m[1][1];
+		// モデルの画面上の大きさ（画素数。近づきすぎたときやカメラが中に入ったときは画面の高さの4倍で打ち切る）
+		const float modelScreenSize = modelDistance > 0.0f ? (std::min)(modelRadius * 2.0f * projectionScale / modelDistance, float(winApp->kClientHeight) * 4.0f) : float(winApp->kClientHeight) * 4.0f;
+		const MeshLod& modelLod = modelLods[MeshSimplifier::SelectLod(modelLods, modelDistance, modelScale, projectionScale, kModelLodPixelError)];
 
 
 		// *スプライト* //
@@ -954,9 +830,15 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 		ImGui::SliderAngle("UVRotate", &uvTransformSprite.rotate.z);
 
 		// モデル
-		ImGui::DragFloat3("scale", &transform.scale.x, 0.01f, -10.0f, 10.0f);
-		ImGui::DragFloat3("translate", &transform.translate.x, 0.01f, -10.0f, 10.0f);
-		ImGui::DragFloat3("rotate", &transform.rotate.x, 0.01f, -10.0f, 10.0f);
+		// 値が変わったときだけ次のフレームで行列を作り直す（全部表示するため||ではなく|でつなぐ）
+		if (ImGui::DragFloat3("scale", &transform.scale.x, 0.01f, -10.0f, 10.0f) |
+			ImGui::DragFloat3("translate", &transform.translate.x, 0.01f, -10.0f, 10.0f) |
+			ImGui::DragFloat3("rotate", &transform.rotate.x, 0.01f, -10.0f, 10.0f))
+		{
+			// y軸回転は固定
+			transform.rotate.y = 3.00f;
+			transformHierarchy.SetLocal(modelNode, transform);
+		}
 
 
 
@@ -971,8 +853,8 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 
 
 
-		// Spriteの描画準備。Spriteの描画に共通のグラフィックスコマンドを積む
-		spriteCommon->SetCommonPipelineState();
+		// モデルの描画準備。モデルの頂点の形式に合ったPSOを使う
+		spriteCommon->SetCommonPipelineState(modelVertexFormat);
 
 		// モデル
 		// RootSignatureを設定。PSOに設定しているけど別途設定が必要
@@ -987,13 +869,39 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 		// 平行光源
 		dxCommon->GetCommandList()->SetGraphicsRootConstantBufferView(3, directionalLightResource->GetGPUVirtualAddress());
 
-		D3D12_GPU_DESCRIPTOR_HANDLE textureHandle = dxCommon->GetSRVGPUDescriptorHandle(1);
-		dxCommon->GetCommandList()->SetGraphicsRootDescriptorTable(2, textureHandle);
-
 		// インデックスバッファビューを設定
 		dxCommon->GetCommandList()->IASetIndexBuffer(&indexBufferViewVertex);
-		// インデックスを使って描画（球）
-		dxCommon->GetCommandList()->DrawIndexedInstanced(UINT(modelData.vertices.size()), 1, 0, 0,0);
+		// インデックスを使って描画（モデル）。バッファはそのままで、選んだLODのマテリアルごとに1回ずつ描画する
+		if (isModelVisible)
+		{
+			// 同じマテリアルが続くときはテクスチャを設定し直さない
+			MaterialHandle boundMaterial = MaterialLibrary::kInvalidHandle;
+			for (uint32_t i = modelLod.submeshOffset; i < modelLod.submeshOffset + modelLod.submeshCount; ++i)
+			{
+				const MeshCacheSubmesh& submesh = modelSubmeshes[i];
+				// 視錐台の外のメッシュレットを除く（パイプラインは裏面カリングなしで描いているので、法線の円錐での判定はしない）
+				const size_t rangeCount = MeshletUtility::CullMeshlets(modelMeshlets.data() + submesh.meshletOffset, modelMeshletBounds.data() + submesh.meshletOffset,
+					submesh.meshletCount, worldMatrix, frustum, cameraPosition, false, modelDrawRanges.data());
+				if (rangeCount == 0)
+				{
+					continue;
+				}
+				if (modelMaterials[submesh.materialIndex] != boundMaterial)
+				{
+					dxCommon->GetCommandList()->SetGraphicsRootDescriptorTable(2, modelTextureHandles[submesh.materialIndex]);
+					boundMaterial = modelMaterials[submesh.materialIndex];
+					// テクスチャがモデル全体に1回貼られているとみなして、画面上の大きさを報告する（ミップのストリーミング用）
+					TextureManager::GetInstance()->ReportTextureUsage(modelTextures[submesh.materialIndex], modelScreenSize);
+				}
+				for (size_t range = 0; range < rangeCount; ++range)
+				{
+					dxCommon->GetCommandList()->DrawIndexedInstanced(modelDrawRanges[range].indexCount, 1, modelDrawRanges[range].indexOffset, 0, 0);
+				}
+			}
+		}
+
+		// Spriteの描画準備。Spriteの描画に共通のグラフィックスコマンドを積む
+		spriteCommon->SetCommonPipelineState();
 
 		// スプライト描画
 		for (int i = 0; i < 3; i++)
@@ -1022,6 +930,8 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 
 	// 音声データ解放
 	//xAudio2.Reset();
+	// マテリアルライブラリの終了
+	MaterialLibrary::GetInstance()->Finalize();
 	// テクスチャマネージャの終了
 	TextureManager::GetInstance()->Finalize();
 	// 入力の初期化
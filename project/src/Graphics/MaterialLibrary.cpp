@@ -0,0 +1,186 @@
+#include "MaterialLibrary.h"
+#include <cassert>
+#include <tuple>
+
+#include "HashUtility.h"
+#include "TextureManager.h"
+
+MaterialLibrary* MaterialLibrary::instance_ = nullptr;
+
+// シングルトンインスタンスの取得
+MaterialLibrary* MaterialLibrary::GetInstance()
+{
+	if (instance_ == nullptr)
+	{
+		instance_ = new MaterialLibrary;
+	}
+	return instance_;
+}
+
+// 終了
+void MaterialLibrary::Finalize()
+{
+	delete instance_;
+	instance_ = nullptr;
+}
+
+// mtlファイルを読み、ハンドルと名前を返す
+const MaterialLibrary::MaterialFile& MaterialLibrary::Load(const std::string& directoryPath, const std::string& filename)
+{
+	const std::string path = directoryPath + "/" + filename;
+	auto it = libraries_.find(path);
+	if (it != libraries_.end())
+	{
+		return it->second;
+	}
+
+	MaterialFile file;
+	for (const MaterialData& material : ObjLoader::LoadMaterialTemplateFile(directoryPath, filename))
+	{
+		file.handles.push_back(Register(material));
+		file.names.push_back(material.name);
+	}
+	return libraries_.emplace(path, std::move(file)).first->second;
+}
+
+// マテリアルを登録する
+MaterialHandle MaterialLibrary::Register(const MaterialData& material)
+{
+	const uint64_t hash = ComputeHash(material);
+	const auto range = handles_.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (HasSameContent(materials_[it->second].material, material))
+		{
+			return it->second;
+		}
+	}
+
+	assert(materials_.size() < kInvalidHandle);
+	const MaterialHandle handle = static_cast<MaterialHandle>(materials_.size());
+	materials_.push_back({ material, TextureHandle{} });
+	handles_.emplace(hash, handle);
+	return handle;
+}
+
+// 名前で探す
+MaterialHandle MaterialLibrary::FindMaterial(const MaterialFile& file, std::string_view name)
+{
+	if (name.empty())
+	{
+		return file.handles.empty() ? Register(MaterialData{}) : file.handles.front();
+	}
+	for (size_t i = 0; i < file.names.size(); ++i)
+	{
+		if (file.names[i] == name)
+		{
+			return file.handles[i];
+		}
+	}
+	MaterialData material;
+	material.name = std::string(name);
+	return Register(material);
+}
+
+// ハンドルのマテリアル
+const MaterialData& MaterialLibrary::GetMaterial(MaterialHandle handle) const
+{
+	// 範囲外指定違反チェック
+	assert(handle < materials_.size());
+	return materials_[handle].material;
+}
+
+// ハンドルの一覧をマテリアルの一覧にする
+std::vector<MaterialData> MaterialLibrary::GetMaterials(const std::vector<MaterialHandle>& handles) const
+{
+	std::vector<MaterialData> materials;
+	materials.reserve(handles.size());
+	for (MaterialHandle handle : handles)
+	{
+		materials.push_back(GetMaterial(handle));
+	}
+	return materials;
+}
+
+// mtlファイルのマテリアルの一覧
+std::vector<MaterialData> MaterialLibrary::GetMaterials(const MaterialFile& file) const
+{
+	std::vector<MaterialData> materials = GetMaterials(file.handles);
+	for (size_t i = 0; i < materials.size(); ++i)
+	{
+		materials[i].name = file.names[i];
+	}
+	return materials;
+}
+
+// map_Kdのテクスチャ
+TextureHandle MaterialLibrary::GetTexture(MaterialHandle handle, const std::string& defaultTextureFilePath)
+{
+	// 範囲外指定違反チェック
+	assert(handle < materials_.size());
+	Entry& entry = materials_[handle];
+	TextureManager* textureManager = TextureManager::GetInstance();
+	if (entry.material.textureFilePath.empty())
+	{
+		return textureManager->LoadTexture(defaultTextureFilePath);
+	}
+	// 覚えておいたハンドルが解放されていたら読み直す
+	if (!textureManager->IsValid(entry.texture))
+	{
+		entry.texture = textureManager->LoadTexture(entry.material.textureFilePath);
+	}
+	return entry.texture;
+}
+
+// 名前を除いた内容のハッシュ（HasSameContentと同じ項目を使う）
+uint64_t MaterialLibrary::ComputeHash(const MaterialData& material)
+{
+	uint64_t hash = 0;
+	const auto mix = [&hash](const void* data, size_t size)
+		{
+			hash = HashUtility::ComputeHash64(data, size, hash);
+		};
+	// -0.0と0.0は比べると同じなので、ハッシュも同じになるようにそろえる
+	const auto mixFloat = [&mix](float value)
+		{
+			const float normalized = value == 0.0f ? 0.0f : value;
+			mix(&normalized, sizeof(normalized));
+		};
+	const auto mixVector = [&mixFloat](const Vector3& value)
+		{
+			mixFloat(value.x);
+			mixFloat(value.y);
+			mixFloat(value.z);
+		};
+	const auto mixString = [&mix](const std::string& value)
+		{
+			const uint64_t size = value.size();
+			mix(&size, sizeof(size));
+			mix(value.data(), value.size());
+		};
+	mixVector(material.ambient);
+	mixVector(material.diffuse);
+	mixVector(material.specular);
+	mixFloat(material.shininess);
+	mixFloat(material.alpha);
+	mix(&material.illumination, sizeof(material.illumination));
+	mixString(material.textureFilePath);
+	mixString(material.ambientTextureFilePath);
+	mixString(material.specularTextureFilePath);
+	mixString(material.shininessTextureFilePath);
+	mixString(material.alphaTextureFilePath);
+	mixString(material.bumpTextureFilePath);
+	return hash;
+}
+
+// 名前を除いた内容が同じか
+bool MaterialLibrary::HasSameContent(const MaterialData& a, const MaterialData& b)
+{
+	const auto content = [](const MaterialData& material)
+		{
+			return std::tie(material.ambient, material.diffuse, material.specular, material.shininess, material.alpha, material.illumination,
+				material.textureFilePath, material.ambientTextureFilePath, material.specularTextureFilePath,
+				material.shininessTextureFilePath, material.alphaTextureFilePath, material.bumpTextureFilePath);
+		};
+	return content(a) == content(b);
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ObjLoader.h"
+#include "TextureHandle.h"
+
+// マテリアルのハンドル（MaterialLibraryの中の番号。登録したものは消さないので、ずっと同じマテリアルを指す）
+using MaterialHandle = uint32_t;
+
+// すべてのモデルで共有するマテリアルの表
+// 同じ内容のマテリアルは名前が違っても1つにまとめ、同じmtlファイルは1回しか読まない
+// 名前はmtlファイルごとの表（MaterialFile）が持つので、ファイルをまたいで同じ名前でもぶつからない
+// テクスチャもマテリアルごとに1回だけTextureManagerで読み込むので、描画はハンドルごとにまとめられる
+class MaterialLibrary
+{
+public:
+	// 無効なハンドル
+	static constexpr MaterialHandle kInvalidHandle = UINT32_MAX;
+
+	// mtlファイル1つ分（書かれている順のハンドルと、ファイルの中での名前）
+	struct MaterialFile
+	{
+		std::vector<MaterialHandle> handles;
+		std::vector<std::string> names;
+	};
+
+	// シングルトンインスタンスの取得
+	static MaterialLibrary* GetInstance();
+	// 終了
+	void Finalize();
+
+	// mtlファイル（directoryPath/filename）を読み、書かれている順にハンドルと名前を返す
+	// 2回目からはファイルを読まずに前の結果を返す
+	const MaterialFile& Load(const std::string& directoryPath, const std::string& filename);
+	// マテリアルを登録する（名前を除いた内容が同じものがあればそのハンドルを返す）
+	MaterialHandle Register(const MaterialData& material);
+	// file（Loadの戻り値）から名前で探す
+	// ObjLoader::FindMaterialと同じく、名前が空なら最初のもの、見つからなければ名前だけのマテリアルを登録して返す
+	MaterialHandle FindMaterial(const MaterialFile& file, std::string_view name);
+
+	// ハンドルのマテリアル（名前は最初に登録したときのもの）
+	const MaterialData& GetMaterial(MaterialHandle handle) const;
+	// ハンドルの一覧をマテリアルの一覧にする（名前は最初に登録したときのもの）
+	std::vector<MaterialData> GetMaterials(const std::vector<MaterialHandle>& handles) const;
+	// mtlファイルのマテリアルの一覧（名前はファイルの中のもの）
+	std::vector<MaterialData> GetMaterials(const MaterialFile& file) const;
+	// 登録されているマテリアルの数
+	size_t GetMaterialCount() const { return materials_.size(); }
+	// map_Kdのテクスチャ（TextureManagerのハンドル）。初回だけ読み込み、あとは覚えておいたハンドルを返す
+	// テクスチャのないマテリアルはdefaultTextureFilePathのテクスチャを使う
+	TextureHandle GetTexture(MaterialHandle handle, const std::string& defaultTextureFilePath);
+
+private:
+	// 登録したマテリアル
+	struct Entry
+	{
+		MaterialData material;
+		TextureHandle texture; // map_Kdのテクスチャ（無効ならまだ読んでいないか、解放された）
+	};
+
+	// 名前を除いた内容のハッシュ
+	static uint64_t ComputeHash(const MaterialData& material);
+	// 名前を除いた内容が同じか
+	static bool HasSameContent(const MaterialData& a, const MaterialData& b);
+
+	// ハンドルの番号の順に並べたマテリアル
+	std::vector<Entry> materials_;
+	// 内容のハッシュからハンドル（ハッシュが同じでも内容を比べて確かめる）
+	std::unordered_multimap<uint64_t, MaterialHandle> handles_;
+	// 読んだmtlファイルのパスから、書かれている順のハンドルと名前
+	std::unordered_map<std::string, MaterialFile> libraries_;
+
+	static MaterialLibrary* instance_;
+
+	MaterialLibrary() = default;
+	~MaterialLibrary() = default;
+	MaterialLibrary(MaterialLibrary&) = delete;
+	MaterialLibrary& operator=(MaterialLibrary&) = delete;
+};
@@ -0,0 +1,433 @@
+#include "MeshCache.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include "StringUtility.h"
+#endif
+
+namespace
+{
+	// 各領域の先頭を揃える境界
+	constexpr uint64_t kSectionAlignment = 16;
+
+	inline uint64_t AlignUp(uint64_t value)
+	{
+		return (value + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+	}
+
+	// パスはUTF-8として扱う（MappedFileと同じ）
+	std::filesystem::path ToPath(const std::string& path)
+	{
+#ifdef _WIN32
+		return std::filesystem::path(StringUtility::ConvertString(path));
+#else
+		return std::filesystem::path(path);
+#endif
+	}
+
+	// 領域がファイルの中に収まっているか
+	inline bool IsInside(uint64_t offset, uint64_t size, uint64_t fileSize)
+	{
+		return offset <= fileSize && size <= fileSize - offset;
+	}
+
+	// offsetの位置に書き込む
+	void WriteSection(std::vector<char>& destination, uint64_t offset, const void* data, uint64_t size)
+	{
+		if (size > 0)
+		{
+			std::memcpy(destination.data() + offset, data, size);
+		}
+	}
+}
+
+// キャッシュファイルを開く
+bool MeshCache::Open(const std::string& cachePath, const std::string& sourcePath)
+{
+	Close();
+	if (!file_.Open(cachePath))
+	{
+		return false;
+	}
+	data_ = file_.GetData();
+	size_ = file_.GetSize();
+	if (!Validate(sourcePath))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+// メモリに持って開く
+bool MeshCache::OpenMemory(std::vector<char> data, const std::string& sourcePath)
+{
+	Close();
+	memory_ = std::move(data);
+	data_ = memory_.data();
+	size_ = memory_.size();
+	if (!Validate(sourcePath))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+// 中身が正しいか確かめる
+bool MeshCache::Validate(const std::string& sourcePath)
+{
+	if (size_ < sizeof(MeshCacheHeader))
+	{
+		return false;
+	}
+
+	// 形式が正しいか確かめる
+	const MeshCacheHeader* header = reinterpret_cast<const MeshCacheHeader*>(data_);
+	const uint64_t fileSize = size_;
+	const bool isValid =
+		header->magic == kMagic && header->version == kVersion &&
+		header->vertexStride == sizeof(VertexData) &&
+		(header->indexSize == sizeof(uint16_t) || header->indexSize == sizeof(uint32_t)) &&
+		IsInside(header->sourcePathOffset, header->sourcePathSize, fileSize) &&
+		IsInside(header->vertexOffset, uint64_t(header->vertexCount) * sizeof(VertexData), fileSize) &&
+		IsInside(header->indexOffset, uint64_t(header->indexCount) * header->indexSize, fileSize) &&
+		IsInside(header->submeshOffset, uint64_t(header->submeshCount) * sizeof(MeshCacheSubmesh), fileSize) &&
+		header->lodCount > 0 && IsInside(header->lodOffset, uint64_t(header->lodCount) * sizeof(MeshCacheLod), fileSize) &&
+		IsInside(header->meshletOffset, uint64_t(header->meshletCount) * sizeof(Meshlet), fileSize) &&
+		IsInside(header->meshletBoundsOffset, uint64_t(header->meshletCount) * sizeof(MeshletBounds), fileSize) &&
+		IsInside(header->meshletVertexOffset, uint64_t(header->meshletVertexCount) * sizeof(uint32_t), fileSize) &&
+		IsInside(header->meshletTriangleOffset, uint64_t(header->meshletTriangleCount) * 3, fileSize) &&
+		IsInside(header->materialOffset, uint64_t(header->materialCount) * sizeof(MeshCacheMaterial), fileSize) &&
+		IsInside(header->stringOffset, header->stringSize, fileSize);
+	// 同じ名前の別のファイルから作ったものでないか
+	if (!isValid || std::string_view(data_ + header->sourcePathOffset, header->sourcePathSize) != sourcePath)
+	{
+		return false;
+	}
+
+	// サブメッシュが範囲内を指しているか
+	const MeshCacheSubmesh* submeshes = reinterpret_cast<const MeshCacheSubmesh*>(data_ + header->submeshOffset);
+	for (uint32_t i = 0; i < header->submeshCount; ++i)
+	{
+		if (uint64_t(submeshes[i].indexOffset) + submeshes[i].indexCount > header->indexCount || submeshes[i].materialIndex >= header->materialCount ||
+			uint64_t(submeshes[i].meshletOffset) + submeshes[i].meshletCount > header->meshletCount)
+		{
+			return false;
+		}
+	}
+	// LODがサブメッシュの範囲内を指しているか
+	const MeshCacheLod* lods = reinterpret_cast<const MeshCacheLod*>(data_ + header->lodOffset);
+	for (uint32_t i = 0; i < header->lodCount; ++i)
+	{
+		if (uint64_t(lods[i].submeshOffset) + lods[i].submeshCount > header->submeshCount)
+		{
+			return false;
+		}
+	}
+
+	// メッシュレットが範囲内を指しているか
+	const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(data_ + header->meshletOffset);
+	const uint8_t* meshletTriangles = reinterpret_cast<const uint8_t*>(data_ + header->meshletTriangleOffset);
+	for (uint32_t i = 0; i < header->meshletCount; ++i)
+	{
+		const Meshlet& meshlet = meshlets[i];
+		if (uint64_t(meshlet.indexOffset) + uint64_t(meshlet.triangleCount) * 3 > header->indexCount ||
+			uint64_t(meshlet.vertexOffset) + meshlet.vertexCount > header->meshletVertexCount ||
+			uint64_t(meshlet.triangleOffset) + uint64_t(meshlet.triangleCount) * 3 > uint64_t(header->meshletTriangleCount) * 3)
+		{
+			return false;
+		}
+		// 三角形はメッシュレットの頂点を指している
+		const uint8_t* triangles = meshletTriangles + meshlet.triangleOffset;
+		if (std::any_of(triangles, triangles + size_t(meshlet.triangleCount) * 3, [&](uint8_t local) { return local >= meshlet.vertexCount; }))
+		{
+			return false;
+		}
+	}
+
+	// インデックスとメッシュレットの頂点は頂点バッファの中を指している（古い・壊れたキャッシュでGPUが範囲外を読まないように）
+	const auto isOutOfRange = [&](uint32_t index) { return index >= header->vertexCount; };
+	const uint32_t* meshletVertices = reinterpret_cast<const uint32_t*>(data_ + header->meshletVertexOffset);
+	if (std::any_of(meshletVertices, meshletVertices + header->meshletVertexCount, isOutOfRange))
+	{
+		return false;
+	}
+	if (header->indexSize == sizeof(uint16_t))
+	{
+		const uint16_t* indices = reinterpret_cast<const uint16_t*>(data_ + header->indexOffset);
+		if (std::any_of(indices, indices + header->indexCount, isOutOfRange))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		const uint32_t* indices = reinterpret_cast<const uint32_t*>(data_ + header->indexOffset);
+		if (std::any_of(indices, indices + header->indexCount, isOutOfRange))
+		{
+			return false;
+		}
+	}
+
+	header_ = header;
+	return true;
+}
+
+// 閉じる
+void MeshCache::Close()
+{
+	header_ = nullptr;
+	data_ = nullptr;
+	size_ = 0;
+	file_.Close();
+	memory_.clear();
+	memory_.shrink_to_fit();
+}
+
+// マテリアル参照のmtlファイル名
+std::string_view MeshCache::GetMaterialLibrary(uint32_t materialIndex) const
+{
+	const MeshCacheMaterial& material = reinterpret_cast<const MeshCacheMaterial*>(data_ + header_->materialOffset)[materialIndex];
+	if (uint64_t(material.libraryOffset) + material.librarySize > header_->stringSize)
+	{
+		return {};
+	}
+	return std::string_view(data_ + header_->stringOffset + material.libraryOffset, material.librarySize);
+}
+
+// マテリアル参照のマテリアル名
+std::string_view MeshCache::GetMaterialName(uint32_t materialIndex) const
+{
+	const MeshCacheMaterial& material = reinterpret_cast<const MeshCacheMaterial*>(data_ + header_->materialOffset)[materialIndex];
+	if (uint64_t(material.nameOffset) + material.nameSize > header_->stringSize)
+	{
+		return {};
+	}
+	return std::string_view(data_ + header_->stringOffset + material.nameOffset, material.nameSize);
+}
+
+// 中身をModelDataとして取り出す
+ModelData MeshCache::ToModelData(const std::string& directoryPath) const
+{
+	ModelData modelData;
+	if (!IsOpen())
+	{
+		return modelData;
+	}
+
+	modelData.vertices.assign(GetVertices(), GetVertices() + GetVertexCount());
+	modelData.indices.resize(GetIndexCount());
+	if (GetIndexSize() == sizeof(uint16_t))
+	{
+		const uint16_t* indices = static_cast<const uint16_t*>(GetIndices());
+		std::copy(indices, indices + GetIndexCount(), modelData.indices.begin());
+	}
+	else
+	{
+		std::memcpy(modelData.indices.data(), GetIndices(), sizeof(uint32_t) * GetIndexCount());
+	}
+	for (uint32_t i = 0; i < GetSubmeshCount(); ++i)
+	{
+		const MeshCacheSubmesh& submesh = GetSubmeshes()[i];
+		modelData.submeshes.push_back({ submesh.indexOffset, submesh.indexCount, submesh.materialIndex, submesh.meshletOffset, submesh.meshletCount });
+	}
+	for (uint32_t i = 0; i < GetLodCount(); ++i)
+	{
+		const MeshCacheLod& lod = GetLods()[i];
+		modelData.lods.push_back({ lod.submeshOffset, lod.submeshCount, lod.error });
+	}
+	modelData.meshletData.meshlets.assign(GetMeshlets(), GetMeshlets() + GetMeshletCount());
+	modelData.meshletData.bounds.assign(GetMeshletBounds(), GetMeshletBounds() + GetMeshletCount());
+	modelData.meshletData.vertices.assign(GetMeshletVertices(), GetMeshletVertices() + GetMeshletVertexCount());
+	modelData.meshletData.triangles.assign(GetMeshletTriangles(), GetMeshletTriangles() + size_t(GetMeshletTriangleCount()) * 3);
+	modelData.materials = LoadMaterials(directoryPath);
+	modelData.bounds = GetBounds();
+	return modelData;
+}
+
+// マテリアル参照をmtlから読む（mtlだけ書き換えた場合も反映される）
+std::vector<MaterialData> MeshCache::LoadMaterials(const std::string& directoryPath) const
+{
+	// 同じ内容のマテリアルは名前が違っても共有しているので、名前はキャッシュに書いたものにする
+	std::vector<MaterialData> materials = MaterialLibrary::GetInstance()->GetMaterials(LoadMaterialHandles(directoryPath));
+	for (uint32_t i = 0; i < materials.size(); ++i)
+	{
+		materials[i].name = std::string(GetMaterialName(i));
+	}
+	return materials;
+}
+
+// マテリアル参照をMaterialLibraryのハンドルにする
+std::vector<MaterialHandle> MeshCache::LoadMaterialHandles(const std::string& directoryPath) const
+{
+	std::vector<MaterialHandle> handles;
+	if (!IsOpen())
+	{
+		return handles;
+	}
+
+	// mtlはMaterialLibraryが1回だけ読む
+	MaterialLibrary* materialLibrary = MaterialLibrary::GetInstance();
+	const MaterialLibrary::MaterialFile noLibrary;
+	for (uint32_t i = 0; i < GetMaterialCount(); ++i)
+	{
+		const std::string_view libraryName = GetMaterialLibrary(i);
+		const MaterialLibrary::MaterialFile& library = libraryName.empty() ? noLibrary : materialLibrary->Load(directoryPath, std::string(libraryName));
+		handles.push_back(materialLibrary->FindMaterial(library, GetMaterialName(i)));
+	}
+	return handles;
+}
+
+// ModelDataをキャッシュファイルの形式にする
+std::vector<char> MeshCache::Serialize(const std::string& sourcePath, const MeshCacheKey& key, const ModelData& modelData, const std::string& materialLibrary)
+{
+	const uint32_t indexSize = ObjLoader::GetIndexSize(modelData);
+	std::vector<char> indices(size_t(indexSize) * modelData.indices.size());
+	ObjLoader::WriteIndices(modelData, indices.data());
+
+	std::vector<MeshCacheSubmesh> submeshes;
+	for (const Submesh& submesh : modelData.submeshes)
+	{
+		submeshes.push_back({ submesh.indexOffset, submesh.indexCount, submesh.materialIndex, submesh.meshletOffset, submesh.meshletCount, {} });
+	}
+	// LODを作っていなければ、全部のサブメッシュをLOD0とする
+	std::vector<MeshCacheLod> lods;
+	for (const MeshLod& lod : modelData.lods)
+	{
+		lods.push_back({ lod.submeshOffset, lod.submeshCount, lod.error, 0 });
+	}
+	if (lods.empty())
+	{
+		lods.push_back({ 0, static_cast<uint32_t>(submeshes.size()), 0.0f, 0 });
+	}
+
+	// マテリアル参照（mtlファイル名は全マテリアルで共有する）
+	std::string strings = materialLibrary;
+	std::vector<MeshCacheMaterial> materials;
+	for (const MaterialData& materialData : modelData.materials)
+	{
+		MeshCacheMaterial material = {};
+		material.libraryOffset = 0;
+		material.librarySize = static_cast<uint32_t>(materialLibrary.size());
+		material.nameOffset = static_cast<uint32_t>(strings.size());
+		material.nameSize = static_cast<uint32_t>(materialData.name.size());
+		strings += materialData.name;
+		materials.push_back(material);
+	}
+
+	// 各領域の位置を決める
+	MeshCacheHeader header = {};
+	header.magic = kMagic;
+	header.version = kVersion;
+	header.key = key;
+	header.vertexStride = sizeof(VertexData);
+	header.vertexCount = static_cast<uint32_t>(modelData.vertices.size());
+	header.indexSize = indexSize;
+	header.indexCount = static_cast<uint32_t>(modelData.indices.size());
+	header.submeshCount = static_cast<uint32_t>(submeshes.size());
+	header.lodCount = static_cast<uint32_t>(lods.size());
+	header.meshletCount = static_cast<uint32_t>(modelData.meshletData.meshlets.size());
+	header.meshletVertexCount = static_cast<uint32_t>(modelData.meshletData.vertices.size());
+	header.meshletTriangleCount = static_cast<uint32_t>(modelData.meshletData.triangles.size() / 3);
+	header.materialCount = static_cast<uint32_t>(materials.size());
+	header.bounds = modelData.bounds;
+	header.sourcePathOffset = AlignUp(sizeof(MeshCacheHeader));
+	header.sourcePathSize = sourcePath.size();
+	header.vertexOffset = AlignUp(header.sourcePathOffset + header.sourcePathSize);
+	header.indexOffset = AlignUp(header.vertexOffset + sizeof(VertexData) * modelData.vertices.size());
+	header.submeshOffset = AlignUp(header.indexOffset + indices.size());
+	header.lodOffset = AlignUp(header.submeshOffset + sizeof(MeshCacheSubmesh) * header.submeshCount);
+	header.meshletOffset = AlignUp(header.lodOffset + sizeof(MeshCacheLod) * header.lodCount);
+	header.meshletBoundsOffset = AlignUp(header.meshletOffset + sizeof(Meshlet) * header.meshletCount);
+	header.meshletVertexOffset = AlignUp(header.meshletBoundsOffset + sizeof(MeshletBounds) * header.meshletCount);
+	header.meshletTriangleOffset = AlignUp(header.meshletVertexOffset + sizeof(uint32_t) * header.meshletVertexCount);
+	header.materialOffset = AlignUp(header.meshletTriangleOffset + uint64_t(header.meshletTriangleCount) * 3);
+	header.stringOffset = AlignUp(header.materialOffset + sizeof(MeshCacheMaterial) * header.materialCount);
+	header.stringSize = strings.size();
+
+	// 領域の間は0で埋める
+	std::vector<char> data(header.stringOffset + header.stringSize, 0);
+	WriteSection(data, 0, &header, sizeof(header));
+	WriteSection(data, header.sourcePathOffset, sourcePath.data(), header.sourcePathSize);
+	WriteSection(data, header.vertexOffset, modelData.vertices.data(), sizeof(VertexData) * modelData.vertices.size());
+	WriteSection(data, header.indexOffset, indices.data(), indices.size());
+	WriteSection(data, header.submeshOffset, submeshes.data(), sizeof(MeshCacheSubmesh) * submeshes.size());
+	WriteSection(data, header.lodOffset, lods.data(), sizeof(MeshCacheLod) * lods.size());
+	WriteSection(data, header.meshletOffset, modelData.meshletData.meshlets.data(), sizeof(Meshlet) * header.meshletCount);
+	WriteSection(data, header.meshletBoundsOffset, modelData.meshletData.bounds.data(), sizeof(MeshletBounds) * header.meshletCount);
+	WriteSection(data, header.meshletVertexOffset, modelData.meshletData.vertices.data(), sizeof(uint32_t) * header.meshletVertexCount);
+	WriteSection(data, header.meshletTriangleOffset, modelData.meshletData.triangles.data(), modelData.meshletData.triangles.size());
+	WriteSection(data, header.materialOffset, materials.data(), sizeof(MeshCacheMaterial) * materials.size());
+	WriteSection(data, header.stringOffset, strings.data(), strings.size());
+	return data;
+}
+
+// キャッシュファイルに書き出す
+bool MeshCache::Write(const std::string& cachePath, const std::vector<char>& data)
+{
+	// 途中で失敗しても壊れたキャッシュが残らないように、一時ファイルに書いてから置き換える
+	const std::string temporaryPath = cachePath + ".tmp";
+	{
+		std::ofstream stream(ToPath(temporaryPath), std::ios::binary | std::ios::trunc);
+		if (!stream)
+		{
+			return false;
+		}
+		stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+		if (!stream)
+		{
+			stream.close();
+			std::error_code errorCode;
+			std::filesystem::remove(ToPath(temporaryPath), errorCode);
+			return false;
+		}
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(ToPath(temporaryPath), ToPath(cachePath), errorCode);
+	if (errorCode)
+	{
+		std::filesystem::remove(ToPath(temporaryPath), errorCode);
+		return false;
+	}
+	return true;
+}
+
+// キーだけ書き直す
+bool MeshCache::RewriteKey(const std::string& cachePath, const MeshCacheKey& key)
+{
+	std::fstream stream(ToPath(cachePath), std::ios::binary | std::ios::in | std::ios::out);
+	if (!stream)
+	{
+		return false;
+	}
+	stream.seekp(offsetof(MeshCacheHeader, key));
+	stream.write(reinterpret_cast<const char*>(&key), sizeof(key));
+	return static_cast<bool>(stream);
+}
+
+// 変換元のファイルのサイズと更新時刻
+bool MeshCache::GetSourceKey(const std::string& sourcePath, MeshCacheKey& key)
+{
+	const std::filesystem::path path = ToPath(sourcePath);
+	std::error_code errorCode;
+	const uintmax_t size = std::filesystem::file_size(path, errorCode);
+	if (errorCode)
+	{
+		return false;
+	}
+	const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, errorCode);
+	if (errorCode)
+	{
+		return false;
+	}
+	key.sourceSize = static_cast<uint64_t>(size);
+	key.sourceTime = static_cast<int64_t>(time.time_since_epoch().count());
+	key.contentHash = 0;
+	return true;
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+#include "ObjLoader.h"
+#include "MaterialLibrary.h"
+
+// 変換元のファイルを見分けるための情報
+struct MeshCacheKey
+{
+	uint64_t sourceSize; // ファイルサイズ
+	int64_t sourceTime; // 最終更新時刻
+	uint64_t contentHash; // 中身のハッシュ
+};
+
+// サブメッシュ（同じマテリアルで描画するインデックスの範囲）
+struct MeshCacheSubmesh
+{
+	uint32_t indexOffset;
+	uint32_t indexCount;
+	uint32_t materialIndex; // マテリアル参照の番号
+	uint32_t meshletOffset;
+	uint32_t meshletCount;
+	uint32_t reserved[3];
+};
+
+// LOD（詳細度ごとのサブメッシュの範囲）
+struct MeshCacheLod
+{
+	uint32_t submeshOffset;
+	uint32_t submeshCount;
+	float error; // 元の形からの誤差（ローカル空間の距離）
+	uint32_t reserved;
+};
+
+// マテリアル参照（mtlファイル名とマテリアル名。中身はロード時にmtlから読む）
+struct MeshCacheMaterial
+{
+	uint32_t libraryOffset; // 文字列領域の中の位置
+	uint32_t librarySize;
+	uint32_t nameOffset;
+	uint32_t nameSize;
+};
+
+// キャッシュファイルの先頭
+// [ヘッダ][変換元のパス][頂点][インデックス][サブメッシュ][LOD][メッシュレット][メッシュレットの境界][メッシュレットの頂点][メッシュレットの三角形][マテリアル参照][文字列]
+// 各領域は16バイト境界から始まるので、マップしたままポインタで使える
+struct MeshCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	MeshCacheKey key;
+
+	uint32_t vertexStride; // sizeof(VertexData)
+	uint32_t vertexCount;
+	uint32_t indexSize; // 2 か 4
+	uint32_t indexCount;
+	uint32_t submeshCount;
+	uint32_t lodCount; // 1以上（0番が元の形）
+	uint32_t materialCount;
+	uint32_t meshletCount;
+	uint32_t meshletVertexCount;
+	uint32_t meshletTriangleCount;
+	AABB bounds;
+
+	// ファイルの先頭からの位置
+	uint64_t sourcePathOffset;
+	uint64_t sourcePathSize;
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+	uint64_t submeshOffset;
+	uint64_t lodOffset;
+	uint64_t meshletOffset;
+	uint64_t meshletBoundsOffset;
+	uint64_t meshletVertexOffset;
+	uint64_t meshletTriangleOffset;
+	uint64_t materialOffset;
+	uint64_t stringOffset;
+	uint64_t stringSize;
+};
+
+// 変換済みのメッシュのバイナリキャッシュ
+// テキストのobjを毎回解釈せずに、マップしたファイルからそのままアップロード用のバッファへコピーできる
+class MeshCache
+{
+public:
+	static constexpr uint32_t kMagic = 0x48534D47; // "GMSH"
+	static constexpr uint32_t kVersion = 4;
+
+	// キャッシュファイルを開き、形式と変換元のパスが正しいか確かめる（違えばfalse）
+	// 各領域の位置だけでなく、インデックスとメッシュレットの番号が頂点の数を超えていないかも確かめる
+	bool Open(const std::string& cachePath, const std::string& sourcePath);
+	// Serializeで作ったものをファイルの代わりにメモリに持って開く（キャッシュを書き出せなかったときに使う）
+	bool OpenMemory(std::vector<char> data, const std::string& sourcePath);
+	// 閉じる
+	void Close();
+
+	// 中身をModelDataとして取り出す（マテリアルはdirectoryPathのmtlから読む）
+	ModelData ToModelData(const std::string& directoryPath) const;
+	// マテリアル参照をdirectoryPathのmtlから読む（番号はサブメッシュのmaterialIndexと同じ）
+	std::vector<MaterialData> LoadMaterials(const std::string& directoryPath) const;
+	// マテリアル参照をMaterialLibraryのハンドルにする（同じmtlや同じ内容のマテリアルはほかのモデルと共有する）
+	std::vector<MaterialHandle> LoadMaterialHandles(const std::string& directoryPath) const;
+
+	// ModelDataをキャッシュファイルの形式にする
+	static std::vector<char> Serialize(const std::string& sourcePath, const MeshCacheKey& key, const ModelData& modelData, const std::string& materialLibrary);
+	// Serializeで作ったものをキャッシュファイルに書き出す（一時ファイルに書いてから置き換える）
+	static bool Write(const std::string& cachePath, const std::vector<char>& data);
+	// 変換元の中身は同じで更新時刻だけが変わったときに、キーだけ書き直す（閉じた状態で呼ぶ）
+	static bool RewriteKey(const std::string& cachePath, const MeshCacheKey& key);
+	// 変換元のファイルのサイズと更新時刻（ハッシュは0）。ファイルがなければfalse
+	static bool GetSourceKey(const std::string& sourcePath, MeshCacheKey& key);
+
+	// getter
+	bool IsOpen() const { return header_ != nullptr; }
+	const MeshCacheKey& GetKey() const { return header_->key; }
+	const AABB& GetBounds() const { return header_->bounds; }
+	const VertexData* GetVertices() const { return reinterpret_cast<const VertexData*>(data_ + header_->vertexOffset); }
+	uint32_t GetVertexCount() const { return header_->vertexCount; }
+	const void* GetIndices() const { return data_ + header_->indexOffset; }
+	uint32_t GetIndexSize() const { return header_->indexSize; }
+	uint32_t GetIndexCount() const { return header_->indexCount; }
+	const MeshCacheSubmesh* GetSubmeshes() const { return reinterpret_cast<const MeshCacheSubmesh*>(data_ + header_->submeshOffset); }
+	uint32_t GetSubmeshCount() const { return header_->submeshCount; }
+	const MeshCacheLod* GetLods() const { return reinterpret_cast<const MeshCacheLod*>(data_ + header_->lodOffset); }
+	uint32_t GetLodCount() const { return header_->lodCount; }
+	const Meshlet* GetMeshlets() const { return reinterpret_cast<const Meshlet*>(data_ + header_->meshletOffset); }
+	const MeshletBounds* GetMeshletBounds() const { return reinterpret_cast<const MeshletBounds*>(data_ + header_->meshletBoundsOffset); }
+	uint32_t GetMeshletCount() const { return header_->meshletCount; }
+	const uint32_t* GetMeshletVertices() const { return reinterpret_cast<const uint32_t*>(data_ + header_->meshletVertexOffset); }
+	uint32_t GetMeshletVertexCount() const { return header_->meshletVertexCount; }
+	const uint8_t* GetMeshletTriangles() const { return reinterpret_cast<const uint8_t*>(data_ + header_->meshletTriangleOffset); }
+	uint32_t GetMeshletTriangleCount() const { return header_->meshletTriangleCount; }
+	uint32_t GetMaterialCount() const { return header_->materialCount; }
+	std::string_view GetMaterialLibrary(uint32_t materialIndex) const;
+	std::string_view GetMaterialName(uint32_t materialIndex) const;
+
+private:
+	// data_とsize_の中身が正しいか確かめる（正しければheader_を設定する）
+	bool Validate(const std::string& sourcePath);
+
+	// ファイルから開いたときはマップしたファイル、メモリから開いたときはmemory_を指す
+	MappedFile file_;
+	std::vector<char> memory_;
+	const char* data_ = nullptr;
+	uint64_t size_ = 0;
+	const MeshCacheHeader* header_ = nullptr;
+};
@@ -0,0 +1,376 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+
+#include "Vector3.h"
+
+namespace
+{
+	// Forsythの方法で点数を付けるときのキャッシュの大きさ
+	constexpr size_t kScoreCacheSize = 32;
+	// 点数表を作っておく残りの三角形の数の上限（それ以上は同じ点数）
+	constexpr uint32_t kMaxScoreValence = 32;
+
+	// 頂点の点数表
+	// キャッシュの中で新しいほど、残りの三角形が少ないほど高い（Tom Forsyth, Linear-Speed Vertex Cache Optimisation）
+	struct VertexScoreTable
+	{
+		float cache[kScoreCacheSize];
+		float valence[kMaxScoreValence + 1];
+
+		VertexScoreTable()
+		{
+			constexpr float kLastTriangleScore = 0.75f;
+			constexpr float kCacheDecayPower = 1.5f;
+			constexpr float kValenceBoostScale = 2.0f;
+			constexpr float kValenceBoostPower = 0.5f;
+			for (size_t i = 0; i < kScoreCacheSize; ++i)
+			{
+				// 直前の三角形の3頂点は、同じ三角形を続けて選びすぎないように少し低くする
+				cache[i] = i < 3 ? kLastTriangleScore : std::pow(1.0f - float(i - 3) / float(kScoreCacheSize - 3), kCacheDecayPower);
+			}
+			valence[0] = 0.0f;
+			for (uint32_t i = 1; i <= kMaxScoreValence; ++i)
+			{
+				valence[i] = kValenceBoostScale * std::pow(float(i), -kValenceBoostPower);
+			}
+		}
+
+		// cachePositionはキャッシュにないとき-1
+		float GetScore(int32_t cachePosition, uint32_t remainingValence) const
+		{
+			if (remainingValence == 0)
+			{
+				return -1.0f;
+			}
+			const float cacheScore = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+			return cacheScore + valence[(std::min)(remainingValence, kMaxScoreValence)];
+		}
+	};
+
+	// FIFOの頂点キャッシュ（最後に読み込んだ時刻で判定する）
+	class FifoCache
+	{
+	public:
+		FifoCache(size_t vertexCount, uint32_t cacheSize) : timestamps_(vertexCount, 0), cacheSize_(cacheSize), timestamp_(cacheSize + 1) {}
+
+		// 頂点を参照して、キャッシュになかったらtrue
+		bool Access(uint32_t vertex)
+		{
+			if (timestamp_ - timestamps_[vertex] > cacheSize_)
+			{
+				timestamps_[vertex] = timestamp_++;
+				return true;
+			}
+			return false;
+		}
+
+		// キャッシュを空にする
+		void Reset() { timestamp_ += cacheSize_ + 1; }
+
+	private:
+		std::vector<uint32_t> timestamps_;
+		uint32_t cacheSize_;
+		uint32_t timestamp_;
+	};
+
+	// 三角形で頂点キャッシュに乗らなかった数
+	inline uint32_t CountMisses(FifoCache& cache, const uint32_t* triangle)
+	{
+		return uint32_t(cache.Access(triangle[0])) + uint32_t(cache.Access(triangle[1])) + uint32_t(cache.Access(triangle[2]));
+	}
+
+	inline Vector3 GetPosition(const VertexData& vertex)
+	{
+		return { vertex.position.x, vertex.position.y, vertex.position.z };
+	}
+}
+
+// FIFOの頂点キャッシュを模擬して効率を調べる
+VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStatistics statistics = {};
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<bool> isReferenced(vertexCount, false);
+	size_t referencedCount = 0;
+	for (size_t i = 0; i < indexCount; ++i)
+	{
+		statistics.vertexTransformCount += cache.Access(indices[i]) ? 1 : 0;
+		if (!isReferenced[indices[i]])
+		{
+			isReferenced[indices[i]] = true;
+			++referencedCount;
+		}
+	}
+	const size_t triangleCount = indexCount / 3;
+	statistics.acmr = triangleCount > 0 ? float(statistics.vertexTransformCount) / float(triangleCount) : 0.0f;
+	statistics.atvr = referencedCount > 0 ? float(statistics.vertexTransformCount) / float(referencedCount) : 0.0f;
+	return statistics;
+}
+
+// 三角形を頂点キャッシュに乗りやすい順番に並べ替える
+// キャッシュに入っている頂点を使う三角形の中から、頂点の点数の合計が一番高いものを貪欲に選んでいく
+void MeshOptimizer::OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+	static const VertexScoreTable kScoreTable;
+	const std::vector<uint32_t> source(indices, indices + indexCount);
+	const size_t triangleCount = indexCount / 3;
+
+	// 頂点ごとの三角形の一覧（まだ出力していない三角形を前に詰めて持つ）
+	std::vector<uint32_t> remainingValences(vertexCount, 0);
+	for (uint32_t vertex : source)
+	{
+		++remainingValences[vertex];
+	}
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remainingValences[vertex];
+	}
+	std::vector<uint32_t> adjacency(indexCount);
+	{
+		std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			adjacency[cursors[source[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<int32_t> cachePositions(vertexCount, -1);
+	std::vector<bool> isEmitted(triangleCount, false);
+	uint32_t cache[kScoreCacheSize + 3];
+	uint32_t newCache[kScoreCacheSize + 3];
+	size_t cacheCount = 0;
+
+	size_t nextTriangle = 0; // 候補がないときに次に探し始める位置
+	int64_t bestTriangle = -1;
+	for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+	{
+		// キャッシュに候補がなければ、まだ出力していない最初の三角形から始め直す
+		if (bestTriangle < 0)
+		{
+			while (isEmitted[nextTriangle])
+			{
+				++nextTriangle;
+			}
+			bestTriangle = static_cast<int64_t>(nextTriangle);
+		}
+
+		// 出力する
+		const uint32_t* triangle = &source[size_t(bestTriangle) * 3];
+		std::copy(triangle, triangle + 3, destination + emittedCount * 3);
+		isEmitted[size_t(bestTriangle)] = true;
+
+		// 各頂点の一覧から出力した三角形を外す
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			const uint32_t vertex = triangle[corner];
+			uint32_t* triangles = &adjacency[adjacencyOffsets[vertex]];
+			uint32_t& remaining = remainingValences[vertex];
+			const uint32_t* found = std::find(triangles, triangles + remaining, static_cast<uint32_t>(bestTriangle));
+			if (found != triangles + remaining)
+			{
+				triangles[found - triangles] = triangles[remaining - 1];
+				--remaining;
+			}
+		}
+
+		// 使った3頂点をキャッシュの先頭に入れる（LRU）
+		size_t newCacheCount = 0;
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			if (std::find(newCache, newCache + newCacheCount, triangle[corner]) == newCache + newCacheCount)
+			{
+				newCache[newCacheCount++] = triangle[corner];
+			}
+		}
+		for (size_t i = 0; i < cacheCount; ++i)
+		{
+			const uint32_t vertex = cache[i];
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+			{
+				newCache[newCacheCount++] = vertex;
+			}
+		}
+		// 溢れた頂点はキャッシュから外れる
+		for (size_t i = 0; i < newCacheCount; ++i)
+		{
+			cachePositions[newCache[i]] = i < kScoreCacheSize ? static_cast<int32_t>(i) : -1;
+		}
+		cacheCount = (std::min)(newCacheCount, kScoreCacheSize);
+		std::copy(newCache, newCache + cacheCount, cache);
+
+		// キャッシュにある頂点を使う三角形から次を選ぶ
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < cacheCount; ++i)
+		{
+			const uint32_t vertex = cache[i];
+			const uint32_t* triangles = &adjacency[adjacencyOffsets[vertex]];
+			for (uint32_t j = 0; j < remainingValences[vertex]; ++j)
+			{
+				const uint32_t* candidate = &source[size_t(triangles[j]) * 3];
+				float score = 0.0f;
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					score += kScoreTable.GetScore(cachePositions[candidate[corner]], remainingValences[candidate[corner]]);
+				}
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = triangles[j];
+				}
+			}
+		}
+	}
+}
+
+// キャッシュ効率を保てる範囲で三角形をまとまりに分け、外を向いたまとまりから描く
+// （Sander et al., Fast Triangle Reordering for Vertex Locality and Reduced Overdraw）
+void MeshOptimizer::OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const VertexData* vertices, size_t vertexCount, float threshold)
+{
+	const std::vector<uint32_t> source(indices, indices + indexCount);
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// 1.3頂点ともキャッシュに乗らなかった三角形で区切る（そこで順番を変えてもキャッシュ効率は変わらない）
+	FifoCache cache(vertexCount, kDefaultCacheSize);
+	std::vector<size_t> hardBoundaries;
+	for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+	{
+		if (CountMisses(cache, &source[triangle * 3]) == 3 || triangle == 0)
+		{
+			hardBoundaries.push_back(triangle);
+		}
+	}
+	hardBoundaries.push_back(triangleCount);
+
+	// 2.それぞれのまとまりを、キャッシュを空にして始めてもACMRがthreshold倍に収まるところでさらに区切る
+	std::vector<size_t> clusterStarts;
+	for (size_t hard = 0; hard + 1 < hardBoundaries.size(); ++hard)
+	{
+		const size_t begin = hardBoundaries[hard];
+		const size_t end = hardBoundaries[hard + 1];
+
+		cache.Reset();
+		uint32_t misses = 0;
+		for (size_t triangle = begin; triangle < end; ++triangle)
+		{
+			misses += CountMisses(cache, &source[triangle * 3]);
+		}
+		const float targetAcmr = float(misses) / float(end - begin) * threshold;
+
+		cache.Reset();
+		size_t clusterStart = begin;
+		uint32_t clusterMisses = 0;
+		for (size_t triangle = begin; triangle < end; ++triangle)
+		{
+			clusterMisses += CountMisses(cache, &source[triangle * 3]);
+			if (float(clusterMisses) <= targetAcmr * float(triangle + 1 - clusterStart))
+			{
+				clusterStarts.push_back(clusterStart);
+				clusterStart = triangle + 1;
+				clusterMisses = 0;
+				cache.Reset();
+			}
+		}
+		if (clusterStart < end)
+		{
+			clusterStarts.push_back(clusterStart);
+		}
+	}
+	clusterStarts.push_back(triangleCount);
+	const size_t clusterCount = clusterStarts.size() - 1;
+
+	// 3.まとまりごとの中心と向き（面積で重み付け）
+	std::vector<Vector3> clusterCentroids(clusterCount, Vector3{ 0.0f, 0.0f, 0.0f });
+	std::vector<Vector3> clusterNormals(clusterCount, Vector3{ 0.0f, 0.0f, 0.0f });
+	std::vector<float> clusterAreas(clusterCount, 0.0f);
+	Vector3 meshCentroid = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+	{
+		for (size_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle)
+		{
+			const Vector3 p0 = GetPosition(vertices[source[triangle * 3 + 0]]);
+			const Vector3 p1 = GetPosition(vertices[source[triangle * 3 + 1]]);
+			const Vector3 p2 = GetPosition(vertices[source[triangle * 3 + 2]]);
+			// 表面の向き（長さは面積の2倍）
+			const Vector3 normal = VectorMath::Cross(p1 - p0, p2 - p0);
+			const float area = VectorMath::Length(normal);
+			clusterCentroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+			clusterNormals[cluster] += normal;
+			clusterAreas[cluster] += area;
+		}
+		meshCentroid += clusterCentroids[cluster];
+		meshArea += clusterAreas[cluster];
+	}
+	if (meshArea > 0.0f)
+	{
+		meshCentroid /= meshArea;
+	}
+
+	// 4.メッシュの中心から外を向いているまとまりほど手前にあることが多いので先に描く
+	std::vector<float> sortKeys(clusterCount, 0.0f);
+	for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+	{
+		if (clusterAreas[cluster] > 0.0f)
+		{
+			const Vector3 centroid = clusterCentroids[cluster] / clusterAreas[cluster];
+			sortKeys[cluster] = VectorMath::Dot(centroid - meshCentroid, VectorMath::Normalize(clusterNormals[cluster]));
+		}
+	}
+	std::vector<uint32_t> clusterOrder(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+	{
+		clusterOrder[cluster] = static_cast<uint32_t>(cluster);
+	}
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	uint32_t* out = destination;
+	for (uint32_t cluster : clusterOrder)
+	{
+		out = std::copy(source.begin() + clusterStarts[cluster] * 3, source.begin() + clusterStarts[cluster + 1] * 3, out);
+	}
+}
+
+// 頂点を初めて参照される順に並べ直す
+void MeshOptimizer::OptimizeVertexFetch(std::vector<VertexData>& vertices, std::vector<uint32_t>& indices)
+{
+	constexpr uint32_t kUnused = UINT32_MAX;
+	std::vector<uint32_t> remap(vertices.size(), kUnused);
+	std::vector<VertexData> reordered;
+	reordered.reserve(vertices.size());
+	for (uint32_t& index : indices)
+	{
+		if (remap[index] == kUnused)
+		{
+			remap[index] = static_cast<uint32_t>(reordered.size());
+			reordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices.swap(reordered);
+}
+
+// サブメッシュごとに三角形を並べ替え、最後に頂点を並べ直す
+MeshOptimizationReport MeshOptimizer::Optimize(ModelData& modelData, float overdrawThreshold)
+{
+	MeshOptimizationReport report = {};
+	report.before = AnalyzeVertexCache(modelData.indices.data(), modelData.indices.size(), modelData.vertices.size());
+
+	// サブメッシュはマテリアルごとに別の描画になるので、範囲をまたがないように並べ替える
+	for (const Submesh& submesh : modelData.submeshes)
+	{
+		uint32_t* indices = modelData.indices.data() + submesh.indexOffset;
+		OptimizeVertexCache(indices, indices, submesh.indexCount, modelData.vertices.size());
+		OptimizeOverdraw(indices, indices, submesh.indexCount, modelData.vertices.data(), modelData.vertices.size(), overdrawThreshold);
+	}
+	OptimizeVertexFetch(modelData.vertices, modelData.indices);
+
+	report.after = AnalyzeVertexCache(modelData.indices.data(), modelData.indices.size(), modelData.vertices.size());
+	return report;
+}
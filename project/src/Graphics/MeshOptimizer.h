@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ObjLoader.h"
+
+// 頂点キャッシュの効率
+struct VertexCacheStatistics
+{
+	uint32_t vertexTransformCount; // 頂点シェーダーが実行される回数
+	float acmr; // 三角形1つあたりの頂点シェーダーの実行回数（0.5〜3。小さいほど良い）
+	float atvr; // 頂点1つあたりの頂点シェーダーの実行回数（1が最良）
+};
+
+// 最適化の前後の比較
+struct MeshOptimizationReport
+{
+	VertexCacheStatistics before;
+	VertexCacheStatistics after;
+};
+
+// インデックス付きメッシュのGPU向けの最適化
+// 1.頂点キャッシュに乗りやすい三角形の順番（Forsyth）
+// 2.キャッシュ効率をあまり落とさない範囲で、外を向いた三角形のまとまりを先に描く順番（オーバードローの削減）
+// 3.インデックスが参照する順に頂点を並べ直す（頂点フェッチの局所性）
+namespace MeshOptimizer
+{
+	// 解析に使うFIFOキャッシュの大きさ（一般的なGPUの頂点キャッシュ相当）
+	constexpr uint32_t kDefaultCacheSize = 16;
+	// オーバードロー削減でキャッシュ効率の悪化を許す割合
+	constexpr float kDefaultOverdrawThreshold = 1.05f;
+
+	// FIFOの頂点キャッシュを模擬して効率を調べる
+	VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = kDefaultCacheSize);
+
+	// 三角形を頂点キャッシュに乗りやすい順番に並べ替える（destinationとindicesは同じでもよい）
+	void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+	// キャッシュ効率を保てる範囲で三角形をまとまりに分け、外を向いたまとまりから描く順番にする
+	// indicesはOptimizeVertexCache済みであること（destinationとindicesは同じでもよい）
+	void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const VertexData* vertices, size_t vertexCount, float threshold = kDefaultOverdrawThreshold);
+	// 頂点を初めて参照される順に並べ直し、インデックスを付け替える（使われていない頂点は消す）
+	void OptimizeVertexFetch(std::vector<VertexData>& vertices, std::vector<uint32_t>& indices);
+
+	// サブメッシュごとに1と2を行い、最後に3を行う
+	MeshOptimizationReport Optimize(ModelData& modelData, float overdrawThreshold = kDefaultOverdrawThreshold);
+}
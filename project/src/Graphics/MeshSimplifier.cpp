@@ -0,0 +1,632 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "Vector3.h"
+
+namespace
+{
+	// 頂点の種類
+	enum class VertexKind : uint8_t
+	{
+		Manifold, // 縁でも継ぎ目でもない（どの辺の向きにも寄せられる）
+		Border, // 開いた縁の上（縁に沿ってだけ寄せられる）
+		Seam, // UV・法線の継ぎ目の上（継ぎ目の両側の頂点を一緒に、継ぎ目に沿ってだけ寄せられる）
+		Locked, // 動かさない（縁や継ぎ目が交わる点、サブメッシュの境目など）
+	};
+	constexpr size_t kVertexKindCount = 4;
+
+	// 行の種類の頂点を列の種類の頂点に寄せられるか
+	constexpr bool kCanCollapse[kVertexKindCount][kVertexKindCount] =
+	{
+		{ true, true, true, true },
+		{ false, true, false, false },
+		{ false, false, true, false },
+		{ false, false, false, false },
+	};
+
+	// 縁と継ぎ目の形を保つための重み（面の誤差より強く効かせる）
+	constexpr double kBoundaryWeight = 10.0;
+	// 1回の走査で、目標までに必要な分の何倍の誤差まで寄せるか
+	constexpr double kPassErrorScale = 1.5;
+	constexpr uint32_t kInvalidIndex = ~0u;
+
+	// 二次誤差（平面からの距離の2乗の和を、対称行列a・ベクトルb・定数cで表したものと、重みの合計）
+	struct Quadric
+	{
+		double a00, a11, a22, a01, a02, a12;
+		double b0, b1, b2;
+		double c;
+		double weight;
+	};
+
+	// 平面 dot(normal, p) + distance = 0 を重み付きで足す
+	void AddPlane(Quadric& quadric, double nx, double ny, double nz, double distance, double weight)
+	{
+		quadric.a00 += weight * nx * nx;
+		quadric.a11 += weight * ny * ny;
+		quadric.a22 += weight * nz * nz;
+		quadric.a01 += weight * nx * ny;
+		quadric.a02 += weight * nx * nz;
+		quadric.a12 += weight * ny * nz;
+		quadric.b0 += weight * nx * distance;
+		quadric.b1 += weight * ny * distance;
+		quadric.b2 += weight * nz * distance;
+		quadric.c += weight * distance * distance;
+		quadric.weight += weight;
+	}
+
+	void AddQuadric(Quadric& quadric, const Quadric& other)
+	{
+		quadric.a00 += other.a00;
+		quadric.a11 += other.a11;
+		quadric.a22 += other.a22;
+		quadric.a01 += other.a01;
+		quadric.a02 += other.a02;
+		quadric.a12 += other.a12;
+		quadric.b0 += other.b0;
+		quadric.b1 += other.b1;
+		quadric.b2 += other.b2;
+		quadric.c += other.c;
+		quadric.weight += other.weight;
+	}
+
+	// 位置pでの誤差（重みで割った、平面からの距離の2乗の平均）
+	double EvaluateQuadric(const Quadric& quadric, const Vector3& p)
+	{
+		const double x = p.x;
+		const double y = p.y;
+		const double z = p.z;
+		const double rx = quadric.a00 * x + quadric.a01 * y + quadric.a02 * z;
+		const double ry = quadric.a01 * x + quadric.a11 * y + quadric.a12 * z;
+		const double rz = quadric.a02 * x + quadric.a12 * y + quadric.a22 * z;
+		const double error = x * rx + y * ry + z * rz + 2.0 * (quadric.b0 * x + quadric.b1 * y + quadric.b2 * z) + quadric.c;
+		return quadric.weight > 0.0 ? (std::max)(error, 0.0) / quadric.weight : 0.0;
+	}
+
+	inline Vector3 GetPosition(const VertexData& vertex)
+	{
+		return { vertex.position.x, vertex.position.y, vertex.position.z };
+	}
+
+	// 同じ位置の頂点をまとめる
+	// remap[v]は同じ位置の代表の頂点、wedge[v]は同じ位置の次の頂点（たどると自分に戻る）
+	void BuildPositionRemap(const VertexData* vertices, size_t vertexCount, std::vector<uint32_t>& remap, std::vector<uint32_t>& wedge)
+	{
+		std::vector<uint32_t> order(vertexCount);
+		std::iota(order.begin(), order.end(), 0u);
+		const auto isLess = [vertices](uint32_t a, uint32_t b)
+			{
+				const Vector4& pa = vertices[a].position;
+				const Vector4& pb = vertices[b].position;
+				if (pa.x != pb.x) { return pa.x < pb.x; }
+				if (pa.y != pb.y) { return pa.y < pb.y; }
+				if (pa.z != pb.z) { return pa.z < pb.z; }
+				return a < b;
+			};
+		std::sort(order.begin(), order.end(), isLess);
+
+		remap.resize(vertexCount);
+		wedge.resize(vertexCount);
+		for (size_t begin = 0; begin < vertexCount;)
+		{
+			const Vector4& position = vertices[order[begin]].position;
+			size_t end = begin + 1;
+			while (end < vertexCount && vertices[order[end]].position.x == position.x &&
+				vertices[order[end]].position.y == position.y && vertices[order[end]].position.z == position.z)
+			{
+				++end;
+			}
+			for (size_t i = begin; i < end; ++i)
+			{
+				remap[order[i]] = order[begin];
+				wedge[order[i]] = order[i + 1 < end ? i + 1 : begin];
+			}
+			begin = end;
+		}
+	}
+
+	// 有向辺の一覧（頂点ごとに、三角形の中でその頂点の次に来る頂点を持つ）
+	class EdgeAdjacency
+	{
+	public:
+		// remapがnullptrでなければ、同じ位置の頂点を1つとして扱う
+		void Build(const uint32_t* indices, size_t indexCount, size_t vertexCount, const uint32_t* remap)
+		{
+			offsets_.assign(vertexCount + 1, 0);
+			for (size_t i = 0; i < indexCount; ++i)
+			{
+				++offsets_[GetVertex(indices[i], remap) + 1];
+			}
+			for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+			{
+				offsets_[vertex + 1] += offsets_[vertex];
+			}
+			targets_.resize(indexCount);
+			std::vector<uint32_t> cursors(offsets_.begin(), offsets_.end() - 1);
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t from = GetVertex(indices[i + corner], remap);
+					const uint32_t to = GetVertex(indices[i + (corner + 1) % 3], remap);
+					targets_[cursors[from]++] = to;
+				}
+			}
+		}
+
+		bool HasEdge(uint32_t from, uint32_t to) const
+		{
+			for (uint32_t i = offsets_[from]; i < offsets_[from + 1]; ++i)
+			{
+				if (targets_[i] == to)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+	private:
+		static uint32_t GetVertex(uint32_t vertex, const uint32_t* remap) { return remap ? remap[vertex] : vertex; }
+
+		std::vector<uint32_t> offsets_;
+		std::vector<uint32_t> targets_;
+	};
+
+	// 寄せる辺の候補
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double error;
+	};
+
+	// 寄せたときに周りの三角形が裏返るか（寄せる先を含む三角形はつぶれるので調べない）
+	bool HasTriangleFlips(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& triangleOffsets, const std::vector<uint32_t>& triangles,
+		const VertexData* vertices, const std::vector<uint32_t>& remap, uint32_t fromPosition, uint32_t toPosition)
+	{
+		const Vector3 target = GetPosition(vertices[toPosition]);
+		for (uint32_t i = triangleOffsets[fromPosition]; i < triangleOffsets[fromPosition + 1]; ++i)
+		{
+			const uint32_t* triangle = &indices[size_t(triangles[i]) * 3];
+			const uint32_t positions[3] = { remap[triangle[0]], remap[triangle[1]], remap[triangle[2]] };
+			if (positions[0] == toPosition || positions[1] == toPosition || positions[2] == toPosition)
+			{
+				continue;
+			}
+			Vector3 corners[3] = { GetPosition(vertices[triangle[0]]), GetPosition(vertices[triangle[1]]), GetPosition(vertices[triangle[2]]) };
+			const Vector3 normal = VectorMath::Cross(corners[1] - corners[0], corners[2] - corners[0]);
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				if (positions[corner] == fromPosition)
+				{
+					corners[corner] = target;
+				}
+			}
+			const Vector3 collapsedNormal = VectorMath::Cross(corners[1] - corners[0], corners[2] - corners[0]);
+			// 元からつぶれている三角形は向きがないので調べない
+			if (VectorMath::LengthSquared(normal) > 0.0f && VectorMath::Dot(normal, collapsedNormal) <= 0.0f)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// 簡略化の本体（isLockedが空でなければ、trueの頂点は動かさない）
+	size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const VertexData* vertices, size_t vertexCount,
+		const std::vector<uint32_t>& remap, const std::vector<uint32_t>& wedge, const std::vector<bool>& isLocked,
+		size_t targetIndexCount, float targetError, float* resultError)
+	{
+		std::vector<uint32_t> result(indices, indices + indexCount);
+		targetIndexCount = targetIndexCount / 3 * 3;
+		const double targetErrorSquared = double(targetError) * double(targetError);
+
+		// 元の形の二次誤差（同じ位置の頂点で共有する）
+		std::vector<Quadric> quadrics(vertexCount, Quadric{});
+		EdgeAdjacency adjacency;
+		adjacency.Build(result.data(), result.size(), vertexCount, nullptr);
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			const Vector3 p0 = GetPosition(vertices[result[i]]);
+			const Vector3 p1 = GetPosition(vertices[result[i + 1]]);
+			const Vector3 p2 = GetPosition(vertices[result[i + 2]]);
+			const Vector3 normal = VectorMath::Cross(p1 - p0, p2 - p0);
+			const double length = VectorMath::Length(normal);
+			if (length <= 0.0)
+			{
+				continue;
+			}
+			const double nx = normal.x / length;
+			const double ny = normal.y / length;
+			const double nz = normal.z / length;
+			const double distance = -(nx * p0.x + ny * p0.y + nz * p0.z);
+			// 面積で重みを付ける
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				AddPlane(quadrics[remap[result[i + corner]]], nx, ny, nz, distance, length * 0.5);
+			}
+
+			// 開いた辺（縁と継ぎ目）は、面に垂直で辺を含む平面も足して、辺から離れにくくする
+			const Vector3 triangleNormal = normal / float(length);
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t from = result[i + corner];
+				const uint32_t to = result[i + (corner + 1) % 3];
+				if (adjacency.HasEdge(to, from))
+				{
+					continue;
+				}
+				const Vector3 edge = GetPosition(vertices[to]) - GetPosition(vertices[from]);
+				const Vector3 edgeNormal = VectorMath::Normalize(VectorMath::Cross(edge, triangleNormal));
+				const double edgeDistance = -VectorMath::Dot(edgeNormal, GetPosition(vertices[from]));
+				const double edgeWeight = VectorMath::LengthSquared(edge) * kBoundaryWeight;
+				AddPlane(quadrics[remap[from]], edgeNormal.x, edgeNormal.y, edgeNormal.z, edgeDistance, edgeWeight);
+				AddPlane(quadrics[remap[to]], edgeNormal.x, edgeNormal.y, edgeNormal.z, edgeDistance, edgeWeight);
+			}
+		}
+
+		EdgeAdjacency positionAdjacency;
+		std::vector<VertexKind> kinds(vertexCount);
+		std::vector<uint32_t> loops(vertexCount);
+		std::vector<uint32_t> loopBacks(vertexCount);
+		std::vector<uint32_t> partners(vertexCount);
+		std::vector<uint32_t> openOutCounts(vertexCount);
+		std::vector<uint32_t> openInCounts(vertexCount);
+		std::vector<bool> isReferenced(vertexCount);
+		std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+		std::vector<uint32_t> triangles;
+		std::vector<Collapse> collapses;
+		std::vector<uint32_t> collapseRemap(vertexCount);
+		std::vector<bool> isCollapseLocked(vertexCount);
+		double maxError = 0.0;
+
+		while (result.size() > targetIndexCount)
+		{
+			const size_t triangleCount = result.size() / 3;
+			adjacency.Build(result.data(), result.size(), vertexCount, nullptr);
+			positionAdjacency.Build(result.data(), result.size(), vertexCount, remap.data());
+
+			// 開いた辺をたどれるようにする（loopsは開いた辺の先、loopBacksは元）
+			std::fill(loops.begin(), loops.end(), kInvalidIndex);
+			std::fill(loopBacks.begin(), loopBacks.end(), kInvalidIndex);
+			std::fill(openOutCounts.begin(), openOutCounts.end(), 0u);
+			std::fill(openInCounts.begin(), openInCounts.end(), 0u);
+			std::fill(isReferenced.begin(), isReferenced.end(), false);
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t from = result[i + corner];
+					const uint32_t to = result[i + (corner + 1) % 3];
+					isReferenced[from] = true;
+					if (!adjacency.HasEdge(to, from))
+					{
+						loops[from] = to;
+						loopBacks[to] = from;
+						++openOutCounts[from];
+						++openInCounts[to];
+					}
+				}
+			}
+
+			// 頂点の種類を決める
+			const auto isSingleLoop = [&](uint32_t vertex) { return openOutCounts[vertex] == 1 && openInCounts[vertex] == 1; };
+			const auto isPositionOpen = [&](uint32_t from, uint32_t to) { return !positionAdjacency.HasEdge(remap[to], remap[from]); };
+			for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+			{
+				partners[vertex] = kInvalidIndex;
+				if (!isReferenced[vertex])
+				{
+					continue;
+				}
+				uint32_t wedgeCount = 0;
+				for (uint32_t other = wedge[vertex]; other != vertex; other = wedge[other])
+				{
+					if (isReferenced[other])
+					{
+						partners[vertex] = other;
+						++wedgeCount;
+					}
+				}
+
+				VertexKind kind = VertexKind::Locked;
+				if (!isLocked.empty() && isLocked[vertex])
+				{
+					kind = VertexKind::Locked;
+				}
+				else if (wedgeCount == 0)
+				{
+					if (openOutCounts[vertex] == 0 && openInCounts[vertex] == 0)
+					{
+						kind = VertexKind::Manifold;
+					}
+					else if (isSingleLoop(vertex) && isPositionOpen(vertex, loops[vertex]) && isPositionOpen(loopBacks[vertex], vertex))
+					{
+						kind = VertexKind::Border;
+					}
+				}
+				else if (wedgeCount == 1)
+				{
+					// 継ぎ目の両側で1本ずつ開いた辺があり、位置で見ると閉じている
+					const uint32_t partner = partners[vertex];
+					if (isSingleLoop(vertex) && isSingleLoop(partner) &&
+						!isPositionOpen(vertex, loops[vertex]) && !isPositionOpen(loopBacks[vertex], vertex) &&
+						!isPositionOpen(partner, loops[partner]) && !isPositionOpen(loopBacks[partner], partner))
+					{
+						kind = VertexKind::Seam;
+					}
+				}
+				kinds[vertex] = kind;
+			}
+
+			// 位置ごとの三角形の一覧（裏返りの判定用）
+			std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+			for (uint32_t vertex : result)
+			{
+				++triangleOffsets[remap[vertex] + 1];
+			}
+			for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+			{
+				triangleOffsets[vertex + 1] += triangleOffsets[vertex];
+			}
+			triangles.resize(result.size());
+			{
+				std::vector<uint32_t> cursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+				for (size_t i = 0; i < result.size(); ++i)
+				{
+					triangles[cursors[remap[result[i]]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			// 寄せられる辺を集めて、向きは誤差の小さい方にする
+			const auto canCollapse = [&](uint32_t from, uint32_t to)
+				{
+					const VertexKind fromKind = kinds[from];
+					if (!kCanCollapse[size_t(fromKind)][size_t(kinds[to])])
+					{
+						return false;
+					}
+					// 縁と継ぎ目は、開いた辺に沿ってだけ寄せる（継ぎ目は反対側の頂点も同じ辺に沿っていること）
+					if (fromKind == VertexKind::Border || fromKind == VertexKind::Seam)
+					{
+						if (loops[from] != to && loopBacks[from] != to)
+						{
+							return false;
+						}
+					}
+					if (fromKind == VertexKind::Seam)
+					{
+						const uint32_t fromPartner = partners[from];
+						const uint32_t toPartner = partners[to];
+						if (toPartner == kInvalidIndex || (loops[fromPartner] != toPartner && loopBacks[fromPartner] != toPartner))
+						{
+							return false;
+						}
+					}
+					return true;
+				};
+			collapses.clear();
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t v0 = result[i + corner];
+					const uint32_t v1 = result[i + (corner + 1) % 3];
+					if (remap[v0] == remap[v1])
+					{
+						continue;
+					}
+					// 両側の三角形で2回出てくる辺は片方だけ調べる
+					if (v0 > v1 && adjacency.HasEdge(v1, v0))
+					{
+						continue;
+					}
+					const bool canCollapse01 = canCollapse(v0, v1);
+					const bool canCollapse10 = canCollapse(v1, v0);
+					const double error01 = canCollapse01 ? EvaluateQuadric(quadrics[remap[v0]], GetPosition(vertices[v1])) : 0.0;
+					const double error10 = canCollapse10 ? EvaluateQuadric(quadrics[remap[v1]], GetPosition(vertices[v0])) : 0.0;
+					if (canCollapse01 && (!canCollapse10 || error01 <= error10))
+					{
+						collapses.push_back({ v0, v1, error01 });
+					}
+					else if (canCollapse10)
+					{
+						collapses.push_back({ v1, v0, error10 });
+					}
+				}
+			}
+			if (collapses.empty())
+			{
+				break;
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+			// 目標までに必要な分の誤差を目安に、それより大きい誤差の辺は次の走査に回す（先に小さい誤差の辺が使えるようになるため）
+			const size_t removeGoal = triangleCount - targetIndexCount / 3;
+			const size_t collapseGoal = (std::min)(removeGoal / 2, collapses.size() - 1);
+			const double passErrorLimit = (std::min)(targetErrorSquared, collapses[collapseGoal].error * kPassErrorScale * kPassErrorScale);
+
+			// 誤差の小さい辺から寄せる。1回の走査では、同じ位置を2回動かさない
+			std::iota(collapseRemap.begin(), collapseRemap.end(), 0u);
+			std::fill(isCollapseLocked.begin(), isCollapseLocked.end(), false);
+			size_t removedCount = 0;
+			size_t collapseCount = 0;
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.error > passErrorLimit || removedCount >= removeGoal)
+				{
+					break;
+				}
+				const uint32_t fromPosition = remap[collapse.from];
+				const uint32_t toPosition = remap[collapse.to];
+				if (isCollapseLocked[fromPosition] || isCollapseLocked[toPosition])
+				{
+					continue;
+				}
+				if (HasTriangleFlips(result, triangleOffsets, triangles, vertices, remap, fromPosition, toPosition))
+				{
+					continue;
+				}
+
+				const VertexKind kind = kinds[collapse.from];
+				collapseRemap[collapse.from] = collapse.to;
+				if (kind == VertexKind::Seam)
+				{
+					collapseRemap[partners[collapse.from]] = partners[collapse.to];
+				}
+				AddQuadric(quadrics[toPosition], quadrics[fromPosition]);
+				isCollapseLocked[fromPosition] = true;
+				isCollapseLocked[toPosition] = true;
+				// 縁の辺は片側にしか三角形がない
+				removedCount += kind == VertexKind::Border ? 1 : 2;
+				maxError = (std::max)(maxError, collapse.error);
+				++collapseCount;
+			}
+			if (collapseCount == 0)
+			{
+				break;
+			}
+
+			// 付け替えて、つぶれた三角形を取り除く
+			size_t writeCount = 0;
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				const uint32_t a = collapseRemap[result[i]];
+				const uint32_t b = collapseRemap[result[i + 1]];
+				const uint32_t c = collapseRemap[result[i + 2]];
+				if (remap[a] == remap[b] || remap[b] == remap[c] || remap[c] == remap[a])
+				{
+					continue;
+				}
+				result[writeCount++] = a;
+				result[writeCount++] = b;
+				result[writeCount++] = c;
+			}
+			result.resize(writeCount);
+		}
+
+		std::copy(result.begin(), result.end(), destination);
+		if (resultError)
+		{
+			*resultError = static_cast<float>(std::sqrt(maxError));
+		}
+		return result.size();
+	}
+}
+
+// 簡略化する
+size_t MeshSimplifier::Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount, const VertexData* vertices, size_t vertexCount,
+	size_t targetIndexCount, float targetError, float* resultError)
+{
+	std::vector<uint32_t> remap;
+	std::vector<uint32_t> wedge;
+	BuildPositionRemap(vertices, vertexCount, remap, wedge);
+	return SimplifyMesh(destination, indices, indexCount, vertices, vertexCount, remap, wedge, {}, targetIndexCount, targetError, resultError);
+}
+
+// LODを作って足す
+// 各LODはLOD0から簡略化する（前のLODから重ねて簡略化すると誤差が積み上がって正しく測れないため）
+void MeshSimplifier::GenerateLods(ModelData& modelData, uint32_t lodCount, float reduction, float maxError)
+{
+	const uint32_t baseSubmeshCount = static_cast<uint32_t>(modelData.submeshes.size());
+	modelData.lods.assign(1, { 0, baseSubmeshCount, 0.0f });
+	if (lodCount <= 1 || modelData.indices.empty())
+	{
+		return;
+	}
+
+	const size_t vertexCount = modelData.vertices.size();
+	std::vector<uint32_t> remap;
+	std::vector<uint32_t> wedge;
+	BuildPositionRemap(modelData.vertices.data(), vertexCount, remap, wedge);
+
+	// 複数のサブメッシュで使う位置は、別々に動くと隙間ができるので動かさない
+	std::vector<uint32_t> owners(vertexCount, kInvalidIndex);
+	std::vector<bool> isLocked(vertexCount, false);
+	for (uint32_t submeshIndex = 0; submeshIndex < baseSubmeshCount; ++submeshIndex)
+	{
+		const Submesh& submesh = modelData.submeshes[submeshIndex];
+		for (uint32_t i = submesh.indexOffset; i < submesh.indexOffset + submesh.indexCount; ++i)
+		{
+			const uint32_t position = remap[modelData.indices[i]];
+			if (owners[position] == kInvalidIndex)
+			{
+				owners[position] = submeshIndex;
+			}
+			else if (owners[position] != submeshIndex)
+			{
+				isLocked[position] = true;
+			}
+		}
+	}
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		isLocked[vertex] = isLocked[remap[vertex]];
+	}
+
+	const float absoluteMaxError = maxError * VectorMath::Length(modelData.bounds.max - modelData.bounds.min);
+	size_t previousIndexCount = modelData.indices.size();
+	float previousError = 0.0f;
+	std::vector<uint32_t> simplified;
+	for (uint32_t level = 1; level < lodCount; ++level)
+	{
+		const double ratio = std::pow(double(reduction), double(level));
+		MeshLod lod = { static_cast<uint32_t>(modelData.submeshes.size()), 0, previousError };
+		const size_t lodIndexOffset = modelData.indices.size();
+		for (uint32_t submeshIndex = 0; submeshIndex < baseSubmeshCount; ++submeshIndex)
+		{
+			// push_backで場所が変わるのでコピーしておく
+			const Submesh submesh = modelData.submeshes[submeshIndex];
+			const size_t targetIndexCount = static_cast<size_t>(double(submesh.indexCount / 3) * ratio) * 3;
+			simplified.resize(submesh.indexCount);
+			float error = 0.0f;
+			const size_t indexCount = SimplifyMesh(simplified.data(), modelData.indices.data() + submesh.indexOffset, submesh.indexCount,
+				modelData.vertices.data(), vertexCount, remap, wedge, isLocked, targetIndexCount, absoluteMaxError, &error);
+			lod.error = (std::max)(lod.error, error);
+			if (indexCount == 0)
+			{
+				continue;
+			}
+			modelData.submeshes.push_back({ static_cast<uint32_t>(modelData.indices.size()), static_cast<uint32_t>(indexCount), submesh.materialIndex, 0, 0 });
+			modelData.indices.insert(modelData.indices.end(), simplified.begin(), simplified.begin() + indexCount);
+		}
+
+		// 縁や継ぎ目ばかりで、誤差の上限までにほとんど減らなければ、このLODは作らない
+		const size_t lodIndexCount = modelData.indices.size() - lodIndexOffset;
+		if (double(lodIndexCount) > double(previousIndexCount) * kMinLodReduction)
+		{
+			modelData.indices.resize(lodIndexOffset);
+			modelData.submeshes.resize(lod.submeshOffset);
+			break;
+		}
+		lod.submeshCount = static_cast<uint32_t>(modelData.submeshes.size()) - lod.submeshOffset;
+		modelData.lods.push_back(lod);
+		previousIndexCount = lodIndexCount;
+		previousError = lod.error;
+	}
+}
+
+// 画面上の誤差からLODを選ぶ
+uint32_t MeshSimplifier::SelectLod(const std::vector<MeshLod>& lods, float distance, float worldScale, float projectionScale, float pixelThreshold)
+{
+	// カメラがモデルの中にいるときは一番細かいもの
+	if (distance <= 0.0f)
+	{
+		return 0;
+	}
+	// 誤差はLODの順に大きくなるので、しきい値を超える手前まで進める
+	const float pixelsPerUnit = worldScale * projectionScale / distance;
+	uint32_t selected = 0;
+	for (uint32_t lod = 1; lod < lods.size(); ++lod)
+	{
+		if (lods[lod].error * pixelsPerUnit > pixelThreshold)
+		{
+			break;
+		}
+		selected = lod;
+	}
+	return selected;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ObjLoader.h"
+
+// インデックス付きメッシュの簡略化とLOD
+// 二次誤差（QEM）の小さい辺から順に、辺の片方の頂点をもう片方に寄せて三角形を減らす
+// 頂点は既存のものに寄せるだけなので、頂点バッファはLOD0と共有できる
+namespace MeshSimplifier
+{
+	// LODの数（LOD0を含む）
+	constexpr uint32_t kDefaultLodCount = 4;
+	// 1つ下のLODで残す三角形の割合
+	constexpr float kDefaultLodReduction = 0.5f;
+	// LODで許す誤差の上限（モデルの境界ボックスの対角線に対する割合）
+	constexpr float kDefaultMaxLodError = 0.1f;
+	// 前のLODからこの割合より減らなければ、それ以上LODを作らない
+	constexpr float kMinLodReduction = 0.9f;
+
+	// 三角形がtargetIndexCount/3個以下になるか、誤差がtargetErrorを超えるまで簡略化する
+	// 開いた縁とUV・法線の継ぎ目（同じ位置で属性の違う頂点）は、その線に沿ってしか動かさない
+	// 戻り値はdestinationに書いたインデックスの数（destinationはindexCount個分必要。indicesと同じでもよい）
+	// resultErrorには元の形からの誤差（モデルのローカル空間の距離）を返す
+	size_t Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount, const VertexData* vertices, size_t vertexCount,
+		size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+	// LOD0の後ろに簡略化したLODを作って足す（サブメッシュとインデックスはLODごとに後ろへ並べる）
+	// サブメッシュの境目の頂点は動かさないので、マテリアルの境目に隙間はできない
+	void GenerateLods(ModelData& modelData, uint32_t lodCount = kDefaultLodCount, float reduction = kDefaultLodReduction, float maxError = kDefaultMaxLodError);
+
+	// 画面上の誤差がpixelThreshold以下になる一番粗いLODを選ぶ
+	// distanceはカメラからの距離、worldScaleはワールド行列の拡大率
+	// projectionScaleは距離1で長さ1のものが画面上で何ピクセルになるか（画面の高さ * 0.5 * 射影行列のm[1][1]）
+	uint32_t SelectLod(const std::vector<MeshLod>& lods, float distance, float worldScale, float projectionScale, float pixelThreshold);
+}
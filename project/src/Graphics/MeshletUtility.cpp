@@ -0,0 +1,248 @@
+#include "MeshletUtility.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "ObjLoader.h"
+
+namespace
+{
+	// 法線の円錐がこれより広がっていたら（最も離れた法線との内積がこれ以下なら）裏向きの判定はしない
+	constexpr float kMinConeDot = 0.1f;
+	// 軸ごとの拡大率の違いをこの割合まで同じとみなす
+	constexpr float kUniformScaleTolerance = 1.0e-3f;
+
+	inline Vector3 GetPosition(const VertexData& vertex)
+	{
+		return { vertex.position.x, vertex.position.y, vertex.position.z };
+	}
+
+	// 点の集まりを包む球（Ritterの方法。最小ではないが十分に小さい）
+	Sphere ComputeBoundingSphere(const uint32_t* indices, size_t indexCount, const VertexData* vertices)
+	{
+		// 各軸で最も離れた2点のうち、一番離れている組を直径にして始める
+		uint32_t minVertices[3] = { indices[0], indices[0], indices[0] };
+		uint32_t maxVertices[3] = { indices[0], indices[0], indices[0] };
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			const Vector4& position = vertices[indices[i]].position;
+			const float values[3] = { position.x, position.y, position.z };
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				const Vector4& minPosition = vertices[minVertices[axis]].position;
+				const Vector4& maxPosition = vertices[maxVertices[axis]].position;
+				const float minValues[3] = { minPosition.x, minPosition.y, minPosition.z };
+				const float maxValues[3] = { maxPosition.x, maxPosition.y, maxPosition.z };
+				if (values[axis] < minValues[axis]) { minVertices[axis] = indices[i]; }
+				if (values[axis] > maxValues[axis]) { maxVertices[axis] = indices[i]; }
+			}
+		}
+		size_t widestAxis = 0;
+		float widestDistance = -1.0f;
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			const float distance = VectorMath::LengthSquared(GetPosition(vertices[maxVertices[axis]]) - GetPosition(vertices[minVertices[axis]]));
+			if (distance > widestDistance)
+			{
+				widestAxis = axis;
+				widestDistance = distance;
+			}
+		}
+		const Vector3 p0 = GetPosition(vertices[minVertices[widestAxis]]);
+		const Vector3 p1 = GetPosition(vertices[maxVertices[widestAxis]]);
+		Sphere sphere = { (p0 + p1) * 0.5f, VectorMath::Length(p1 - p0) * 0.5f };
+
+		// 外に出ている点があれば、その点まで包むように広げる
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			const Vector3 point = GetPosition(vertices[indices[i]]);
+			const float distance = VectorMath::Length(point - sphere.center);
+			if (distance > sphere.radius)
+			{
+				const float radius = (sphere.radius + distance) * 0.5f;
+				sphere.center += (point - sphere.center) * ((radius - sphere.radius) / distance);
+				sphere.radius = radius;
+			}
+		}
+		return sphere;
+	}
+}
+
+// 先頭から順にメッシュレットに分ける
+void MeshletUtility::BuildMeshlets(MeshletData& meshletData, const uint32_t* indices, uint32_t indexOffset, size_t indexCount, const VertexData* vertices,
+	uint32_t maxVertices, uint32_t maxTriangles)
+{
+	// メッシュレットの中の頂点の番号は1バイト
+	assert(maxVertices >= 3 && maxVertices <= 256 && maxTriangles >= 1 && maxTriangles <= 0xFFFF);
+
+	Meshlet meshlet = {};
+	const auto beginMeshlet = [&](size_t index)
+		{
+			meshlet.indexOffset = indexOffset + static_cast<uint32_t>(index);
+			meshlet.vertexOffset = static_cast<uint32_t>(meshletData.vertices.size());
+			meshlet.triangleOffset = static_cast<uint32_t>(meshletData.triangles.size());
+			meshlet.vertexCount = 0;
+			meshlet.triangleCount = 0;
+		};
+	const auto endMeshlet = [&]()
+		{
+			meshletData.meshlets.push_back(meshlet);
+			meshletData.bounds.push_back(ComputeBounds(indices + (meshlet.indexOffset - indexOffset), size_t(meshlet.triangleCount) * 3, vertices));
+		};
+	// メッシュレットの中の番号を探す（なければmeshlet.vertexCount以上の値）
+	const auto findVertex = [&](uint32_t vertex)
+		{
+			const uint32_t* begin = meshletData.vertices.data() + meshlet.vertexOffset;
+			return static_cast<uint32_t>(std::find(begin, begin + meshlet.vertexCount, vertex) - begin);
+		};
+
+	beginMeshlet(0);
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		// この三角形で増える頂点の数
+		uint32_t newVertexCount = 0;
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			const bool isRepeated = (corner > 0 && indices[i + corner] == indices[i]) || (corner > 1 && indices[i + corner] == indices[i + 1]);
+			if (!isRepeated && findVertex(indices[i + corner]) == meshlet.vertexCount)
+			{
+				++newVertexCount;
+			}
+		}
+		// 上限を超えるならここで区切る
+		if (meshlet.vertexCount + newVertexCount > maxVertices || meshlet.triangleCount + 1u > maxTriangles)
+		{
+			endMeshlet();
+			beginMeshlet(i);
+		}
+
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			uint32_t local = findVertex(indices[i + corner]);
+			if (local == meshlet.vertexCount)
+			{
+				meshletData.vertices.push_back(indices[i + corner]);
+				++meshlet.vertexCount;
+			}
+			meshletData.triangles.push_back(static_cast<uint8_t>(local));
+		}
+		++meshlet.triangleCount;
+	}
+	if (meshlet.triangleCount > 0)
+	{
+		endMeshlet();
+	}
+}
+
+// サブメッシュごとにメッシュレットを作る
+void MeshletUtility::BuildMeshlets(ModelData& modelData)
+{
+	modelData.meshletData = {};
+	for (Submesh& submesh : modelData.submeshes)
+	{
+		submesh.meshletOffset = static_cast<uint32_t>(modelData.meshletData.meshlets.size());
+		BuildMeshlets(modelData.meshletData, modelData.indices.data() + submesh.indexOffset, submesh.indexOffset, submesh.indexCount, modelData.vertices.data());
+		submesh.meshletCount = static_cast<uint32_t>(modelData.meshletData.meshlets.size()) - submesh.meshletOffset;
+	}
+}
+
+// 境界球と法線の円錐
+MeshletBounds MeshletUtility::ComputeBounds(const uint32_t* indices, size_t indexCount, const VertexData* vertices)
+{
+	MeshletBounds bounds = {};
+	if (indexCount < 3)
+	{
+		bounds.cone.cutoff = 1.0f;
+		return bounds;
+	}
+	bounds.sphere = ComputeBoundingSphere(indices, indexCount, vertices);
+
+	// 軸は三角形の法線の平均
+	Vector3 axis = {};
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		const Vector3 p0 = GetPosition(vertices[indices[i]]);
+		axis += VectorMath::Normalize(VectorMath::Cross(GetPosition(vertices[indices[i + 1]]) - p0, GetPosition(vertices[indices[i + 2]]) - p0));
+	}
+	bounds.cone.apex = bounds.sphere.center;
+	bounds.cone.axis = VectorMath::Normalize(axis);
+	bounds.cone.cutoff = 1.0f;
+	if (VectorMath::LengthSquared(bounds.cone.axis) == 0.0f)
+	{
+		return bounds;
+	}
+
+	// 軸から最も離れた法線と、すべての三角形の平面の裏側に来る頂点の位置
+	float minDot = 1.0f;
+	float maxT = 0.0f;
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		const Vector3 p0 = GetPosition(vertices[indices[i]]);
+		const Vector3 normal = VectorMath::Cross(GetPosition(vertices[indices[i + 1]]) - p0, GetPosition(vertices[indices[i + 2]]) - p0);
+		if (VectorMath::LengthSquared(normal) == 0.0f)
+		{
+			continue;
+		}
+		const Vector3 unitNormal = VectorMath::Normalize(normal);
+		const float dot = VectorMath::Dot(bounds.cone.axis, unitNormal);
+		minDot = (std::min)(minDot, dot);
+		if (dot > kMinConeDot)
+		{
+			maxT = (std::max)(maxT, VectorMath::Dot(bounds.sphere.center - p0, unitNormal) / dot);
+		}
+	}
+	if (minDot <= kMinConeDot)
+	{
+		return bounds;
+	}
+	// 頂点を軸の後ろに下げると、そこから見て円錐の内側にいるカメラにはすべての三角形が裏を向ける
+	bounds.cone.apex = bounds.sphere.center - bounds.cone.axis * maxT;
+	bounds.cone.cutoff = std::sqrt(1.0f - minDot * minDot);
+	return bounds;
+}
+
+// 視錐台と裏向きの判定をして、描画する範囲を書き出す
+size_t MeshletUtility::CullMeshlets(const Meshlet* meshlets, const MeshletBounds* bounds, size_t count, const Matrix4x4& world,
+	const Frustum& frustum, const Vector3& cameraPosition, bool isBackfaceCulling, IndexRange* ranges)
+{
+	// 境界球の半径には一番大きい拡大率を掛ける
+	const float scaleX = VectorMath::Length(Vector3{ world.m[0][0], world.m[0][1], world.m[0][2] });
+	const float scaleY = VectorMath::Length(Vector3{ world.m[1][0], world.m[1][1], world.m[1][2] });
+	const float scaleZ = VectorMath::Length(Vector3{ world.m[2][0], world.m[2][1], world.m[2][2] });
+	const float maxScale = (std::max)({ scaleX, scaleY, scaleZ });
+	const float minScale = (std::min)({ scaleX, scaleY, scaleZ });
+	// 拡大率が軸ごとに違うと法線の角度が変わり、円錐が使えない
+	const bool isConeTest = isBackfaceCulling && maxScale - minScale <= maxScale * kUniformScaleTolerance;
+
+	size_t rangeCount = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const MeshletBounds& meshletBounds = bounds[i];
+		const Sphere sphere = { MatrixMath::TransformCoord(meshletBounds.sphere.center, world), meshletBounds.sphere.radius * maxScale };
+		if (!Culling::IsVisible(frustum, sphere))
+		{
+			continue;
+		}
+		if (isConeTest && meshletBounds.cone.cutoff < 1.0f)
+		{
+			const Vector3 apex = MatrixMath::TransformCoord(meshletBounds.cone.apex, world);
+			const Vector3 axis = VectorMath::Normalize(MatrixMath::TransformNormal(meshletBounds.cone.axis, world));
+			if (VectorMath::Dot(VectorMath::Normalize(apex - cameraPosition), axis) >= meshletBounds.cone.cutoff)
+			{
+				continue;
+			}
+		}
+
+		// 直前の範囲に続いていればまとめる（描画の回数を減らす）
+		const uint32_t indexCount = uint32_t(meshlets[i].triangleCount) * 3;
+		if (rangeCount > 0 && ranges[rangeCount - 1].indexOffset + ranges[rangeCount - 1].indexCount == meshlets[i].indexOffset)
+		{
+			ranges[rangeCount - 1].indexCount += indexCount;
+		}
+		else
+		{
+			ranges[rangeCount++] = { meshlets[i].indexOffset, indexCount };
+		}
+	}
+	return rangeCount;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "VertexData.h"
+#include "Culling.h"
+#include "Matrix4x4.h"
+
+struct ModelData;
+
+// メッシュレット（頂点と三角形の数を制限した三角形のまとまり）
+// 三角形は元のインデックスバッファのindexOffsetから連続しているので、そのまま描画の範囲として使える
+struct Meshlet
+{
+	uint32_t indexOffset; // 元のインデックスバッファの中の位置
+	uint32_t vertexOffset; // MeshletData::verticesの中の位置
+	uint32_t triangleOffset; // MeshletData::trianglesの中の位置（三角形1つで3バイト）
+	uint16_t vertexCount;
+	uint16_t triangleCount;
+};
+
+// 法線の向きの範囲（すべての三角形の法線がaxisの周りの円錐に入る）
+// apexからカメラへの向きが円錐の裏側にあれば、すべての三角形が裏向き
+struct NormalCone
+{
+	Vector3 apex;
+	Vector3 axis;
+	float cutoff; // 裏向きと判定するdot(normalize(apex - カメラの位置), axis)の下限（1なら判定しない）
+};
+
+// メッシュレットの境界
+struct MeshletBounds
+{
+	Sphere sphere;
+	NormalCone cone;
+};
+
+// メッシュレットの一覧
+struct MeshletData
+{
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshletBounds> bounds; // meshletsと同じ順番
+	std::vector<uint32_t> vertices; // メッシュレットの頂点の番号（元の頂点バッファの番号）
+	std::vector<uint8_t> triangles; // 三角形ごとに、メッシュレットの頂点の中の番号を3つ
+};
+
+// 描画するインデックスの範囲
+struct IndexRange
+{
+	uint32_t indexOffset;
+	uint32_t indexCount;
+};
+
+// メッシュレットの作成とCPUでのカリング
+// 作るのは変換時、カリングは描画ごとに行い、生き残った範囲だけを描画する
+namespace MeshletUtility
+{
+	// 1つのメッシュレットの頂点と三角形の上限（メッシュシェーダーで一般的な大きさ）
+	constexpr uint32_t kMaxVertices = 64;
+	constexpr uint32_t kMaxTriangles = 124;
+
+	// indices[0, indexCount)を先頭から順に、上限を超えるところで区切ってメッシュレットにし、meshletDataの後ろに足す
+	// 頂点キャッシュ最適化済みの順番なら、近くの三角形が同じメッシュレットに入る
+	// indexOffsetはindicesの先頭が元のインデックスバッファのどこか
+	void BuildMeshlets(MeshletData& meshletData, const uint32_t* indices, uint32_t indexOffset, size_t indexCount, const VertexData* vertices,
+		uint32_t maxVertices = kMaxVertices, uint32_t maxTriangles = kMaxTriangles);
+	// サブメッシュごとにメッシュレットを作る（modelData.meshletsを作り直し、Submeshのメッシュレットの範囲を設定する）
+	void BuildMeshlets(ModelData& modelData);
+	// 三角形の境界球と法線の円錐
+	MeshletBounds ComputeBounds(const uint32_t* indices, size_t indexCount, const VertexData* vertices);
+
+	// 視錐台の外のものと、isBackfaceCullingがtrueなら全部裏向きのものを除き、描画する範囲をrangesに書き込む
+	// 続いているメッシュレットは1つの範囲にまとめる。rangesはcount要素分確保しておくこと。戻り値は範囲の数
+	// frustumとcameraPositionはワールド空間。境界はworldで変換して判定する（拡大率が軸ごとに違えば円錐の判定はしない）
+	size_t CullMeshlets(const Meshlet* meshlets, const MeshletBounds* bounds, size_t count, const Matrix4x4& world,
+		const Frustum& frustum, const Vector3& cameraPosition, bool isBackfaceCulling, IndexRange* ranges);
+}
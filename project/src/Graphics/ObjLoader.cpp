@@ -0,0 +1,1430 @@
+#include "ObjLoader.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "MaterialLibrary.h"
+#include "HashUtility.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+#include <string_view>
+#include <thread>
+
+#ifdef _WIN32
+#include "StringUtility.h"
+#endif
+
+namespace
+{
+	// 1スレッドに任せる最小のバイト数（小さいファイルはスレッドを立てない）
+	constexpr size_t kMinChunkSize = 1024 * 1024;
+	// 頂点をまとめるときに1スレッドに任せる最小の数（面の頂点の数。少ないときはスレッドを立てない）
+	constexpr size_t kMinVertexKeysPerTask = 64 * 1024;
+
+	// 要素の番号が指定されていないことを表す値
+	constexpr int32_t kNoIndex = -1;
+
+	// 面の頂点が参照する要素の番号（0始まり）
+	// 負の値による相対指定はチャンクを読んでいる時点ではファイル全体の番号が分からないので、
+	// チャンクの先頭からの番号（前のチャンクを指すと負になる）にしてlocalMaskに印を付けておき、
+	// あとで各チャンクの開始位置を足して直す
+	struct FaceIndex
+	{
+		int32_t position;
+		int32_t texcoord;
+		int32_t normal;
+		uint8_t localMask; // kLocalPosition | kLocalTexcoord | kLocalNormal
+	};
+	constexpr uint8_t kLocalPosition = 1 << 0;
+	constexpr uint8_t kLocalTexcoord = 1 << 1;
+	constexpr uint8_t kLocalNormal = 1 << 2;
+
+	// usemtlで切り替えたマテリアル（firstTriangle番目の三角形から使う）
+	struct MaterialRun
+	{
+		size_t firstTriangle; // チャンクの中での番号
+		std::string_view name;
+	};
+
+	// ファイルの一部（行の区切りで分けたもの）から読み取った生のデータ
+	struct ObjChunk
+	{
+		std::vector<Vector4> positions; // 座標
+		std::vector<Vector2> texcoords; // テクスチャ座標
+		std::vector<Vector3> normals; // 法線
+		std::vector<FaceIndex> faceIndices; // 三角形ごとに3つずつ
+		std::vector<MaterialRun> materialRuns; // usemtlの位置
+		std::string_view materialFilename; // mtllibで指定されたファイル名
+
+		// ファイル全体での各要素の開始位置（プレフィックスサム）
+		size_t positionOffset = 0;
+		size_t texcoordOffset = 0;
+		size_t normalOffset = 0;
+		size_t triangleOffset = 0;
+	};
+
+	// ファイル全体の要素
+	struct ObjElements
+	{
+		std::vector<Vector4> positions;
+		std::vector<Vector2> texcoords;
+		std::vector<Vector3> normals;
+	};
+
+	// 0..count-1 を別々のスレッドで実行する（0番は呼び出したスレッドで実行）
+	template<typename Func>
+	void ParallelFor(size_t count, const Func& func)
+	{
+		std::vector<std::thread> threads;
+		threads.reserve(count > 0 ? count - 1 : 0);
+		for (size_t i = 1; i < count; ++i)
+		{
+			threads.emplace_back([&func, i]() { func(i); });
+		}
+		if (count > 0)
+		{
+			func(0);
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	// 行の中の空白（改行は含まない）
+	inline bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	// 空白を読み飛ばす
+	inline const char* SkipSpaces(const char* p, const char* end)
+	{
+		while (p < end && IsSpace(*p))
+		{
+			++p;
+		}
+		return p;
+	}
+
+	// 次の空白までを1つの単語として読む
+	inline std::string_view ReadToken(const char*& p, const char* end)
+	{
+		p = SkipSpaces(p, end);
+		const char* begin = p;
+		while (p < end && !IsSpace(*p))
+		{
+			++p;
+		}
+		return std::string_view(begin, static_cast<size_t>(p - begin));
+	}
+
+	// 行末（改行の位置、なければend）
+	inline const char* FindLineEnd(const char* p, const char* end)
+	{
+		const void* found = std::memchr(p, '\n', static_cast<size_t>(end - p));
+		return found ? static_cast<const char*>(found) : end;
+	}
+
+	// 小数を読む（失敗したら0）
+	inline float ReadFloat(const char*& p, const char* end)
+	{
+		p = SkipSpaces(p, end);
+		// from_charsは先頭の+を受け付けないので飛ばす
+		if (p < end && *p == '+')
+		{
+			++p;
+		}
+		float value = 0.0f;
+		const std::from_chars_result result = std::from_chars(p, end, value);
+		if (result.ec == std::errc())
+		{
+			p = result.ptr;
+		}
+		return value;
+	}
+
+	// 座標を読む（右手系から左手系にするためにxを反転する）
+	inline Vector4 ReadPosition(const char*& p, const char* end)
+	{
+		Vector4 position;
+		position.x = ReadFloat(p, end);
+		position.y = ReadFloat(p, end);
+		position.z = ReadFloat(p, end);
+		position.x *= -1.0f;
+		position.w = 1.0f;
+		return position;
+	}
+
+	// テクスチャ座標を読む（上下を反転する）
+	inline Vector2 ReadTexcoord(const char*& p, const char* end)
+	{
+		Vector2 texcoord;
+		texcoord.x = ReadFloat(p, end);
+		texcoord.y = ReadFloat(p, end);
+		texcoord.y = 1.0f - texcoord.y;
+		return texcoord;
+	}
+
+	// 法線を読む（座標と同じくxを反転する）
+	inline Vector3 ReadNormal(const char*& p, const char* end)
+	{
+		Vector3 normal;
+		normal.x = ReadFloat(p, end);
+		normal.y = ReadFloat(p, end);
+		normal.z = ReadFloat(p, end);
+		normal.x *= -1.0f;
+		return normal;
+	}
+
+	// mtlの色を読む（1つしか書かれていなければ3つとも同じ値）
+	inline Vector3 ReadColor(const char*& p, const char* end)
+	{
+		Vector3 color;
+		color.x = ReadFloat(p, end);
+		const char* rest = SkipSpaces(p, end);
+		if (rest >= end)
+		{
+			return { color.x, color.x, color.x };
+		}
+		color.y = ReadFloat(p, end);
+		color.z = ReadFloat(p, end);
+		return color;
+	}
+
+	// オプションの値として読める数値か
+	inline bool IsNumber(std::string_view token)
+	{
+		return !token.empty() && ((token[0] >= '0' && token[0] <= '9') || token[0] == '-' || token[0] == '+' || token[0] == '.');
+	}
+
+	// map_*のテクスチャのファイル名を読む（-s 1 1 1 などのオプションは読み飛ばし、行の残りをファイル名とする）
+	std::string_view ReadTextureFilename(const char* p, const char* end)
+	{
+		while (true)
+		{
+			p = SkipSpaces(p, end);
+			if (p >= end || *p != '-')
+			{
+				break;
+			}
+			// -o、-s、-tは値を1～3個、-mmは2個、ほかは1個とる
+			const std::string_view option = ReadToken(p, end);
+			const size_t argumentCount = (option == "-o" || option == "-s" || option == "-t") ? 3 : option == "-mm" ? 2 : 1;
+			for (size_t i = 0; i < argumentCount; ++i)
+			{
+				const char* next = p;
+				const std::string_view argument = ReadToken(next, end);
+				// 省略できる2つ目以降の値は、数値でなければそこで終わる
+				if (argument.empty() || (i > 0 && !IsNumber(argument)))
+				{
+					break;
+				}
+				p = next;
+			}
+		}
+		while (end > p && IsSpace(end[-1]))
+		{
+			--end;
+		}
+		return std::string_view(p, static_cast<size_t>(end - p));
+	}
+
+	// mtlのテクスチャの種類と、書き込む先
+	struct TextureKeyword
+	{
+		std::string_view identifier;
+		std::string MaterialData::* filePath;
+	};
+	constexpr TextureKeyword kTextureKeywords[] = {
+		{ "map_Kd", &MaterialData::textureFilePath },
+		{ "map_Ka", &MaterialData::ambientTextureFilePath },
+		{ "map_Ks", &MaterialData::specularTextureFilePath },
+		{ "map_Ns", &MaterialData::shininessTextureFilePath },
+		{ "map_d", &MaterialData::alphaTextureFilePath },
+		{ "map_Bump", &MaterialData::bumpTextureFilePath },
+		{ "map_bump", &MaterialData::bumpTextureFilePath },
+		{ "bump", &MaterialData::bumpTextureFilePath },
+		{ "norm", &MaterialData::bumpTextureFilePath },
+	};
+
+	// 要素の番号を読み、0始まりの番号にする
+	// 負の値（末尾からの相対指定）はcount個目からの番号にしてlocalMaskにlocalBitを立てる
+	template<typename Index>
+	inline Index ReadElementIndex(const char*& p, const char* end, uint64_t count, uint8_t localBit, uint8_t& localMask)
+	{
+		Index value = 0;
+		const std::from_chars_result result = std::from_chars(p, end, value);
+		if (result.ec != std::errc() || value == 0)
+		{
+			return kNoIndex;
+		}
+		p = result.ptr;
+		if (value < 0)
+		{
+			localMask |= localBit;
+			return static_cast<Index>(count) + value;
+		}
+		return value - 1;
+	}
+
+	// チャンクの先頭からの番号をファイル全体の番号に直す
+	inline int32_t ResolveIndex(int32_t index, uint8_t localMask, uint8_t localBit, size_t offset)
+	{
+		return (localMask & localBit) ? static_cast<int32_t>(offset) + index : index;
+	}
+
+	// 面の頂点を1つ読む（「位置/UV/法線」の形式）。countsはそこまでに出てきた座標・UV・法線の数
+	// Indexは番号の型（チャンクごとに読むときは32bit、ストリーミング読み込みはファイル全体の番号なので64bit）
+	template<typename Index>
+	inline bool ReadFaceVertex(const char*& p, const char* end, const uint64_t (&counts)[3], Index& position, Index& texcoord, Index& normal, uint8_t& localMask)
+	{
+		p = SkipSpaces(p, end);
+		if (p >= end || *p == '#')
+		{
+			return false;
+		}
+		localMask = 0;
+		position = ReadElementIndex<Index>(p, end, counts[0], kLocalPosition, localMask);
+		texcoord = kNoIndex;
+		normal = kNoIndex;
+		if (p < end && *p == '/')
+		{
+			++p;
+			texcoord = ReadElementIndex<Index>(p, end, counts[1], kLocalTexcoord, localMask);
+			if (p < end && *p == '/')
+			{
+				++p;
+				normal = ReadElementIndex<Index>(p, end, counts[2], kLocalNormal, localMask);
+			}
+		}
+		// 読めなかった残りの文字は読み飛ばす
+		while (p < end && !IsSpace(*p))
+		{
+			++p;
+		}
+		return true;
+	}
+
+	// チャンクの面の頂点を1つ読む（相対指定はチャンクの先頭からの番号にしてlocalMaskに記録する）
+	inline bool ReadFaceIndex(const char*& p, const char* end, const ObjChunk& chunk, FaceIndex& faceIndex)
+	{
+		const uint64_t counts[3] = { chunk.positions.size(), chunk.texcoords.size(), chunk.normals.size() };
+		return ReadFaceVertex(p, end, counts, faceIndex.position, faceIndex.texcoord, faceIndex.normal, faceIndex.localMask);
+	}
+
+	// 先に行の種類だけ数えて、配列の確保を1回で済ませる
+	void ReserveElements(const char* p, const char* end, ObjChunk& chunk)
+	{
+		size_t positionCount = 0;
+		size_t texcoordCount = 0;
+		size_t normalCount = 0;
+		size_t faceCount = 0;
+		while (p < end)
+		{
+			const char* lineEnd = FindLineEnd(p, end);
+			p = SkipSpaces(p, lineEnd);
+			if (lineEnd - p >= 2)
+			{
+				if (p[0] == 'v')
+				{
+					positionCount += IsSpace(p[1]) ? 1 : 0;
+					texcoordCount += p[1] == 't' ? 1 : 0;
+					normalCount += p[1] == 'n' ? 1 : 0;
+				}
+				else if (p[0] == 'f' && IsSpace(p[1]))
+				{
+					++faceCount;
+				}
+			}
+			p = lineEnd + 1;
+		}
+		chunk.positions.reserve(positionCount);
+		chunk.texcoords.reserve(texcoordCount);
+		chunk.normals.reserve(normalCount);
+		chunk.faceIndices.reserve(faceCount * 3);
+	}
+
+	// 1行を解釈する
+	void ParseLine(const char* p, const char* end, ObjChunk& chunk)
+	{
+		const std::string_view identifier = ReadToken(p, end);
+
+		// identifierに応じた処理
+		if (identifier == "v")
+		{
+			chunk.positions.push_back(ReadPosition(p, end));
+		}
+		else if (identifier == "vt")
+		{
+			chunk.texcoords.push_back(ReadTexcoord(p, end));
+		}
+		else if (identifier == "vn")
+		{
+			chunk.normals.push_back(ReadNormal(p, end));
+		}
+		else if (identifier == "f")
+		{
+			// 四角形以上の面は最初の頂点を中心に扇状に三角形に分ける（凸多角形を前提とする）
+			FaceIndex first;
+			FaceIndex previous;
+			FaceIndex current;
+			if (!ReadFaceIndex(p, end, chunk, first) || !ReadFaceIndex(p, end, chunk, previous))
+			{
+				return;
+			}
+			while (ReadFaceIndex(p, end, chunk, current))
+			{
+				chunk.faceIndices.push_back(first);
+				chunk.faceIndices.push_back(previous);
+				chunk.faceIndices.push_back(current);
+				previous = current;
+			}
+		}
+		else if (identifier == "usemtl")
+		{
+			// 以降の面で使うマテリアル
+			chunk.materialRuns.push_back({ chunk.faceIndices.size() / 3, ReadToken(p, end) });
+		}
+		else if (identifier == "mtllib")
+		{
+			// materialTemplateLibraryファイルの名前を取得する
+			chunk.materialFilename = ReadToken(p, end);
+		}
+	}
+
+	// チャンクを解釈する
+	void ParseChunk(const char* p, const char* end, ObjChunk& chunk)
+	{
+		ReserveElements(p, end, chunk);
+		while (p < end)
+		{
+			const char* lineEnd = FindLineEnd(p, end);
+			ParseLine(p, lineEnd, chunk);
+			p = lineEnd + 1;
+		}
+	}
+
+	// ファイルを行の区切りでchunkCount個に分ける
+	std::vector<std::string_view> SplitLines(const char* begin, const char* end, size_t chunkCount)
+	{
+		std::vector<std::string_view> chunks;
+		chunks.reserve(chunkCount);
+		const size_t size = static_cast<size_t>(end - begin);
+		const char* chunkBegin = begin;
+		for (size_t i = 1; i <= chunkCount && chunkBegin < end; ++i)
+		{
+			// 目安の位置から次の改行までを含める
+			const char* chunkEnd = i == chunkCount ? end : (std::max)(begin + size / chunkCount * i, chunkBegin);
+			if (chunkEnd < end)
+			{
+				chunkEnd = FindLineEnd(chunkEnd, end);
+				chunkEnd = chunkEnd < end ? chunkEnd + 1 : end;
+			}
+			chunks.emplace_back(chunkBegin, static_cast<size_t>(chunkEnd - chunkBegin));
+			chunkBegin = chunkEnd;
+		}
+		return chunks;
+	}
+
+	// 各チャンクの要素がファイル全体のどこから始まるかを求める（プレフィックスサム）
+	void ComputeOffsets(std::vector<ObjChunk>& chunks, ObjElements& elements, size_t& triangleCount)
+	{
+		size_t positionCount = 0;
+		size_t texcoordCount = 0;
+		size_t normalCount = 0;
+		triangleCount = 0;
+		for (ObjChunk& chunk : chunks)
+		{
+			chunk.positionOffset = positionCount;
+			chunk.texcoordOffset = texcoordCount;
+			chunk.normalOffset = normalCount;
+			chunk.triangleOffset = triangleCount;
+			positionCount += chunk.positions.size();
+			texcoordCount += chunk.texcoords.size();
+			normalCount += chunk.normals.size();
+			triangleCount += chunk.faceIndices.size() / 3;
+		}
+		elements.positions.resize(positionCount);
+		elements.texcoords.resize(texcoordCount);
+		elements.normals.resize(normalCount);
+	}
+
+	// チャンクの要素をファイル全体の配列にコピーする
+	void GatherElements(const ObjChunk& chunk, ObjElements& elements)
+	{
+		std::copy(chunk.positions.begin(), chunk.positions.end(), elements.positions.begin() + chunk.positionOffset);
+		std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), elements.texcoords.begin() + chunk.texcoordOffset);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), elements.normals.begin() + chunk.normalOffset);
+	}
+
+	// 要素の番号から値を取り出す（範囲外は既定値）
+	template<typename T>
+	inline T GetElement(const std::vector<T>& elements, int32_t index, const T& defaultValue)
+	{
+		return (index >= 0 && static_cast<size_t>(index) < elements.size()) ? elements[index] : defaultValue;
+	}
+
+	// 頂点を作る要素の番号の組（ファイル全体の番号）
+	struct VertexKey
+	{
+		int32_t position;
+		int32_t texcoord;
+		int32_t normal;
+
+		bool operator==(const VertexKey& other) const
+		{
+			return position == other.position && texcoord == other.texcoord && normal == other.normal;
+		}
+	};
+
+	// 空きを表すキー（positionは必ず0以上なので使われない）
+	constexpr VertexKey kEmptyKey = { INT32_MIN, INT32_MIN, INT32_MIN };
+
+	inline uint32_t HashVertexKey(const VertexKey& key)
+	{
+		uint32_t hash = static_cast<uint32_t>(key.position) * 0x9E3779B1u;
+		hash ^= static_cast<uint32_t>(key.texcoord) * 0x85EBCA77u;
+		hash ^= static_cast<uint32_t>(key.normal) * 0xC2B2AE3Du;
+		hash ^= hash >> 15;
+		hash *= 0x2C1B3C6Du;
+		hash ^= hash >> 13;
+		return hash;
+	}
+
+	// チャンクの面の番号をファイル全体の番号に直し、最終的な並びの位置に直接書き込む
+	void ResolveFaces(const ObjChunk& chunk, VertexKey* keys)
+	{
+		const size_t triangleCount = chunk.faceIndices.size() / 3;
+		VertexKey* out = keys + chunk.triangleOffset * 3;
+		for (size_t triangleIndex = 0; triangleIndex < triangleCount; ++triangleIndex)
+		{
+			for (size_t faceVertex = 0; faceVertex < 3; ++faceVertex)
+			{
+				const FaceIndex& faceIndex = chunk.faceIndices[triangleIndex * 3 + faceVertex];
+				// 頂点を逆順で登録することで、周り順を逆にする
+				VertexKey& key = out[2 - faceVertex];
+				key.position = ResolveIndex(faceIndex.position, faceIndex.localMask, kLocalPosition, chunk.positionOffset);
+				key.texcoord = ResolveIndex(faceIndex.texcoord, faceIndex.localMask, kLocalTexcoord, chunk.texcoordOffset);
+				key.normal = ResolveIndex(faceIndex.normal, faceIndex.localMask, kLocalNormal, chunk.normalOffset);
+			}
+			out += 3;
+		}
+	}
+
+	// マテリアル名に対応するModelData::materialsの番号（初めて出てきたら追加する）
+	uint32_t GetMaterialIndex(std::string_view name, const std::vector<MaterialData>& library, std::vector<MaterialData>& materials)
+	{
+		MaterialData material = ObjLoader::FindMaterial(library, name);
+		for (size_t i = 0; i < materials.size(); ++i)
+		{
+			if (materials[i].name == material.name)
+			{
+				return static_cast<uint32_t>(i);
+			}
+		}
+		materials.push_back(std::move(material));
+		return static_cast<uint32_t>(materials.size() - 1);
+	}
+
+	// 三角形ごとのマテリアルの番号を求める
+	// チャンクの先頭でusemtlより前にある面は、前のチャンクの最後のマテリアルを引き継ぐ
+	std::vector<uint32_t> AssignMaterials(const std::vector<ObjChunk>& chunks, size_t triangleCount, const std::vector<MaterialData>& library, std::vector<MaterialData>& materials)
+	{
+		std::vector<uint32_t> triangleMaterials(triangleCount);
+		uint32_t currentMaterial = UINT32_MAX;
+		for (const ObjChunk& chunk : chunks)
+		{
+			const size_t chunkTriangleCount = chunk.faceIndices.size() / 3;
+			size_t triangleIndex = 0;
+			for (size_t run = 0; run <= chunk.materialRuns.size(); ++run)
+			{
+				const size_t runEnd = run < chunk.materialRuns.size() ? chunk.materialRuns[run].firstTriangle : chunkTriangleCount;
+				if (runEnd > triangleIndex)
+				{
+					// usemtlがまだ出てきていない面は名前なしのマテリアル
+					if (currentMaterial == UINT32_MAX)
+					{
+						currentMaterial = GetMaterialIndex({}, library, materials);
+					}
+					std::fill(triangleMaterials.begin() + chunk.triangleOffset + triangleIndex, triangleMaterials.begin() + chunk.triangleOffset + runEnd, currentMaterial);
+					triangleIndex = runEnd;
+				}
+				if (run < chunk.materialRuns.size())
+				{
+					currentMaterial = GetMaterialIndex(chunk.materialRuns[run].name, library, materials);
+				}
+			}
+		}
+		return triangleMaterials;
+	}
+
+	// 三角形をマテリアルの番号順に並べ替え（同じマテリアルの中では元の順番のまま）、サブメッシュを作る
+	std::vector<Submesh> SortByMaterial(std::vector<VertexKey>& keys, const std::vector<uint32_t>& triangleMaterials, size_t materialCount)
+	{
+		// マテリアルごとの三角形の数から、各サブメッシュの開始位置を求める（カウンティングソート）
+		std::vector<uint32_t> counts(materialCount, 0);
+		for (uint32_t material : triangleMaterials)
+		{
+			++counts[material];
+		}
+		std::vector<Submesh> submeshes;
+		std::vector<size_t> starts(materialCount, 0);
+		size_t start = 0;
+		for (size_t material = 0; material < materialCount; ++material)
+		{
+			starts[material] = start;
+			if (counts[material] > 0)
+			{
+				submeshes.push_back({ static_cast<uint32_t>(start * 3), counts[material] * 3, static_cast<uint32_t>(material), 0, 0 });
+			}
+			start += counts[material];
+		}
+
+		// 1つのマテリアルしかなければ並べ替えは要らない
+		if (submeshes.size() > 1)
+		{
+			std::vector<VertexKey> sorted(keys.size());
+			for (size_t triangle = 0; triangle < triangleMaterials.size(); ++triangle)
+			{
+				const size_t destination = starts[triangleMaterials[triangle]]++;
+				std::copy(keys.begin() + triangle * 3, keys.begin() + triangle * 3 + 3, sorted.begin() + destination * 3);
+			}
+			keys.swap(sorted);
+		}
+		return submeshes;
+	}
+
+	// 同じ要素の組を1つの頂点にまとめ、頂点とインデックスを作る（頂点は組が初めて出てきた順に並べる）
+	// 組のハッシュ値でtaskCount個に分け、分けたものごとに別のスレッドでオープンアドレス法のハッシュテーブルを使う
+	// 1.キーを範囲ごとに分担して分け先を数え、分け先ごとに元の順番のままキーの位置を並べる
+	// 2.分け先ごとに、同じ組が最初に出てきた位置を求める
+	// 3.最初に出てきた位置に頂点の番号を順に振り（範囲ごとの数の累積和）、インデックスを作る
+	void BuildVertices(const std::vector<VertexKey>& keys, const ObjElements& elements, size_t threadCount, ModelData& modelData)
+	{
+		const size_t keyCount = keys.size();
+		const size_t taskCount = (std::max)(size_t(1), (std::min)(threadCount, keyCount / kMinVertexKeysPerTask + 1));
+		const auto getRange = [&](size_t task)
+			{
+				return std::pair<size_t, size_t>(keyCount * task / taskCount, keyCount * (task + 1) / taskCount);
+			};
+		// テーブルの位置はハッシュ値の下位ビットで決めるので、分け先は上位ビットで決める
+		const auto getPartition = [&](const VertexKey& key)
+			{
+				return static_cast<size_t>((uint64_t(HashVertexKey(key)) * taskCount) >> 32);
+			};
+
+		// 1.範囲ごと・分け先ごとの数から書き込む位置を決め（分け先の中は範囲の順）、キーの位置を並べる
+		std::vector<size_t> offsets(taskCount * taskCount, 0);
+		ParallelFor(taskCount, [&](size_t task)
+			{
+				const auto [begin, end] = getRange(task);
+				size_t* counts = offsets.data() + task * taskCount;
+				for (size_t i = begin; i < end; ++i)
+				{
+					++counts[getPartition(keys[i])];
+				}
+			});
+		std::vector<size_t> partitionStarts(taskCount + 1, 0);
+		size_t offset = 0;
+		for (size_t partition = 0; partition < taskCount; ++partition)
+		{
+			partitionStarts[partition] = offset;
+			for (size_t task = 0; task < taskCount; ++task)
+			{
+				const size_t count = offsets[task * taskCount + partition];
+				offsets[task * taskCount + partition] = offset;
+				offset += count;
+			}
+		}
+		partitionStarts[taskCount] = offset;
+		std::vector<uint32_t> partitionedKeys(keyCount);
+		ParallelFor(taskCount, [&](size_t task)
+			{
+				const auto [begin, end] = getRange(task);
+				size_t* taskOffsets = offsets.data() + task * taskCount;
+				for (size_t i = begin; i < end; ++i)
+				{
+					partitionedKeys[taskOffsets[getPartition(keys[i])]++] = static_cast<uint32_t>(i);
+				}
+			});
+
+		// 2.分け先の中はキーの位置の順に並んでいるので、テーブルに最初に入れたものが最初に出てきた位置になる
+		std::vector<uint32_t> firstPositions(keyCount);
+		ParallelFor(taskCount, [&](size_t partition)
+			{
+				const size_t begin = partitionStarts[partition];
+				const size_t end = partitionStarts[partition + 1];
+				size_t capacity = 16;
+				while (capacity < (end - begin) * 2)
+				{
+					capacity *= 2;
+				}
+				const size_t mask = capacity - 1;
+				std::vector<VertexKey> tableKeys(capacity, kEmptyKey);
+				std::vector<uint32_t> tableValues(capacity);
+				for (size_t j = begin; j < end; ++j)
+				{
+					const uint32_t position = partitionedKeys[j];
+					const VertexKey& key = keys[position];
+					size_t slot = HashVertexKey(key) & mask;
+					while (!(tableKeys[slot] == kEmptyKey) && !(tableKeys[slot] == key))
+					{
+						slot = (slot + 1) & mask;
+					}
+					if (tableKeys[slot] == kEmptyKey)
+					{
+						tableKeys[slot] = key;
+						tableValues[slot] = position;
+					}
+					firstPositions[position] = tableValues[slot];
+				}
+			});
+
+		// 3.範囲ごとの頂点の数の累積和から番号を振り、最初に出てきた位置で頂点を作る
+		std::vector<size_t> vertexStarts(taskCount + 1, 0);
+		ParallelFor(taskCount, [&](size_t task)
+			{
+				const auto [begin, end] = getRange(task);
+				size_t count = 0;
+				for (size_t i = begin; i < end; ++i)
+				{
+					count += firstPositions[i] == i ? 1 : 0;
+				}
+				vertexStarts[task + 1] = count;
+			});
+		for (size_t task = 0; task < taskCount; ++task)
+		{
+			vertexStarts[task + 1] += vertexStarts[task];
+		}
+		modelData.vertices.resize(vertexStarts[taskCount]);
+		modelData.indices.resize(keyCount);
+		ParallelFor(taskCount, [&](size_t task)
+			{
+				const auto [begin, end] = getRange(task);
+				uint32_t vertexIndex = static_cast<uint32_t>(vertexStarts[task]);
+				for (size_t i = begin; i < end; ++i)
+				{
+					if (firstPositions[i] != i)
+					{
+						continue;
+					}
+					// 要素へのIndexから、実際の要素の値を取得して、頂点を構築する
+					const VertexKey& key = keys[i];
+					assert(key.position >= 0 && static_cast<size_t>(key.position) < elements.positions.size());
+					VertexData& vertex = modelData.vertices[vertexIndex];
+					vertex.position = GetElement(elements.positions, key.position, Vector4{ 0.0f, 0.0f, 0.0f, 1.0f });
+					vertex.texcoord = GetElement(elements.texcoords, key.texcoord, Vector2{ 0.0f, 0.0f });
+					vertex.normal = GetElement(elements.normals, key.normal, Vector3{ 0.0f, 0.0f, 0.0f });
+					modelData.indices[i] = vertexIndex++;
+				}
+			});
+		// 2回目に出てきたものは、最初の位置に振った番号を使う（最初の位置は別の範囲のこともあるので、全部振ってから）
+		ParallelFor(taskCount, [&](size_t task)
+			{
+				const auto [begin, end] = getRange(task);
+				for (size_t i = begin; i < end; ++i)
+				{
+					if (firstPositions[i] != i)
+					{
+						modelData.indices[i] = modelData.indices[firstPositions[i]];
+					}
+				}
+			});
+	}
+	// マップしたobjファイルを解釈する
+	ModelData ParseObjFile(const MappedFile& file, const std::string& directoryPath, uint32_t threadCount, std::string& materialLibrary)
+	{
+		// 1.行の区切りでチャンクに分け、マップしたまま並列に解釈する
+		if (threadCount == 0)
+		{
+			threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+		}
+		const size_t chunkCount = (std::min)(static_cast<size_t>(threadCount), file.GetSize() / kMinChunkSize + 1);
+		const std::vector<std::string_view> ranges = SplitLines(file.GetData(), file.GetData() + file.GetSize(), chunkCount);
+		std::vector<ObjChunk> chunks(ranges.size());
+		ParallelFor(chunks.size(), [&](size_t i)
+			{
+				ParseChunk(ranges[i].data(), ranges[i].data() + ranges[i].size(), chunks[i]);
+			});
+
+		// 2.各チャンクの要素の開始位置を求め、ファイル全体の要素の配列にまとめる
+		ObjElements elements;
+		size_t triangleCount = 0;
+		ComputeOffsets(chunks, elements, triangleCount);
+		ParallelFor(chunks.size(), [&](size_t i)
+			{
+				GatherElements(chunks[i], elements);
+			});
+
+		// 3.面の番号を並列で直す
+		std::vector<VertexKey> keys(triangleCount * 3);
+		ParallelFor(chunks.size(), [&](size_t i)
+			{
+				ResolveFaces(chunks[i], keys.data());
+			});
+
+		// 4.マテリアル（後に書かれたmtllibを優先する）
+		std::vector<MaterialData> library;
+		for (auto chunk = chunks.rbegin(); chunk != chunks.rend(); ++chunk)
+		{
+			if (!chunk->materialFilename.empty())
+			{
+				// 基本的にobjファイルと同一階層にmtlは存在させるので、ディレクトリ名とファイル名を渡す
+				// 変換した後にキャッシュから開くときも同じmtlを使うので、MaterialLibraryを通して1回だけ読む
+				materialLibrary = std::string(chunk->materialFilename);
+				MaterialLibrary* materials = MaterialLibrary::GetInstance();
+				library = materials->GetMaterials(materials->Load(directoryPath, materialLibrary));
+				break;
+			}
+		}
+
+		// 5.三角形をマテリアルごとにまとめ、同じ組の頂点をまとめてインデックスを作る
+		ModelData modelData;
+		const std::vector<uint32_t> triangleMaterials = AssignMaterials(chunks, triangleCount, library, modelData.materials);
+		modelData.submeshes = SortByMaterial(keys, triangleMaterials, modelData.materials.size());
+		BuildVertices(keys, elements, threadCount, modelData);
+
+		if (!modelData.vertices.empty())
+		{
+			modelData.bounds = Culling::ComputeAABB(reinterpret_cast<const Vector3*>(&modelData.vertices[0].position), modelData.vertices.size(), sizeof(VertexData));
+		}
+
+		return modelData;
+	}
+
+	// objファイルを読み、キャッシュを書き出す
+	// cacheを渡したら、書き出したものと同じ中身をメモリから開く（書き出せなかったときもそのまま使える）
+	ModelData CookObjFile(const std::string& directoryPath, const std::string& sourcePath, const std::string& cachePath, uint32_t threadCount, MeshCache* cache = nullptr)
+	{
+		// ファイルをメモリにマップする
+		MeshCacheKey key = {};
+		MappedFile file;
+		const bool isOpen = MeshCache::GetSourceKey(sourcePath, key) && file.Open(sourcePath);
+		assert(isOpen); // とりあえず開けなかったら止める
+		if (!isOpen)
+		{
+			return {};
+		}
+		key.contentHash = HashUtility::ComputeHash64(file.GetData(), file.GetSize());
+
+		std::string materialLibrary;
+		ModelData modelData = ParseObjFile(file, directoryPath, threadCount, materialLibrary);
+
+		// 遠くで使う簡略化したLODを作る（頂点はLOD0と共有し、インデックスとサブメッシュを後ろに足す）
+		MeshSimplifier::GenerateLods(modelData);
+		for (size_t lod = 1; lod < modelData.lods.size(); ++lod)
+		{
+			uint32_t indexCount = 0;
+			for (uint32_t i = 0; i < modelData.lods[lod].submeshCount; ++i)
+			{
+				indexCount += modelData.submeshes[modelData.lods[lod].submeshOffset + i].indexCount;
+			}
+			Logger::Log(std::format("MeshSimplifier: {} LOD{} {} triangles, error {:.6f}\n", sourcePath, lod, indexCount / 3, modelData.lods[lod].error));
+		}
+
+		// GPU向けに三角形と頂点の順番を最適化する（キャッシュに入れるので変換時に1回だけ。LODのサブメッシュも含む）
+		const MeshOptimizationReport report = MeshOptimizer::Optimize(modelData);
+		Logger::Log(std::format("MeshOptimizer: {} ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}\n",
+			sourcePath, report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr));
+		// 並べ替えた後のインデックスからメッシュレットを作る（最適化した順番のまま区切るので、メッシュレットは連続した範囲になる）
+		MeshletUtility::BuildMeshlets(modelData);
+		// 書き出せなくても（読み込み専用の場所、ディスクがいっぱい、ほかのプロセスが開いているなど）読んだモデルはそのまま使う
+		// 次回もobjから変換し直すことになるので、ログに残す
+		std::vector<char> cacheData = MeshCache::Serialize(sourcePath, key, modelData, materialLibrary);
+		if (!MeshCache::Write(cachePath, cacheData))
+		{
+			Logger::Log(std::format("MeshCache: failed to write {}, using the cooked mesh from memory\n", cachePath));
+		}
+		if (cache)
+		{
+			const bool isOpen = cache->OpenMemory(std::move(cacheData), sourcePath);
+			assert(isOpen); // 今作ったものなので必ず開ける
+		}
+		return modelData;
+	}
+
+	// objから作った最新のキャッシュがあれば開く
+	bool OpenCache(const std::string& sourcePath, const std::string& cachePath, MeshCache& cache)
+	{
+		MeshCacheKey sourceKey = {};
+		if (!MeshCache::GetSourceKey(sourcePath, sourceKey) || !cache.Open(cachePath, sourcePath))
+		{
+			return false;
+		}
+		const MeshCacheKey cachedKey = cache.GetKey();
+		if (cachedKey.sourceSize != sourceKey.sourceSize)
+		{
+			cache.Close();
+			return false;
+		}
+		if (cachedKey.sourceTime == sourceKey.sourceTime)
+		{
+			return true;
+		}
+
+		// 更新時刻だけ変わった（チェックアウトし直したなど）なら、中身のハッシュで確かめる
+		MappedFile source;
+		if (!source.Open(sourcePath))
+		{
+			cache.Close();
+			return false;
+		}
+		sourceKey.contentHash = HashUtility::ComputeHash64(source.GetData(), source.GetSize());
+		cache.Close();
+		if (sourceKey.contentHash != cachedKey.contentHash)
+		{
+			return false;
+		}
+		// 次回はハッシュを計算しなくて済むように、更新時刻を書き直す
+		MeshCache::RewriteKey(cachePath, sourceKey);
+		return cache.Open(cachePath, sourcePath);
+	}
+
+	// ストリーミング読み込みでファイルを読むブロックの大きさ
+	constexpr size_t kStreamBlockSize = 1024 * 1024;
+	// 一時ファイルに書き出す・読み込む単位
+	constexpr size_t kStreamPageSize = 64 * 1024;
+	// 1つの頂点あたりのインデックスの数の見込み（閉じたメッシュでは三角形が頂点のおよそ2倍）
+	constexpr size_t kStreamIndicesPerVertex = 6;
+	// 一時ファイルの名前（呼び出しごとに変える名前の後ろに付ける）
+	constexpr const char* kStreamPositionExtension = ".positions.tmp";
+	constexpr const char* kStreamTexcoordExtension = ".texcoords.tmp";
+	constexpr const char* kStreamNormalExtension = ".normals.tmp";
+
+	// パスはUTF-8として扱う（MappedFileと同じ）
+	std::filesystem::path ToPath(const std::string& path)
+	{
+#ifdef _WIN32
+		return std::filesystem::path(StringUtility::ConvertString(path));
+#else
+		return std::filesystem::path(path);
+#endif
+	}
+
+	// ファイルを一定の大きさのブロックずつ読み、1行ごとにfunc(行頭, 行末)を呼ぶ
+	// ブロックに収まらない長い行があるときだけバッファを広げる
+	template<typename Func>
+	bool ForEachLine(const std::string& path, const Func& func)
+	{
+		std::ifstream stream(ToPath(path), std::ios::binary);
+		if (!stream)
+		{
+			return false;
+		}
+		std::vector<char> buffer(kStreamBlockSize);
+		size_t size = 0; // バッファの先頭に残っている、まだ行の終わりまで読んでいないバイト数
+		while (true)
+		{
+			if (size == buffer.size())
+			{
+				buffer.resize(buffer.size() * 2);
+			}
+			stream.read(buffer.data() + size, static_cast<std::streamsize>(buffer.size() - size));
+			const size_t readSize = static_cast<size_t>(stream.gcount());
+			if (stream.bad())
+			{
+				return false;
+			}
+			size += readSize;
+			// 読み終わったら、改行で終わっていない最後の行も処理する
+			const bool isLast = readSize == 0;
+			const char* p = buffer.data();
+			const char* end = p + size;
+			while (p < end)
+			{
+				const char* lineEnd = FindLineEnd(p, end);
+				if (lineEnd == end && !isLast)
+				{
+					break;
+				}
+				func(p, lineEnd);
+				p = lineEnd < end ? lineEnd + 1 : end;
+			}
+			size = static_cast<size_t>(end - p);
+			std::memmove(buffer.data(), p, size);
+			if (isLast)
+			{
+				return true;
+			}
+		}
+	}
+
+	// 要素を一時ファイルに順に書き出す（ページ1つ分たまったらまとめて書く）
+	template<typename T>
+	struct ElementWriter
+	{
+		std::ofstream stream;
+		std::vector<T> buffer;
+		uint64_t count = 0;
+
+		bool Open(const std::string& path)
+		{
+			stream.open(ToPath(path), std::ios::binary | std::ios::trunc);
+			buffer.reserve(kStreamPageSize / sizeof(T));
+			return stream.is_open();
+		}
+		void Push(const T& element)
+		{
+			buffer.push_back(element);
+			++count;
+			if (buffer.size() == buffer.capacity())
+			{
+				Flush();
+			}
+		}
+		void Flush()
+		{
+			stream.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(T)));
+			buffer.clear();
+		}
+		// 書き終わったら閉じる（書けていなければfalse）
+		bool Close()
+		{
+			Flush();
+			stream.close();
+			return !stream.fail();
+		}
+	};
+
+	// 一時ファイルの要素をページ単位で読む
+	// ページの番号で置き場所が決まるキャッシュ（スキャンデータの面はほとんど近くの頂点を参照するので、たいてい当たる）
+	template<typename T>
+	struct ElementReader
+	{
+		static constexpr size_t kElementsPerPage = kStreamPageSize / sizeof(T);
+
+		std::ifstream stream;
+		uint64_t count = 0;
+		std::vector<T> pages; // pageCount * kElementsPerPage
+		std::vector<uint64_t> pageNumbers; // 置き場所ごとに読んであるページの番号（読んでいなければUINT64_MAX）
+
+		bool Open(const std::string& path, uint64_t elementCount, size_t byteBudget)
+		{
+			count = elementCount;
+			const size_t pageCount = (std::max)(byteBudget / kStreamPageSize, size_t(1));
+			pages.resize(pageCount * kElementsPerPage);
+			pageNumbers.assign(pageCount, UINT64_MAX);
+			stream.open(ToPath(path), std::ios::binary);
+			return stream.is_open();
+		}
+		// 範囲外の番号は既定値
+		T Get(int64_t index, const T& defaultValue)
+		{
+			if (index < 0 || static_cast<uint64_t>(index) >= count)
+			{
+				return defaultValue;
+			}
+			const uint64_t pageNumber = static_cast<uint64_t>(index) / kElementsPerPage;
+			const size_t slot = static_cast<size_t>(pageNumber % pageNumbers.size());
+			T* page = pages.data() + slot * kElementsPerPage;
+			if (pageNumbers[slot] != pageNumber)
+			{
+				const uint64_t first = pageNumber * kElementsPerPage;
+				const uint64_t elementCount = (std::min)(static_cast<uint64_t>(kElementsPerPage), count - first);
+				stream.clear();
+				stream.seekg(static_cast<std::streamoff>(first * sizeof(T)));
+				stream.read(reinterpret_cast<char*>(page), static_cast<std::streamsize>(elementCount * sizeof(T)));
+				assert(static_cast<uint64_t>(stream.gcount()) == elementCount * sizeof(T));
+				pageNumbers[slot] = pageNumber;
+			}
+			return page[static_cast<uint64_t>(index) % kElementsPerPage];
+		}
+	};
+
+	// ストリーミング読み込みの頂点の要素の番号の組（ファイル全体が大きいので64bit）
+	struct StreamVertexKey
+	{
+		int64_t position;
+		int64_t texcoord;
+		int64_t normal;
+
+		bool operator==(const StreamVertexKey& other) const
+		{
+			return position == other.position && texcoord == other.texcoord && normal == other.normal;
+		}
+	};
+
+	inline uint64_t HashStreamVertexKey(const StreamVertexKey& key)
+	{
+		uint64_t hash = static_cast<uint64_t>(key.position) * 0x9E3779B97F4A7C15ull;
+		hash ^= static_cast<uint64_t>(key.texcoord) * 0xC2B2AE3D27D4EB4Full;
+		hash ^= static_cast<uint64_t>(key.normal) * 0x165667B19E3779F9ull;
+		hash ^= hash >> 29;
+		hash *= 0xBF58476D1CE4E5B9ull;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	// バッチの中で頂点をまとめるハッシュテーブルの要素
+	// generationがバッチの番号と違えば空き（バッチごとにテーブルを消さずに済む）
+	struct StreamVertexSlot
+	{
+		StreamVertexKey key;
+		uint32_t vertex;
+		uint32_t generation;
+	};
+
+	// ストリーミング読み込みの面の頂点を1つ読む（相対指定はファイル全体の番号にするので、localMaskは使わない）
+	inline bool ReadStreamFaceIndex(const char*& p, const char* end, const uint64_t (&counts)[3], StreamVertexKey& key)
+	{
+		uint8_t localMask = 0;
+		return ReadFaceVertex(p, end, counts, key.position, key.texcoord, key.normal, localMask);
+	}
+
+	// 一時ファイルの置き場所と、呼び出しごとに変える名前（同じobjを同時に読んでも、別のプロセスが読んでもぶつからない）
+	// 元のファイルの隣は書き込めないことがあるので、OSの一時フォルダに置く
+	std::string MakeStreamTemporaryPath()
+	{
+		static std::atomic<uint64_t> callCount = 0;
+		std::random_device randomDevice;
+		const uint64_t random = (uint64_t(randomDevice()) << 32) | randomDevice();
+		std::error_code errorCode;
+		const std::filesystem::path directory = std::filesystem::temp_directory_path(errorCode);
+		const std::filesystem::path name = std::format("ObjStream.{:016x}.{}", random, callCount.fetch_add(1));
+#ifdef _WIN32
+		return StringUtility::ConvertString((directory / name).wstring());
+#else
+		return (directory / name).string();
+#endif
+	}
+}
+
+// objファイルを読む
+ModelData ObjLoader::LoadObjFile(const std::string& directoryPath, const std::string& filename, uint32_t threadCount)
+{
+	const std::string sourcePath = directoryPath + "/" + filename;
+	const std::string cachePath = sourcePath + kCacheExtension;
+	MeshCache cache;
+	if (OpenCache(sourcePath, cachePath, cache))
+	{
+		return cache.ToModelData(directoryPath);
+	}
+	return CookObjFile(directoryPath, sourcePath, cachePath, threadCount);
+}
+
+// 変換済みのキャッシュをマップして開く
+bool ObjLoader::LoadCookedMesh(const std::string& directoryPath, const std::string& filename, MeshCache& cache, uint32_t threadCount)
+{
+	const std::string sourcePath = directoryPath + "/" + filename;
+	const std::string cachePath = sourcePath + kCacheExtension;
+	if (OpenCache(sourcePath, cachePath, cache))
+	{
+		return true;
+	}
+	CookObjFile(directoryPath, sourcePath, cachePath, threadCount, &cache);
+	return cache.IsOpen();
+}
+
+// objファイルを全体を持たずに読み、バッチごとにsinkに渡す
+bool ObjLoader::StreamObjFile(const std::string& directoryPath, const std::string& filename, const ObjStreamSink& sink, size_t workingSetLimit)
+{
+	assert(workingSetLimit >= kMinStreamWorkingSet);
+	const std::string sourcePath = directoryPath + "/" + filename;
+	const std::string temporaryPath = MakeStreamTemporaryPath();
+	const std::string positionPath = temporaryPath + kStreamPositionExtension;
+	const std::string texcoordPath = temporaryPath + kStreamTexcoordExtension;
+	const std::string normalPath = temporaryPath + kStreamNormalExtension;
+	const auto removeTemporaryFiles = [&]()
+		{
+			std::error_code errorCode;
+			std::filesystem::remove(ToPath(positionPath), errorCode);
+			std::filesystem::remove(ToPath(texcoordPath), errorCode);
+			std::filesystem::remove(ToPath(normalPath), errorCode);
+		};
+
+	// 1.座標・UV・法線だけを読み、一時ファイルに書き出す
+	uint64_t elementCounts[3] = {};
+	std::string materialLibrary;
+	{
+		ElementWriter<Vector4> positions;
+		ElementWriter<Vector2> texcoords;
+		ElementWriter<Vector3> normals;
+		bool isWritten = positions.Open(positionPath) && texcoords.Open(texcoordPath) && normals.Open(normalPath);
+		isWritten = isWritten && ForEachLine(sourcePath, [&](const char* p, const char* end)
+			{
+				const std::string_view identifier = ReadToken(p, end);
+				if (identifier == "v")
+				{
+					positions.Push(ReadPosition(p, end));
+				}
+				else if (identifier == "vt")
+				{
+					texcoords.Push(ReadTexcoord(p, end));
+				}
+				else if (identifier == "vn")
+				{
+					normals.Push(ReadNormal(p, end));
+				}
+				else if (identifier == "mtllib")
+				{
+					// 後に書かれたmtllibを優先する（LoadObjFileと同じ）
+					materialLibrary = std::string(ReadToken(p, end));
+				}
+			});
+		isWritten = positions.Close() && texcoords.Close() && normals.Close() && isWritten;
+		assert(isWritten); // とりあえず開けなかったら止める
+		if (!isWritten)
+		{
+			removeTemporaryFiles();
+			return false;
+		}
+		elementCounts[0] = positions.count;
+		elementCounts[1] = texcoords.count;
+		elementCounts[2] = normals.count;
+	}
+
+	// 2.使えるメモリを、一時ファイルを読むキャッシュとバッチに分ける
+	// バッチは頂点1つあたり、頂点・ハッシュテーブル2要素分・インデックスkStreamIndicesPerVertex個を使う
+	const size_t budget = workingSetLimit - kStreamBlockSize;
+	const size_t readerBudget = budget / 4;
+	const size_t batchBudget = budget - readerBudget;
+	// ハッシュテーブルには半分まで頂点を入れる。倍にしても収まるなら倍にする
+	size_t slotCount = 16;
+	while (slotCount * 2 * sizeof(StreamVertexSlot) + slotCount * (sizeof(VertexData) + kStreamIndicesPerVertex * sizeof(uint32_t)) <= batchBudget)
+	{
+		slotCount *= 2;
+	}
+	const size_t maxVertices = slotCount / 2;
+	const size_t maxIndices = maxVertices * kStreamIndicesPerVertex;
+	const size_t slotMask = slotCount - 1;
+
+	ElementReader<Vector4> positions;
+	ElementReader<Vector2> texcoords;
+	ElementReader<Vector3> normals;
+	const bool isOpen = positions.Open(positionPath, elementCounts[0], readerBudget / 2) &&
+		texcoords.Open(texcoordPath, elementCounts[1], readerBudget / 4) &&
+		normals.Open(normalPath, elementCounts[2], readerBudget / 4);
+	assert(isOpen);
+	if (!isOpen)
+	{
+		removeTemporaryFiles();
+		return false;
+	}
+
+	// 3.面を読みながら頂点をまとめ、いっぱいになるかマテリアルが変わったらsinkに渡す
+	std::vector<VertexData> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<StreamVertexSlot> slots(slotCount, StreamVertexSlot{ {}, 0, 0 });
+	vertices.reserve(maxVertices);
+	indices.reserve(maxIndices);
+	uint32_t generation = 1;
+	std::string materialName;
+	const auto flush = [&]()
+		{
+			if (!indices.empty())
+			{
+				sink({ vertices.data(), vertices.size(), indices.data(), indices.size(), materialName, materialLibrary });
+			}
+			vertices.clear();
+			indices.clear();
+			// 番号が一周したら、古いバッチの要素が使用中に見えないように消しておく
+			if (++generation == 0)
+			{
+				std::fill(slots.begin(), slots.end(), StreamVertexSlot{ {}, 0, 0 });
+				generation = 1;
+			}
+		};
+	// 同じ組の頂点がこのバッチにあればその番号、なければ作って追加する
+	const auto findVertex = [&](const StreamVertexKey& key)
+		{
+			size_t slot = static_cast<size_t>(HashStreamVertexKey(key)) & slotMask;
+			while (slots[slot].generation == generation && !(slots[slot].key == key))
+			{
+				slot = (slot + 1) & slotMask;
+			}
+			if (slots[slot].generation != generation)
+			{
+				assert(key.position >= 0 && static_cast<uint64_t>(key.position) < elementCounts[0]);
+				VertexData vertex;
+				vertex.position = positions.Get(key.position, Vector4{ 0.0f, 0.0f, 0.0f, 1.0f });
+				vertex.texcoord = texcoords.Get(key.texcoord, Vector2{ 0.0f, 0.0f });
+				vertex.normal = normals.Get(key.normal, Vector3{ 0.0f, 0.0f, 0.0f });
+				slots[slot] = { key, static_cast<uint32_t>(vertices.size()), generation };
+				vertices.push_back(vertex);
+			}
+			return slots[slot].vertex;
+		};
+
+	uint64_t counts[3] = {};
+	const bool isRead = ForEachLine(sourcePath, [&](const char* p, const char* end)
+		{
+			const std::string_view identifier = ReadToken(p, end);
+			if (identifier == "v")
+			{
+				++counts[0];
+			}
+			else if (identifier == "vt")
+			{
+				++counts[1];
+			}
+			else if (identifier == "vn")
+			{
+				++counts[2];
+			}
+			else if (identifier == "f")
+			{
+				// 四角形以上の面は最初の頂点を中心に扇状に三角形に分ける
+				StreamVertexKey first;
+				StreamVertexKey previous;
+				StreamVertexKey current;
+				if (!ReadStreamFaceIndex(p, end, counts, first) || !ReadStreamFaceIndex(p, end, counts, previous))
+				{
+					return;
+				}
+				while (ReadStreamFaceIndex(p, end, counts, current))
+				{
+					if (vertices.size() + 3 > maxVertices || indices.size() + 3 > maxIndices)
+					{
+						flush();
+					}
+					// 頂点を逆順で登録することで、周り順を逆にする
+					indices.push_back(findVertex(current));
+					indices.push_back(findVertex(previous));
+					indices.push_back(findVertex(first));
+					previous = current;
+				}
+			}
+			else if (identifier == "usemtl")
+			{
+				// バッチの中はすべて同じマテリアルにする
+				flush();
+				materialName = std::string(ReadToken(p, end));
+			}
+		});
+	flush();
+
+	positions.stream.close();
+	texcoords.stream.close();
+	normals.stream.close();
+	removeTemporaryFiles();
+	assert(isRead);
+	return isRead;
+}
+
+// mtlファイルを読む
+std::vector<MaterialData> ObjLoader::LoadMaterialTemplateFile(const std::string& directoryPath, const std::string& filename)
+{
+	std::vector<MaterialData> materials;
+	MappedFile file;
+	const bool isOpen = file.Open(directoryPath + "/" + filename);
+	assert(isOpen); // とりあえず開けなかったら止める
+	if (!isOpen)
+	{
+		return materials;
+	}
+
+	// newmtlより前に書かれていたら名前なしのマテリアルにする
+	const auto currentMaterial = [&]() -> MaterialData&
+		{
+			if (materials.empty())
+			{
+				materials.emplace_back();
+			}
+			return materials.back();
+		};
+
+	const char* p = file.GetData();
+	const char* end = p + file.GetSize();
+	while (p < end)
+	{
+		const char* lineEnd = FindLineEnd(p, end);
+		const char* cursor = p;
+		const std::string_view identifier = ReadToken(cursor, lineEnd);
+		if (identifier == "newmtl")
+		{
+			materials.emplace_back();
+			materials.back().name = std::string(ReadToken(cursor, lineEnd));
+		}
+		else if (identifier == "Ka")
+		{
+			currentMaterial().ambient = ReadColor(cursor, lineEnd);
+		}
+		else if (identifier == "Kd")
+		{
+			currentMaterial().diffuse = ReadColor(cursor, lineEnd);
+		}
+		else if (identifier == "Ks")
+		{
+			currentMaterial().specular = ReadColor(cursor, lineEnd);
+		}
+		else if (identifier == "Ns")
+		{
+			currentMaterial().shininess = ReadFloat(cursor, lineEnd);
+		}
+		else if (identifier == "d")
+		{
+			currentMaterial().alpha = ReadFloat(cursor, lineEnd);
+		}
+		else if (identifier == "Tr")
+		{
+			// 透明度なので不透明度に直す
+			currentMaterial().alpha = 1.0f - ReadFloat(cursor, lineEnd);
+		}
+		else if (identifier == "illum")
+		{
+			currentMaterial().illumination = static_cast<uint32_t>((std::max)(ReadFloat(cursor, lineEnd), 0.0f));
+		}
+		else
+		{
+			for (const TextureKeyword& keyword : kTextureKeywords)
+			{
+				if (identifier == keyword.identifier)
+				{
+					// 連結してファイルパスにする
+					const std::string_view textureFilename = ReadTextureFilename(cursor, lineEnd);
+					currentMaterial().*keyword.filePath = textureFilename.empty() ? std::string() : directoryPath + "/" + std::string(textureFilename);
+					break;
+				}
+			}
+		}
+		p = lineEnd + 1;
+	}
+
+	return materials;
+}
+
+// マテリアル名で探す
+MaterialData ObjLoader::FindMaterial(const std::vector<MaterialData>& materials, std::string_view name)
+{
+	if (name.empty())
+	{
+		return materials.empty() ? MaterialData{} : materials.front();
+	}
+	for (const MaterialData& material : materials)
+	{
+		if (material.name == name)
+		{
+			return material;
+		}
+	}
+	MaterialData material;
+	material.name = std::string(name);
+	return material;
+}
+
+// インデックスを1つあたりGetIndexSizeバイトの形式で書き込む
+void ObjLoader::WriteIndices(const ModelData& modelData, void* destination)
+{
+	if (GetIndexSize(modelData) == sizeof(uint16_t))
+	{
+		uint16_t* indices = static_cast<uint16_t*>(destination);
+		for (size_t i = 0; i < modelData.indices.size(); ++i)
+		{
+			indices[i] = static_cast<uint16_t>(modelData.indices[i]);
+		}
+	}
+	else
+	{
+		std::memcpy(destination, modelData.indices.data(), sizeof(uint32_t) * modelData.indices.size());
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "VertexData.h"
+#include "Culling.h"
+#include "MeshletUtility.h"
+
+class MeshCache;
+
+// マテリアルデータ（mtlファイルの1つのnewmtl）
+struct MaterialData
+{
+	std::string name; // newmtlで付けた名前
+	Vector3 ambient = { 0.0f, 0.0f, 0.0f }; // Ka
+	Vector3 diffuse = { 1.0f, 1.0f, 1.0f }; // Kd
+	Vector3 specular = { 0.0f, 0.0f, 0.0f }; // Ks
+	float shininess = 0.0f; // Ns
+	float alpha = 1.0f; // d（Trなら1 - Tr）
+	uint32_t illumination = 0; // illum
+	// テクスチャのパス（directoryPathを付けたもの。なければ空）
+	std::string textureFilePath; // map_Kd
+	std::string ambientTextureFilePath; // map_Ka
+	std::string specularTextureFilePath; // map_Ks
+	std::string shininessTextureFilePath; // map_Ns
+	std::string alphaTextureFilePath; // map_d
+	std::string bumpTextureFilePath; // map_Bump、bump、norm
+
+	bool operator==(const MaterialData& other) const = default;
+};
+
+// サブメッシュ（同じマテリアルで描画するインデックスの範囲）
+struct Submesh
+{
+	uint32_t indexOffset;
+	uint32_t indexCount;
+	uint32_t materialIndex; // ModelData::materialsの番号
+	uint32_t meshletOffset; // ModelData::meshletData.meshletsの中の位置
+	uint32_t meshletCount;
+};
+
+// LOD（詳細度ごとのサブメッシュの範囲）
+struct MeshLod
+{
+	uint32_t submeshOffset; // ModelData::submeshesの中の位置
+	uint32_t submeshCount;
+	float error; // 元の形からの誤差（ローカル空間の距離）
+};
+
+// モデルデータ
+struct ModelData
+{
+	std::vector<VertexData> vertices; // 重複のない頂点
+	std::vector<uint32_t> indices; // 三角形ごとに3つずつ（マテリアルごとにまとめて並べる）
+	std::vector<Submesh> submeshes; // マテリアルごとに1つ（1回の描画で済む）。LODがあればLODの順に続けて並べる
+	std::vector<MeshLod> lods; // 0が元の形。空ならsubmeshesがすべてLOD0
+	std::vector<MaterialData> materials;
+	MeshletData meshletData; // サブメッシュごとのメッシュレット（カリング用）
+	AABB bounds; // ローカル空間の境界ボックス
+};
+
+// ストリーミング読み込みで1回に渡す頂点とインデックス（渡している間だけ有効）
+// 頂点の重複はバッチの中でだけまとめるので、バッチの境目の頂点は両方のバッチに入る
+struct ObjStreamBatch
+{
+	const VertexData* vertices;
+	size_t vertexCount;
+	const uint32_t* indices; // verticesの中の番号（三角形ごとに3つ）
+	size_t indexCount;
+	std::string_view materialName; // usemtlで指定された名前（なければ空）。バッチの中の三角形はすべて同じマテリアル
+	std::string_view materialLibrary; // mtllibで指定されたファイル名（なければ空）
+};
+// ストリーミング読み込みの受け取り側
+using ObjStreamSink = std::function<void(const ObjStreamBatch& batch)>;
+
+// objファイルの読み込み
+// ファイルをメモリにマップし、行ごとの文字列を作らずにその場で数値を読み取る
+namespace ObjLoader
+{
+	// 変換済みのキャッシュのファイル名（objのファイル名の後ろに付ける）
+	constexpr const char* kCacheExtension = ".meshcache";
+
+	// objファイルを読む（directoryPath/filename）
+	// 大きいファイルは行の区切りで分けてthreadCount個のスレッドで読む（0ならコア数）
+	// 初回にバイナリのキャッシュを書き出し、次回からはobjを解釈せずにキャッシュから読む
+	ModelData LoadObjFile(const std::string& directoryPath, const std::string& filename, uint32_t threadCount = 0);
+	// 変換済みのキャッシュをマップして開く（GPUへのアップロードはマップしたままコピーすればよい）
+	// キャッシュがないか、objのサイズ・更新時刻・中身が変わっていればobjを読んで作り直す
+	// 作り直したときはキャッシュと同じ中身をメモリに持って開くので、キャッシュを書き出せない場所でも使える
+	bool LoadCookedMesh(const std::string& directoryPath, const std::string& filename, MeshCache& cache, uint32_t threadCount = 0);
+
+	// ストリーミング読み込みで使うメモリの既定値と下限
+	constexpr size_t kDefaultStreamWorkingSet = 256ull * 1024 * 1024;
+	constexpr size_t kMinStreamWorkingSet = 4ull * 1024 * 1024;
+	// objファイルを全体を持たずに読み、頂点とインデックスをバッチごとにsinkに渡す（directoryPath/filename）
+	// 1回目に座標・UV・法線だけを一時ファイルに書き出し、2回目に面を読みながら一時ファイルからページ単位で取り出す
+	// 一時ファイルはOSの一時フォルダに呼び出しごとに別の名前で作り、終わったら消す
+	// ファイルの大きさによらず、使うメモリはおよそworkingSetLimitまで（数十GBのスキャンデータの変換用）
+	// 座標と周り順の変換はLoadObjFileと同じ。キャッシュは作らない。開けなければfalse
+	bool StreamObjFile(const std::string& directoryPath, const std::string& filename, const ObjStreamSink& sink, size_t workingSetLimit = kDefaultStreamWorkingSet);
+	// mtlファイルを読む（directoryPath/filename）。書かれている順にすべてのマテリアルを返す
+	// 色（Ka、Kd、Ks）、Ns、d、Tr、illumと各map_*を読む。テクスチャの-sなどのオプションは読み飛ばす
+	// 何度も使うものはMaterialLibraryを通して読めば、同じファイルを1回しか読まない
+	std::vector<MaterialData> LoadMaterialTemplateFile(const std::string& directoryPath, const std::string& filename);
+	// マテリアル名で探す（名前が空ならusemtlがない面なので最初のもの。見つからなければテクスチャなし）
+	MaterialData FindMaterial(const std::vector<MaterialData>& materials, std::string_view name);
+
+	// GPUに送るときのインデックス1つのバイト数（頂点が65536個未満なら16bit）
+	inline uint32_t GetIndexSize(const ModelData& modelData)
+	{
+		return static_cast<uint32_t>(modelData.vertices.size() < 65536 ? sizeof(uint16_t) : sizeof(uint32_t));
+	}
+	// インデックスを1つあたりGetIndexSizeバイトの形式で書き込む
+	void WriteIndices(const ModelData& modelData, void* destination);
+}
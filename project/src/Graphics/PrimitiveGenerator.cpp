@@ -0,0 +1,318 @@
+#include "PrimitiveGenerator.h"
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+
+#include "FastTrig.h"
+#include "HashUtility.h"
+
+namespace
+{
+	constexpr float kPi = 3.14159265358979323846f;
+
+	// 円周をcount等分した角度のsin/cos（count + 1個。最後は継ぎ目で最初と完全に同じ値にする）
+	void ComputeCircleTable(uint32_t count, std::vector<float>& sines, std::vector<float>& cosines)
+	{
+		std::vector<float> angles(count + 1);
+		for (uint32_t i = 0; i <= count; ++i)
+		{
+			angles[i] = 2.0f * kPi * static_cast<float>(i) / static_cast<float>(count);
+		}
+		sines.resize(count + 1);
+		cosines.resize(count + 1);
+		FastTrig::SinCosBatch(angles.data(), sines.data(), cosines.data(), angles.size(), TrigPrecision::Precise);
+		sines[count] = sines[0];
+		cosines[count] = cosines[0];
+	}
+
+	// 格子状に並べた頂点（(rows + 1)行 × (columns + 1)列、行ごとに連続）に三角形を張る
+	// 列の向き × 行の向きが外を向くならisFlippedはfalse
+	// 同じ位置の頂点を2つ含む三角形（球の極など）は作らない
+	void AppendGridIndices(PrimitiveMesh& mesh, uint32_t baseVertex, uint32_t columns, uint32_t rows, bool isFlipped)
+	{
+		const auto isSamePosition = [&mesh](uint32_t a, uint32_t b)
+			{
+				const Vector4& p = mesh.vertices[a].position;
+				const Vector4& q = mesh.vertices[b].position;
+				return p.x == q.x && p.y == q.y && p.z == q.z;
+			};
+		const auto appendTriangle = [&](uint32_t a, uint32_t b, uint32_t c)
+			{
+				if (isSamePosition(a, b) || isSamePosition(b, c) || isSamePosition(c, a))
+				{
+					return;
+				}
+				mesh.indices.push_back(a);
+				mesh.indices.push_back(isFlipped ? c : b);
+				mesh.indices.push_back(isFlipped ? b : c);
+			};
+
+		for (uint32_t row = 0; row < rows; ++row)
+		{
+			for (uint32_t column = 0; column < columns; ++column)
+			{
+				const uint32_t v00 = baseVertex + row * (columns + 1) + column;
+				const uint32_t v01 = v00 + 1;
+				const uint32_t v10 = v00 + columns + 1;
+				const uint32_t v11 = v10 + 1;
+				appendTriangle(v00, v01, v10);
+				appendTriangle(v01, v11, v10);
+			}
+		}
+	}
+
+	// origin + uAxis * [0, 1] + vAxis * [0, 1] の平面を分割して足す
+	void AppendGrid(PrimitiveMesh& mesh, const Vector3& origin, const Vector3& uAxis, const Vector3& vAxis, const Vector3& normal, uint32_t columns, uint32_t rows)
+	{
+		const uint32_t baseVertex = static_cast<uint32_t>(mesh.vertices.size());
+		for (uint32_t row = 0; row <= rows; ++row)
+		{
+			const float v = static_cast<float>(row) / static_cast<float>(rows);
+			for (uint32_t column = 0; column <= columns; ++column)
+			{
+				const float u = static_cast<float>(column) / static_cast<float>(columns);
+				VertexData vertex;
+				vertex.position = { origin.x + uAxis.x * u + vAxis.x * v, origin.y + uAxis.y * u + vAxis.y * v, origin.z + uAxis.z * u + vAxis.z * v, 1.0f };
+				vertex.texcoord = { u, v };
+				vertex.normal = normal;
+				mesh.vertices.push_back(vertex);
+			}
+		}
+		const Vector3 facing = {
+			uAxis.y * vAxis.z - uAxis.z * vAxis.y,
+			uAxis.z * vAxis.x - uAxis.x * vAxis.z,
+			uAxis.x * vAxis.y - uAxis.y * vAxis.x };
+		AppendGridIndices(mesh, baseVertex, columns, rows, facing.x * normal.x + facing.y * normal.y + facing.z * normal.z < 0.0f);
+	}
+
+	// キャッシュのキーのハッシュ
+	struct PrimitiveDescHash
+	{
+		size_t operator()(const PrimitiveDesc& desc) const
+		{
+			return static_cast<size_t>(HashUtility::ComputeHash64(&desc, sizeof(desc)));
+		}
+	};
+	static_assert(sizeof(PrimitiveDesc) == 16); // 詰め物がなく、バイト列のハッシュで比べられる
+
+	// 作ったメッシュ（要素のアドレスは追加しても変わらない）
+	std::unordered_map<PrimitiveDesc, PrimitiveMesh, PrimitiveDescHash> primitiveCache;
+}
+
+// 緯度経度で分割した球
+PrimitiveMesh PrimitiveGenerator::CreateSphere(uint32_t segments, uint32_t rings)
+{
+	assert(segments >= 3 && rings >= 2);
+
+	// 経度ごとのsin/cosと、北極から南極までの緯度ごとのsin/cos
+	std::vector<float> lonSin;
+	std::vector<float> lonCos;
+	ComputeCircleTable(segments, lonSin, lonCos);
+	std::vector<float> lats(rings + 1);
+	std::vector<float> latSin(rings + 1);
+	std::vector<float> latCos(rings + 1);
+	for (uint32_t i = 0; i <= rings; ++i)
+	{
+		lats[i] = kPi / 2.0f - kPi * static_cast<float>(i) / static_cast<float>(rings);
+	}
+	FastTrig::SinCosBatch(lats.data(), latSin.data(), latCos.data(), lats.size(), TrigPrecision::Precise);
+	// 極は1点に集まるようにする
+	latSin[0] = 1.0f;
+	latCos[0] = 0.0f;
+	latSin[rings] = -1.0f;
+	latCos[rings] = 0.0f;
+
+	// テクスチャの継ぎ目と極は、UVが違うので頂点を分ける
+	PrimitiveMesh mesh;
+	mesh.vertices.reserve(size_t(segments + 1) * (rings + 1));
+	mesh.indices.reserve(size_t(segments) * (rings - 1) * 6);
+	for (uint32_t lat = 0; lat <= rings; ++lat)
+	{
+		for (uint32_t lon = 0; lon <= segments; ++lon)
+		{
+			VertexData vertex;
+			vertex.position = { latCos[lat] * lonCos[lon], latSin[lat], latCos[lat] * lonSin[lon], 1.0f };
+			vertex.texcoord = { 1.0f - static_cast<float>(lon) / static_cast<float>(segments), static_cast<float>(lat) / static_cast<float>(rings) };
+			vertex.normal = { vertex.position.x, vertex.position.y, vertex.position.z };
+			mesh.vertices.push_back(vertex);
+		}
+	}
+	AppendGridIndices(mesh, 0, segments, rings, false);
+	return mesh;
+}
+
+// 各面を分割した立方体
+PrimitiveMesh PrimitiveGenerator::CreateBox(uint32_t segments)
+{
+	assert(segments >= 1);
+
+	// 面の法線と、外から見たときのUVの向き（uが右、vが下。cross(u, v)が法線になる）
+	struct Face
+	{
+		Vector3 normal;
+		Vector3 u;
+		Vector3 v;
+	};
+	const Face faces[] = {
+		{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f } },
+		{ { -1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f } },
+		{ { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+		{ { 0.0f, 0.0f, 1.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f } },
+		{ { 0.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f } },
+	};
+
+	PrimitiveMesh mesh;
+	mesh.vertices.reserve(size_t(segments + 1) * (segments + 1) * 6);
+	mesh.indices.reserve(size_t(segments) * segments * 36);
+	for (const Face& face : faces)
+	{
+		const Vector3 origin = {
+			face.normal.x - face.u.x - face.v.x,
+			face.normal.y - face.u.y - face.v.y,
+			face.normal.z - face.u.z - face.v.z };
+		AppendGrid(mesh, origin, { face.u.x * 2.0f, face.u.y * 2.0f, face.u.z * 2.0f }, { face.v.x * 2.0f, face.v.y * 2.0f, face.v.z * 2.0f }, face.normal, segments, segments);
+	}
+	return mesh;
+}
+
+// XZ平面の正方形
+PrimitiveMesh PrimitiveGenerator::CreatePlane(uint32_t segmentsX, uint32_t segmentsZ)
+{
+	assert(segmentsX >= 1 && segmentsZ >= 1);
+
+	PrimitiveMesh mesh;
+	mesh.vertices.reserve(size_t(segmentsX + 1) * (segmentsZ + 1));
+	mesh.indices.reserve(size_t(segmentsX) * segmentsZ * 6);
+	AppendGrid(mesh, { -1.0f, 0.0f, 1.0f }, { 2.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -2.0f }, { 0.0f, 1.0f, 0.0f }, segmentsX, segmentsZ);
+	return mesh;
+}
+
+// ふた付きの円柱
+PrimitiveMesh PrimitiveGenerator::CreateCylinder(uint32_t segments, uint32_t rings)
+{
+	assert(segments >= 3 && rings >= 1);
+
+	std::vector<float> sines;
+	std::vector<float> cosines;
+	ComputeCircleTable(segments, sines, cosines);
+
+	PrimitiveMesh mesh;
+	mesh.vertices.reserve(size_t(segments + 1) * (rings + 1) + size_t(segments + 2) * 2);
+	mesh.indices.reserve(size_t(segments) * rings * 6 + size_t(segments) * 6);
+
+	// 側面（上から下へ）
+	for (uint32_t ring = 0; ring <= rings; ++ring)
+	{
+		const float v = static_cast<float>(ring) / static_cast<float>(rings);
+		for (uint32_t segment = 0; segment <= segments; ++segment)
+		{
+			VertexData vertex;
+			vertex.position = { cosines[segment], 1.0f - 2.0f * v, sines[segment], 1.0f };
+			vertex.texcoord = { static_cast<float>(segment) / static_cast<float>(segments), v };
+			vertex.normal = { cosines[segment], 0.0f, sines[segment] };
+			mesh.vertices.push_back(vertex);
+		}
+	}
+	AppendGridIndices(mesh, 0, segments, rings, false);
+
+	// 上下のふた（中心の頂点から扇状に張る。法線が側面と違うので頂点は分ける）
+	for (float y : { 1.0f, -1.0f })
+	{
+		const uint32_t center = static_cast<uint32_t>(mesh.vertices.size());
+		mesh.vertices.push_back({ { 0.0f, y, 0.0f, 1.0f }, { 0.5f, 0.5f }, { 0.0f, y, 0.0f } });
+		for (uint32_t segment = 0; segment <= segments; ++segment)
+		{
+			VertexData vertex;
+			vertex.position = { cosines[segment], y, sines[segment], 1.0f };
+			vertex.texcoord = { 0.5f + cosines[segment] * 0.5f, 0.5f - sines[segment] * 0.5f * y };
+			vertex.normal = { 0.0f, y, 0.0f };
+			mesh.vertices.push_back(vertex);
+		}
+		for (uint32_t segment = 0; segment < segments; ++segment)
+		{
+			// 上のふたは角度の大きい方から、下のふたは小さい方から回すと外を向く
+			const uint32_t first = center + 1 + segment;
+			mesh.indices.push_back(center);
+			mesh.indices.push_back(y > 0.0f ? first + 1 : first);
+			mesh.indices.push_back(y > 0.0f ? first : first + 1);
+		}
+	}
+	return mesh;
+}
+
+// トーラス
+PrimitiveMesh PrimitiveGenerator::CreateTorus(uint32_t segments, uint32_t rings, float minorRadius)
+{
+	assert(segments >= 3 && rings >= 3 && minorRadius > 0.0f);
+
+	// 中心の円と管の断面の円のsin/cos
+	std::vector<float> majorSin;
+	std::vector<float> majorCos;
+	std::vector<float> minorSin;
+	std::vector<float> minorCos;
+	ComputeCircleTable(segments, majorSin, majorCos);
+	ComputeCircleTable(rings, minorSin, minorCos);
+
+	PrimitiveMesh mesh;
+	mesh.vertices.reserve(size_t(segments + 1) * (rings + 1));
+	mesh.indices.reserve(size_t(segments) * rings * 6);
+	for (uint32_t ring = 0; ring <= rings; ++ring)
+	{
+		const float distance = 1.0f + minorRadius * minorCos[ring];
+		for (uint32_t segment = 0; segment <= segments; ++segment)
+		{
+			VertexData vertex;
+			vertex.position = { distance * majorCos[segment], minorRadius * minorSin[ring], distance * majorSin[segment], 1.0f };
+			vertex.texcoord = { static_cast<float>(segment) / static_cast<float>(segments), static_cast<float>(ring) / static_cast<float>(rings) };
+			vertex.normal = { minorCos[ring] * majorCos[segment], minorSin[ring], minorCos[ring] * majorSin[segment] };
+			mesh.vertices.push_back(vertex);
+		}
+	}
+	// 断面の角度が増える向きは外から見て上向きなので、球や円柱とは逆回りになる
+	AppendGridIndices(mesh, 0, segments, rings, true);
+	return mesh;
+}
+
+// descの形のメッシュを作る
+PrimitiveMesh PrimitiveGenerator::Create(const PrimitiveDesc& desc)
+{
+	switch (desc.shape)
+	{
+	case PrimitiveShape::Sphere: return CreateSphere(desc.segments, desc.rings);
+	case PrimitiveShape::Box: return CreateBox(desc.segments);
+	case PrimitiveShape::Plane: return CreatePlane(desc.segments, desc.rings);
+	case PrimitiveShape::Cylinder: return CreateCylinder(desc.segments, desc.rings);
+	case PrimitiveShape::Torus: return CreateTorus(desc.segments, desc.rings, desc.minorRadius);
+	}
+	assert(false);
+	return {};
+}
+
+// 作ったものがあれば使い回す
+const PrimitiveMesh& PrimitiveGenerator::Get(const PrimitiveDesc& desc)
+{
+	// 形に関係ないパラメーターは揃えて、同じメッシュが別々に作られないようにする
+	PrimitiveDesc key = desc;
+	if (key.shape == PrimitiveShape::Box)
+	{
+		key.rings = 0;
+	}
+	if (key.shape != PrimitiveShape::Torus)
+	{
+		key.minorRadius = 0.0f;
+	}
+
+	auto it = primitiveCache.find(key);
+	if (it == primitiveCache.end())
+	{
+		it = primitiveCache.emplace(key, Create(key)).first;
+	}
+	return it->second;
+}
+
+// 覚えておいたメッシュを捨てる
+void PrimitiveGenerator::ClearCache()
+{
+	primitiveCache.clear();
+}
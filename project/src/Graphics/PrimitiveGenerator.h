@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "VertexData.h"
+
+// プリミティブの形
+enum class PrimitiveShape : uint32_t
+{
+	Sphere, // 半径1の球（緯度経度で分割。segmentsが経度、ringsが緯度の分割数）
+	Box, // -1～1の立方体（各面をsegments×segmentsに分割）
+	Plane, // XZ平面の-1～1の正方形（上向き。segments×ringsに分割）
+	Cylinder, // 半径1、yが-1～1の円柱（segmentsが円周、ringsが高さの分割数。上下のふた付き）
+	Torus, // 中心の円の半径1、管の半径minorRadiusのトーラス（segmentsが中心の円、ringsが管の分割数）
+};
+
+// プリミティブの作り方（キャッシュのキーにもする）
+struct PrimitiveDesc
+{
+	PrimitiveShape shape;
+	uint32_t segments;
+	uint32_t rings;
+	float minorRadius; // Torusだけで使う
+
+	bool operator==(const PrimitiveDesc& other) const = default;
+};
+
+// 頂点を共有したインデックス付きのメッシュ
+// 三角形はObjLoaderで読んだモデルと同じく、cross(p1 - p0, p2 - p0)が外を向く順番
+struct PrimitiveMesh
+{
+	std::vector<VertexData> vertices;
+	std::vector<uint32_t> indices;
+};
+
+// 球・箱・平面・円柱・トーラスのメッシュを作る
+// 円周の分割ごとのsin/cosは先に表にしてから頂点を作るので、頂点ごとに三角関数を呼ばない
+// 大きさと位置はワールド行列で変える
+namespace PrimitiveGenerator
+{
+	PrimitiveMesh CreateSphere(uint32_t segments, uint32_t rings);
+	PrimitiveMesh CreateBox(uint32_t segments);
+	PrimitiveMesh CreatePlane(uint32_t segmentsX, uint32_t segmentsZ);
+	PrimitiveMesh CreateCylinder(uint32_t segments, uint32_t rings);
+	PrimitiveMesh CreateTorus(uint32_t segments, uint32_t rings, float minorRadius);
+	// descの形のメッシュを作る
+	PrimitiveMesh Create(const PrimitiveDesc& desc);
+
+	// 同じパラメーターで作ったものがあればそれを返し、なければ作って覚えておく
+	// 戻り値はClearCacheを呼ぶまで有効
+	const PrimitiveMesh& Get(const PrimitiveDesc& desc);
+	// 覚えておいたメッシュを捨てる
+	void ClearCache();
+}
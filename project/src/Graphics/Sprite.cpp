@@ -2,11 +2,21 @@
 #include "SpriteCommon.h"
 #include "TextureManager.h"
 #include "Matrix4x4.h"
+#include "Culling.h"
 #define _USE_MATH_DEFINES
 #include <cmath> 
 #include <math.h>
+#include <algorithm>
 
-
+namespace
+{
+	// スプライト用のビュー行列と正射影行列はコンパイル時に計算しておく
+	constexpr Matrix4x4 kViewMatrix = MatrixMath::MakeIdentity4x4();
+	constexpr Matrix4x4 kProjectionMatrix = MatrixMath::Orthographic(0.0f, 0.0f, float(WinApp::kClientWidth), float(WinApp::kClientHeight), 0.0f, 100.0f);
+	constexpr Matrix4x4 kViewProjectionMatrix = kViewMatrix * kProjectionMatrix;
+	// 画面の視錐台（全スプライト共通）
+	const Frustum kFrustum = Culling::ExtractFrustum(kViewProjectionMatrix);
+}
 
 void Sprite::Initialize(SpriteCommon* spriteCommon, WinApp* winApp, DirectXCommon* dxCommon, std::string textureFilePath)
 {
@@ -75,18 +85,27 @@ void Sprite::Initialize(SpriteCommon* spriteCommon, WinApp* winApp, DirectXCommo
 	transformationMatrixResource->Map(0, nullptr, reinterpret_cast<void**>(&transformationMatrixData));
 
 	// *テクスチャ* //
-	//TextureManager::GetInstance()->LoadTexture(textureFilePath);
-	//textureIndex = TextureManager::GetInstance()->GetTextureIndexByFilePath(textureFilePath);
+	textureHandle = TextureManager::GetInstance()->LoadTexture(textureFilePath);
 
 	
-	// テクスチャサイズ調整
-	AdjustTextureSize();
+	// テクスチャサイズ調整（読み込みは非同期なので、まだなら転送が済んだ最初のUpdateで行う）
+	isTextureSizeAdjusted_ = false;
+	if (TextureManager::GetInstance()->IsReady(textureHandle))
+	{
+		AdjustTextureSize();
+	}
 
 }
 
 // 更新
 void Sprite::Update()
 {
+	// 読み込みが済んだらテクスチャサイズに合わせる
+	if (!isTextureSizeAdjusted_ && TextureManager::GetInstance()->IsReady(textureHandle))
+	{
+		AdjustTextureSize();
+	}
+
 	// 座標
 	transform.translate = { position.x,position.y,0.0f };
 	// 回転
@@ -114,7 +133,7 @@ void Sprite::Update()
 	}
 
 	// テクスチャ範囲指定
-	const DirectX::TexMetadata& metadata = TextureManager::GetInstance()->GetMetaData(textureIndex);
+	const DirectX::TexMetadata& metadata = TextureManager::GetInstance()->GetMetaData(textureHandle);
 	float tex_left = textureLeftTop.x / metadata.width;
 	float tex_right = (textureLeftTop.x + textureSize.x) / metadata.width;
 	float tex_top = textureLeftTop.y / metadata.height;
@@ -133,16 +152,28 @@ void Sprite::Update()
 
 
 	Matrix4x4 worldMatrix = MatrixMath::MakeAffine(transform.scale, transform.rotate, transform.translate);
-	Matrix4x4 viewMatrix = MatrixMath::MakeIdentity4x4();
-	Matrix4x4 projectionMatrix = MatrixMath::Orthographic(0.0f, 0.0f, float(winApp_->kClientWidth), float(winApp_->kClientHeight), 0.0f, 100.0f);
 	// WVPmatrixを作る
-	Matrix4x4 worldViewProjectionMatrix = MatrixMath::Multipty(worldMatrix, MatrixMath::Multipty(viewMatrix, projectionMatrix));
+	Matrix4x4 worldViewProjectionMatrix = MatrixMath::Multipty(worldMatrix, kViewProjectionMatrix);
 	transformationMatrixData->WVP = worldViewProjectionMatrix;   // WVP行列を設定
 	transformationMatrixData->World = worldMatrix; // World行列を設定
+
+	// 画面外に出たスプライトは描画しない
+	const AABB localBounds =
+	{
+		{ (std::min)(left, right), (std::min)(top, bottom), 0.0f },
+		{ (std::max)(left, right), (std::max)(top, bottom), 0.0f }
+	};
+	isVisible_ = Culling::IsVisible(kFrustum, Culling::TransformAABB(localBounds, worldMatrix));
 }
 
 void Sprite::Draw()
 {
+	// 画面外なら描画しない
+	if (!isVisible_)
+	{
+		return;
+	}
+
 	// *設定* //
 
 	// 頂点データ
@@ -158,7 +189,15 @@ void Sprite::Draw()
 	dxCommon_->GetCommandList()->SetGraphicsRootConstantBufferView(1, transformationMatrixResource->GetGPUVirtualAddress());
 
 	// SRVのDescriptorTableの先頭を設定
-	dxCommon_->GetCommandList()->SetGraphicsRootDescriptorTable(2, TextureManager::GetInstance()->GetSrvHandleGPU(textureIndex));
+	dxCommon_->GetCommandList()->SetGraphicsRootDescriptorTable(2, TextureManager::GetInstance()->GetSrvHandleGPU(textureHandle));
+	// 画面上でテクスチャ全体が覆う大きさを報告する（切り出し範囲を拡大して描いているなら、その分細かいミップが要る）
+	if (TextureManager::GetInstance()->IsReady(textureHandle) && textureSize.x > 0.0f && textureSize.y > 0.0f)
+	{
+		const DirectX::TexMetadata& metadata = TextureManager::GetInstance()->GetMetaData(textureHandle);
+		const float screenWidth = std::abs(size.x) * static_cast<float>(metadata.width) / textureSize.x;
+		const float screenHeight = std::abs(size.y) * static_cast<float>(metadata.height) / textureSize.y;
+		TextureManager::GetInstance()->ReportTextureUsage(textureHandle, (std::max)(screenWidth, screenHeight));
+	}
 	// インデックスを使って描画
 	dxCommon_->GetCommandList()->DrawIndexedInstanced(6, 1, 0, 0, 0);
 
@@ -167,22 +206,20 @@ void Sprite::Draw()
 // テクスチャ変更
 void Sprite::ChangeTexture(const std::string& textureFilePath)
 {
-	TextureManager::GetInstance()->LoadTexture(textureFilePath);
-
-	// indexを差し替える
-	textureIndex =
-		TextureManager::GetInstance()->GetTextureIndexByFilePath(textureFilePath);
+	// 読み込み済みなら探すだけ（ハッシュで引くので毎フレーム呼んでもよい）
+	textureHandle = TextureManager::GetInstance()->LoadTexture(textureFilePath);
 }
 
 // テクスチャサイズ調整
 void Sprite::AdjustTextureSize()
 {
 	// テクスチャメタデータ取得
-	const DirectX::TexMetadata& metadata = TextureManager::GetInstance()->GetMetaData(textureIndex);
+	const DirectX::TexMetadata& metadata = TextureManager::GetInstance()->GetMetaData(textureHandle);
 
 	textureSize.x = static_cast<float>(metadata.width);
 	textureSize.y = static_cast<float>(metadata.height);
 	// 画像サイズをテクスチャサイズに合わせる
 	size = textureSize;
+	isTextureSizeAdjusted_ = true;
 
 }
\ No newline at end of file
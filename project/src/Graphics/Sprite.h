@@ -24,6 +24,8 @@
 #include "Matrix4x4.h"
 #include "Vector2.h"
 #include "Vector4.h"
+#include "Transform.h"
+#include "TextureHandle.h"
 
 class SpriteCommon;
 class WinApp;
@@ -49,6 +51,7 @@ public:
 	const bool IsFlipY() const { return isFlipY_; }
 	const Vector2& GetTextureLeftTop() const { return textureLeftTop; }
 	const Vector2& GetTextureSize() const { return textureSize; }
+	const bool IsVisible() const { return isVisible_; } // 画面内にあるか（Updateで更新）
 	// setter
 	void SetPosition(const Vector2& position) { this->position = position; } // 座標
 	void SetRotation(float rotation) { this->rotation = rotation; } // 回転
@@ -116,15 +119,9 @@ private:
 	// テクスチャ
 	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU;
 	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU;
-	// テクスチャ番号
-	uint32_t textureIndex = 0;
+	// テクスチャ
+	TextureHandle textureHandle;
 
-	struct Transform
-	{
-		Vector3 scale;
-		Vector3 rotate;
-		Vector3 translate;
-	};
 	Transform transform =
 	{
 		{1.0f,1.0f,1.0f},
@@ -146,6 +143,11 @@ private:
 	bool isFlipX_ = false;
 	bool isFlipY_ = false;
 
+	// 画面内にあるか
+	bool isVisible_ = true;
+	// テクスチャサイズに合わせたか（読み込みが済むまではfalse）
+	bool isTextureSizeAdjusted_ = false;
+
 	// テクスチャ範囲指定
 	Vector2 textureLeftTop = { 0.0f,0.0f };		// テクスチャ左上座標
 	Vector2 textureSize = { 100.0f,100.0f };	// テクスチャ切り出しサイズ
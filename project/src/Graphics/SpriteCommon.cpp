@@ -14,11 +14,11 @@ void SpriteCommon::Initialize(DirectXCommon* dxCommon)
 }
 
 // 共通描画設定
-void SpriteCommon::SetCommonPipelineState()
+void SpriteCommon::SetCommonPipelineState(VertexFormat format)
 {
 	// RootSignatureを設定。PSOに設定しているけど別途設定が必要
 	dxCommon_->GetCommandList()->SetGraphicsRootSignature(rootSignature.Get());
-	dxCommon_->GetCommandList()->SetPipelineState(graphicsPipelineState.Get()); // PSOを設定
+	dxCommon_->GetCommandList()->SetPipelineState(graphicsPipelineStates[static_cast<size_t>(format)].Get()); // 頂点の形式に合ったPSOを設定
 	// 形状を設定。PSOに設定しているものとはまた別。同じものを設定すると考えておけ良い
 	dxCommon_->GetCommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
@@ -93,23 +93,34 @@ void SpriteCommon::CreateRootSignature()
 	);
 	assert(SUCCEEDED(hr));
 
-	// InputLayout
-	inputElementDescs[0].SemanticName = "POSITION";
-	inputElementDescs[0].SemanticIndex = 0;
-	inputElementDescs[0].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	inputElementDescs[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-	inputElementDescs[1].SemanticName = "TEXCOORD";
-	inputElementDescs[1].SemanticIndex = 0;
-	inputElementDescs[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-	inputElementDescs[1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-	inputElementDescs[2].SemanticName = "NORMAL";
-	inputElementDescs[2].SemanticIndex = 0;
-	inputElementDescs[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	inputElementDescs[2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-
-
-	inputLayoutDesc.pInputElementDescs = inputElementDescs;
-	inputLayoutDesc.NumElements = _countof(inputElementDescs);
+	// InputLayout（VertexFormatの順。要素の順番とセマンティクスはどの形式も同じで、各要素の型だけが違う）
+	// Float           : float4 位置, float2 UV, float3 法線（VertexData）
+	// PackedQuantized : 16bit UNORM 位置（メッシュのAABBで量子化）, half2 UV, 16bit SNORM 八面体法線（PackedVertexData）
+	// PackedHalf      : half4 位置, half2 UV, 16bit SNORM 八面体法線（PackedVertexData）
+	const DXGI_FORMAT elementFormats[kVertexFormatCount][3] =
+	{
+		{ DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT },
+		{ DXGI_FORMAT_R16G16B16A16_UNORM, DXGI_FORMAT_R16G16_FLOAT, DXGI_FORMAT_R16G16_SNORM },
+		{ DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R16G16_FLOAT, DXGI_FORMAT_R16G16_SNORM },
+	};
+	for (size_t format = 0; format < kVertexFormatCount; ++format)
+	{
+		inputElementDescs[format][0].SemanticName = "POSITION";
+		inputElementDescs[format][0].SemanticIndex = 0;
+		inputElementDescs[format][0].Format = elementFormats[format][0];
+		inputElementDescs[format][0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+		inputElementDescs[format][1].SemanticName = "TEXCOORD";
+		inputElementDescs[format][1].SemanticIndex = 0;
+		inputElementDescs[format][1].Format = elementFormats[format][1];
+		inputElementDescs[format][1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+		inputElementDescs[format][2].SemanticName = "NORMAL";
+		inputElementDescs[format][2].SemanticIndex = 0;
+		inputElementDescs[format][2].Format = elementFormats[format][2];
+		inputElementDescs[format][2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+
+		inputLayoutDescs[format].pInputElementDescs = inputElementDescs[format];
+		inputLayoutDescs[format].NumElements = _countof(inputElementDescs[format]);
+	}
 
 	// BlendStateの設定
 	// 全ての色要素を書き込む
@@ -127,6 +138,9 @@ void SpriteCommon::CreateRootSignature()
 	vertexShaderBlob = dxCommon_->CompileShader(L"Resources/shaders/Object3D.VS.hlsl", L"vs_6_0");
 	assert(vertexShaderBlob != nullptr);
 
+	packedVertexShaderBlob = dxCommon_->CompileShader(L"Resources/shaders/Object3D.Packed.VS.hlsl", L"vs_6_0");
+	assert(packedVertexShaderBlob != nullptr);
+
 	pixelShaderBlob = dxCommon_->CompileShader(L"Resources/shaders/Object3D.PS.hlsl", L"ps_6_0");
 	assert(pixelShaderBlob != nullptr);
 }
@@ -137,9 +151,6 @@ void SpriteCommon::CreateGraphicsPipeline()
 	//PSO
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC graphicsPipelineStateDesc{};
 	graphicsPipelineStateDesc.pRootSignature = rootSignature.Get(); // RootSignature
-	graphicsPipelineStateDesc.InputLayout = inputLayoutDesc; // InputLayout
-	graphicsPipelineStateDesc.VS = { vertexShaderBlob->GetBufferPointer(),
-	vertexShaderBlob->GetBufferSize() }; // VertexShader
 	graphicsPipelineStateDesc.PS = { pixelShaderBlob->GetBufferPointer(),
 	pixelShaderBlob->GetBufferSize() }; // PixelShader
 	graphicsPipelineStateDesc.BlendState = blendDesc; // BlendState
@@ -158,11 +169,18 @@ void SpriteCommon::CreateGraphicsPipeline()
 	// どのように画面に色を打ち込むかの設定（気にしなくて良い）
 	graphicsPipelineStateDesc.SampleDesc.Count = 1;
 	graphicsPipelineStateDesc.SampleMask = D3D12_DEFAULT_SAMPLE_MASK;
-	// 実際に生成
-	HRESULT hr = dxCommon_->GetDevice()->CreateGraphicsPipelineState
-	(
-		&graphicsPipelineStateDesc,
-		IID_PPV_ARGS(&graphicsPipelineState)
-	);
-	assert(SUCCEEDED(hr));
+	// 実際に生成。InputLayoutとVertexShaderだけを変えて頂点の形式の数だけ作る
+	for (size_t format = 0; format < kVertexFormatCount; ++format)
+	{
+		IDxcBlob* formatVertexShaderBlob = static_cast<VertexFormat>(format) == VertexFormat::Float ? vertexShaderBlob.Get() : packedVertexShaderBlob.Get();
+		graphicsPipelineStateDesc.InputLayout = inputLayoutDescs[format]; // InputLayout
+		graphicsPipelineStateDesc.VS = { formatVertexShaderBlob->GetBufferPointer(),
+		formatVertexShaderBlob->GetBufferSize() }; // VertexShader
+		HRESULT hr = dxCommon_->GetDevice()->CreateGraphicsPipelineState
+		(
+			&graphicsPipelineStateDesc,
+			IID_PPV_ARGS(&graphicsPipelineStates[format])
+		);
+		assert(SUCCEEDED(hr));
+	}
 }
\ No newline at end of file
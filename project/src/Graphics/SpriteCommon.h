@@ -5,14 +5,15 @@
 #include <dxcapi.h>
 
 #include "DirectXCommon.h"
+#include "VertexData.h"
 
 class SpriteCommon
 {
 public:
 	// 初期化
 	void Initialize(DirectXCommon* dxCommon);
-	// 共通描画設定
-	void SetCommonPipelineState();
+	// 共通描画設定（formatは描画する頂点バッファの形式）
+	void SetCommonPipelineState(VertexFormat format = VertexFormat::Float);
 
 	// ゲッター
 	DirectXCommon* GetDxCommon() const { return dxCommon_; }
@@ -20,15 +21,18 @@ public:
 private:
 	// ルートシグネチャ
 	Microsoft::WRL::ComPtr <ID3D12RootSignature> rootSignature = nullptr;
-	D3D12_INPUT_LAYOUT_DESC inputLayoutDesc{};
-	D3D12_INPUT_ELEMENT_DESC inputElementDescs[3] = {};
+	// 頂点の形式ごとのInputLayout
+	D3D12_INPUT_LAYOUT_DESC inputLayoutDescs[kVertexFormatCount]{};
+	D3D12_INPUT_ELEMENT_DESC inputElementDescs[kVertexFormatCount][3] = {};
 	Microsoft::WRL::ComPtr<IDxcBlob> vertexShaderBlob = nullptr;
+	// 圧縮した頂点用のVertexShader
+	Microsoft::WRL::ComPtr<IDxcBlob> packedVertexShaderBlob = nullptr;
 	Microsoft::WRL::ComPtr<IDxcBlob> pixelShaderBlob = nullptr;
 	D3D12_BLEND_DESC blendDesc{};
 	D3D12_RASTERIZER_DESC rasterizerDesc{};
 
-	// グラフィックスパイプライン
-	Microsoft::WRL::ComPtr <ID3D12PipelineState> graphicsPipelineState = nullptr;
+	// グラフィックスパイプライン（頂点の形式ごと）
+	Microsoft::WRL::ComPtr <ID3D12PipelineState> graphicsPipelineStates[kVertexFormatCount] = {};
 
 
 
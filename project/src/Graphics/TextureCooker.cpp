@@ -0,0 +1,192 @@
+#include "TextureCooker.h"
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <thread>
+
+#include "HashUtility.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "StringUtility.h"
+
+namespace
+{
+	// パスはUTF-8として扱う（MappedFileと同じ）
+	std::filesystem::path ToPath(const std::string& path)
+	{
+		return std::filesystem::path(StringUtility::ConvertString(path));
+	}
+
+	// 拡張子が一致するか（大文字小文字は区別しない）
+	bool HasExtension(std::string_view path, std::string_view extension)
+	{
+		return path.size() >= extension.size() && std::equal(extension.begin(), extension.end(), path.end() - extension.size(),
+			[](char a, char b) { return a == std::tolower(static_cast<unsigned char>(b)); });
+	}
+
+	// WICで読める画像か
+	bool IsSourceImage(std::string_view path)
+	{
+		constexpr std::string_view kSourceExtensions[] = { ".png", ".jpg", ".jpeg", ".bmp", ".gif", ".tif", ".tiff" };
+		return std::any_of(std::begin(kSourceExtensions), std::end(kSourceExtensions), [&](std::string_view extension) { return HasExtension(path, extension); });
+	}
+
+	// 圧縮の形式ごとのDXGIフォーマット（画像はsRGBで読むので圧縮後もsRGB）
+	DXGI_FORMAT GetCompressedFormat(TextureCompression compression)
+	{
+		switch (compression)
+		{
+		case TextureCompression::BC1: return DXGI_FORMAT_BC1_UNORM_SRGB;
+		case TextureCompression::BC3: return DXGI_FORMAT_BC3_UNORM_SRGB;
+		default: return DXGI_FORMAT_BC7_UNORM_SRGB;
+		}
+	}
+	// 変換したファイルの名前に付ける形式の名前
+	const char* GetCompressionName(TextureCompression compression)
+	{
+		switch (compression)
+		{
+		case TextureCompression::BC1: return "bc1";
+		case TextureCompression::BC3: return "bc3";
+		default: return "bc7";
+		}
+	}
+
+	// 中身のハッシュから変換したファイルのパスを作る（元の画像のフォルダのCookedフォルダの中）
+	std::string GetCookedPath(const std::string& sourcePath, uint64_t contentHash, TextureCompression compression)
+	{
+		const std::string directoryPath = sourcePath.substr(0, sourcePath.find_last_of("/\\") + 1);
+		return std::format("{}{}/{:016x}.{}.dds", directoryPath, TextureCooker::kCookedDirectory, contentHash, GetCompressionName(compression));
+	}
+
+	// 画像を読んでミップマップを作り、圧縮してDDSに書き出す
+	bool Cook(const MappedFile& source, const std::string& sourcePath, const std::string& cookedPath, TextureCompression compression)
+	{
+		const auto startTime = std::chrono::steady_clock::now();
+
+		// テクスチャファイルを読んでプログラムで扱えるようにする（ハッシュを計算したマップをそのまま使う）
+		DirectX::ScratchImage image{};
+		HRESULT hr = DirectX::LoadFromWICMemory(source.GetData(), source.GetSize(), DirectX::WIC_FLAGS_FORCE_SRGB, nullptr, image);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		// ミップマップの作成
+		DirectX::ScratchImage mipImages{};
+		hr = DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::TEX_FILTER_SRGB, 0, mipImages);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		// BC圧縮は4x4画素のブロック単位なので、D3D12では一番大きいミップの幅と高さが4の倍数でないと使えない
+		// 使えない大きさなら圧縮せずにミップマップだけ持たせる
+		const DirectX::TexMetadata& metadata = mipImages.GetMetadata();
+		DirectX::ScratchImage compressedImages{};
+		const DirectX::ScratchImage* output = &mipImages;
+		if (metadata.width % 4 == 0 && metadata.height % 4 == 0)
+		{
+			hr = DirectX::Compress(mipImages.GetImages(), mipImages.GetImageCount(), metadata, GetCompressedFormat(compression),
+				DirectX::TEX_COMPRESS_PARALLEL, DirectX::TEX_THRESHOLD_DEFAULT, compressedImages);
+			if (FAILED(hr))
+			{
+				return false;
+			}
+			output = &compressedImages;
+		}
+
+		// 途中で失敗しても壊れたファイルが残らないように、一時ファイルに書いてから置き換える
+		// 同じ中身の画像を別のスレッドが同時に変換していてもぶつからないように、スレッドごとに名前を変える
+		std::error_code errorCode;
+		std::filesystem::create_directories(ToPath(cookedPath).parent_path(), errorCode);
+		const std::string temporaryPath = std::format("{}.{}.tmp", cookedPath, std::hash<std::thread::id>()(std::this_thread::get_id()));
+		hr = DirectX::SaveToDDSFile(output->GetImages(), output->GetImageCount(), output->GetMetadata(), DirectX::DDS_FLAGS_NONE,
+			StringUtility::ConvertString(temporaryPath).c_str());
+		if (FAILED(hr))
+		{
+			std::filesystem::remove(ToPath(temporaryPath), errorCode);
+			return false;
+		}
+		std::filesystem::rename(ToPath(temporaryPath), ToPath(cookedPath), errorCode);
+		if (errorCode)
+		{
+			std::filesystem::remove(ToPath(temporaryPath), errorCode);
+			// 別のスレッドが先に書き終えていればそれを使う
+			return std::filesystem::exists(ToPath(cookedPath), errorCode);
+		}
+
+		const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		Logger::Log(std::format("TextureCooker: {} -> {} ({}x{}, {} mips, {} bytes -> {} bytes, {:.1f} ms)\n",
+			sourcePath, cookedPath, metadata.width, metadata.height, metadata.mipLevels,
+			image.GetPixelsSize(), output->GetPixelsSize(), milliseconds));
+		return true;
+	}
+}
+
+// 変換したDDSのパスを返す
+std::string TextureCooker::CookTexture(const std::string& sourcePath, TextureCompression compression)
+{
+	MappedFile source;
+	if (!source.Open(sourcePath))
+	{
+		return {};
+	}
+	// 変換の仕方の版も混ぜて、変えたときに古いファイルを使わないようにする
+	const uint64_t contentHash = HashUtility::ComputeHash64(source.GetData(), source.GetSize(), kCookVersion);
+	const std::string cookedPath = GetCookedPath(sourcePath, contentHash, compression);
+
+	// 中身が同じ画像を変換済みなら、画像を解釈せずにそのまま使う
+	std::error_code errorCode;
+	if (std::filesystem::exists(ToPath(cookedPath), errorCode))
+	{
+		return cookedPath;
+	}
+	if (!Cook(source, sourcePath, cookedPath, compression))
+	{
+		return {};
+	}
+	return cookedPath;
+}
+
+// フォルダの中の画像をまとめて変換する
+uint32_t TextureCooker::CookDirectory(const std::string& directoryPath, TextureCompression compression)
+{
+	uint32_t cookedCount = 0;
+	std::error_code errorCode;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(ToPath(directoryPath), errorCode))
+	{
+		// 変換したファイルの置き場所は見ない
+		if (!entry.is_regular_file() || entry.path().parent_path().filename() == std::filesystem::path(kCookedDirectory))
+		{
+			continue;
+		}
+		const std::string path = StringUtility::ConvertString(entry.path().wstring());
+		if (!IsSourceImage(path))
+		{
+			continue;
+		}
+		if (!CookTexture(path, compression).empty())
+		{
+			++cookedCount;
+		}
+	}
+	return cookedCount;
+}
+
+// ミップマップ付きの画像を読み込む
+bool TextureCooker::LoadTexture(const std::string& filePath, DirectX::ScratchImage& image, TextureCompression compression)
+{
+	// DDSはミップマップまで変換済みとしてそのまま読む
+	const std::string cookedPath = HasExtension(filePath, ".dds") ? filePath : CookTexture(filePath, compression);
+	if (cookedPath.empty())
+	{
+		return false;
+	}
+	HRESULT hr = DirectX::LoadFromDDSFile(StringUtility::ConvertString(cookedPath).c_str(), DirectX::DDS_FLAGS_NONE, nullptr, image);
+	return SUCCEEDED(hr);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "DirectXTex-mar2023/DirectXTex/DirectXTex.h"
+
+// 圧縮の形式
+enum class TextureCompression : uint8_t
+{
+	BC1, // 4bit/画素。アルファは抜きのみ
+	BC3, // 8bit/画素。なめらかなアルファ
+	BC7, // 8bit/画素。高画質（変換は一番遅い）
+};
+
+// テクスチャの変換（PNGなどを、ミップマップを全部持つBC圧縮のDDSにする）
+// 変換したファイルは元の画像と同じ場所のCookedフォルダに中身のハッシュを名前にして置くので、
+// 中身が同じなら別のパスの画像でも1つを共有し、変えたときだけ作り直される
+namespace TextureCooker
+{
+	// 変換したファイルを置くフォルダ（元の画像のフォルダの中）
+	constexpr const char* kCookedDirectory = "Cooked";
+	// 変換の仕方を変えたら上げる（古いファイルは使われなくなる）
+	constexpr uint32_t kCookVersion = 1;
+
+	// 変換したDDSのパスを返す（なければ作る。元の画像が読めなければ空）
+	std::string CookTexture(const std::string& sourcePath, TextureCompression compression = TextureCompression::BC7);
+	// フォルダの中の画像をまとめて変換する（起動前に済ませておけば、初回の起動でも変換しなくて済む）
+	// 使えるようになった枚数（変換済みだったものも含む）を返す
+	uint32_t CookDirectory(const std::string& directoryPath, TextureCompression compression = TextureCompression::BC7);
+
+	// ミップマップ付きの画像を読み込む（DDSはそのまま、ほかは変換したDDSを読む）
+	bool LoadTexture(const std::string& filePath, DirectX::ScratchImage& image, TextureCompression compression = TextureCompression::BC7);
+};
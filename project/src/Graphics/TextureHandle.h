@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+// テクスチャのハンドル（TextureManagerの中の番号と世代）
+// テクスチャを解放すると番号は使い回すが世代が変わるので、古いハンドルは無効だと分かる
+struct TextureHandle
+{
+	uint32_t index = 0;
+	uint32_t generation = 0; // 0なら無効
+
+	bool operator==(const TextureHandle& other) const = default;
+};
@@ -6,6 +6,33 @@
 using namespace StringUtility;
 
 
+namespace
+{
+	// 途中のミップを一番細かいミップにしてリソースを作れるか
+	// BC圧縮は一番大きいミップの幅と高さが4の倍数でないと作れないので、ミップテールまでのミップがすべて4の倍数である必要がある
+	bool CanStreamMips(const DirectX::TexMetadata& metadata)
+	{
+		if (!DirectX::IsCompressed(metadata.format))
+		{
+			return true;
+		}
+		for (size_t mip = 0; mip < metadata.mipLevels; ++mip)
+		{
+			const size_t width = (std::max)(size_t(1), metadata.width >> mip);
+			const size_t height = (std::max)(size_t(1), metadata.height >> mip);
+			if (width % 4 != 0 || height % 4 != 0)
+			{
+				return false;
+			}
+			if ((std::max)(width, height) <= TextureStreamer::kMipTailSize)
+			{
+				break;
+			}
+		}
+		return true;
+	}
+}
+
 TextureManager* TextureManager::instance = nullptr;
 // ImGuiで0番を使用するため、1番から使用
 uint32_t TextureManager::kSRVIndexTop = 1;
@@ -16,6 +43,44 @@ void TextureManager::Initialize(DirectXCommon* dxCommon_)
 
 	// SRVの数と同数
 	textureDatas.reserve(DirectXCommon::kMaxSRVCount);
+
+	// 先頭のSRVはほかで使うので、残りの数だけ登録できる
+	pathTable.Initialize(DirectXCommon::kMaxSRVCount - kSRVIndexTop);
+
+	// ミップのストリーミング（細かいミップの転送もデコードしたものと同じ量を上限にする）
+	streamer.Initialize(this, kStreamingBudgetBytes, kUploadBudgetBytes);
+
+	// 仮のテクスチャ（1x1なのでUVに関係なく同じ色になる）
+	DirectX::ScratchImage placeholderImage{};
+	HRESULT hr = placeholderImage.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 1, 1, 1, 1);
+	assert(SUCCEEDED(hr));
+	std::fill_n(placeholderImage.GetPixels(), placeholderImage.GetPixelsSize(), uint8_t(0xFF));
+	placeholderMetadata = placeholderImage.GetMetadata();
+	placeholderResource = dxCommon->CreateTextureResource(placeholderMetadata);
+	placeholderIntermediateResource = dxCommon->UploadTextureData(placeholderResource, placeholderImage);
+
+	// ワーカースレッドの起動（描画スレッドの分を1つ残す）
+	const uint32_t hardwareCount = std::thread::hardware_concurrency();
+	const uint32_t workerCount = std::clamp(hardwareCount > 1 ? hardwareCount - 1 : 1u, 1u, kMaxWorkerCount);
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		workers.emplace_back(&TextureManager::WorkerMain, this);
+	}
+}
+
+// ワーカースレッドを止める
+TextureManager::~TextureManager()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		isStopping = true;
+		decodeJobs.clear();
+	}
+	jobCondition.notify_all();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
 }
 
 // シングルトンインスタンスの取得
@@ -35,110 +100,239 @@ void TextureManager::Finalize()
 	instance = nullptr;
 }
 
-void TextureManager::LoadTexture(const std::string& filePath)
+TextureHandle TextureManager::LoadTexture(const std::string& filePath)
 {
 	//std::wstring filePathW = ConvertString(filePath);
 	// 読み込み済みテクスチャを検索
-	auto it = std::find_if
-	(
-		textureDatas.begin(),
-		textureDatas.end(),
-		[&](TextureData& textureData) {return textureData.filePath == filePath; }
-	);
-	if (it != textureDatas.end())
+	const TextureHandle foundHandle = pathTable.Find(filePath);
+	if (foundHandle.generation != 0)
 	{
-		// 余も混み済みなら早期return
-		return;
+		// 読み込み済みなら早期return
+		return foundHandle;
 	}
 	// テクスチャ枚数上限チェック
-	assert(textureDatas.size() + kSRVIndexTop < DirectXCommon::kMaxSRVCount);
+	assert(!pathTable.IsFull());
 
-	// テクスチャファイルを読んでプログラムで扱えるようにする
-	DirectX::ScratchImage image{};
-	std::wstring filePathW = ConvertString(filePath);
-	HRESULT hr = DirectX::LoadFromWICFile(filePathW.c_str(), DirectX::WIC_FLAGS_FORCE_SRGB, nullptr, image);
-	assert(SUCCEEDED(hr));
-
-	// ミップマップの作成
-	DirectX::ScratchImage mipImages{};
-	hr = DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::TEX_FILTER_SRGB, 0, mipImages);
-	assert(SUCCEEDED(hr));
-
-	// テクスチャデータを追加
-	textureDatas.resize(textureDatas.size() + 1);
+	// 解放した番号があれば使い回し、なければ追加する（世代はテーブルが進める）
+	const TextureHandle handle = pathTable.Insert(filePath);
+	const uint32_t textureIndex = handle.index;
+	textureDatas.resize(pathTable.GetIndexCount());
 	// 追加したテクスチャデータの参照を取得する
-	TextureData& textureData = textureDatas.back();
+	TextureData& textureData = textureDatas[textureIndex];
 
 	// テクスチャデータ書き込み
-	textureData.filePath = filePath;
-	textureData.metadata = mipImages.GetMetadata();
-	textureData.resource = dxCommon->CreateTextureResource(textureData.metadata);
+	textureData.isReady = false;
+	textureData.metadata = placeholderMetadata;
 
 	// テクスチャデータの要素数番号をSRVのインデックスとする
-	uint32_t srvIndex = static_cast<uint32_t>(textureDatas.size() - 1) + kSRVIndexTop;
+	uint32_t srvIndex = textureIndex + kSRVIndexTop;
 
 	textureData.srvHandleCPU = dxCommon->GetSRVCPUDescriptorHandle(srvIndex);
 	textureData.srvHandleGPU = dxCommon->GetSRVGPUDescriptorHandle(srvIndex);
 
-	// SRVの生成
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
-	srvDesc.Format = textureData.metadata.format;
-	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; // 2Dテクスチャ
-	srvDesc.Texture2D.MipLevels = UINT(textureData.metadata.mipLevels);
-	// 生成
-	dxCommon->GetDevice()->CreateShaderResourceView(textureData.resource.Get(), &srvDesc, textureData.srvHandleCPU);
+	// 転送が済むまでは仮のテクスチャを指しておく（済んだら同じ位置に書き直すので、GPUハンドルは変わらない）
+	CreateSRV(textureData, placeholderResource.Get(), placeholderMetadata);
 
-	// 転送用に生成した中間リソースをテクスチャデータ構造体に格納
-	textureData.intermediateResource = dxCommon->UploadTextureData(textureData.resource, mipImages);
+	// デコードをワーカースレッドに頼む
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		decodeJobs.push_back({ textureIndex, handle.generation, filePath, textureCompression });
+	}
+	jobCondition.notify_one();
 
-	// テクスチャデータ転送
-	//dxCommon->UploadTextureData(textureData.resource, mipImages);
+	return handle;
 }
 
-// SRVインデックスの開始番号
-uint32_t TextureManager::GetTextureIndexByFilePath(const std::string& filePath)
+// デコードが済んだテクスチャを転送する
+void TextureManager::Update()
 {
-	// 読み込み済みテクスチャを検索
-	auto it = std::find_if
-	(
-		textureDatas.begin(),
-		textureDatas.end(),
-		[&](TextureData& textureData) {return textureData.filePath == filePath; }
-	);
-	if (it != textureDatas.end())
+	// 前のフレームのコマンドは実行し終わっている
+	retiredIntermediateResources.clear();
+	placeholderIntermediateResource.Reset();
+
+	// デコードが済んだものはミップテールだけを転送する
+	// ストリーミングの読み込みと同じ1フレームの転送の上限に含め、入らなければ残りは次のフレームに回す
+	for (;;)
 	{
-		// 読み込み済みなら要素番号を返す
-		uint32_t textureIndex = static_cast<uint32_t>(std::distance(textureDatas.begin(), it));
-		return textureIndex;
+		DecodedImage decodedImage{};
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			if (decodedImages.empty())
+			{
+				break;
+			}
+			decodedImage = std::move(decodedImages.front());
+			decodedImages.pop_front();
+		}
+
+		// デコード中に解放された（番号が使い回された）ものと、読めなかったものは捨てる
+		if (!pathTable.IsValid({ decodedImage.textureIndex, decodedImage.generation }) || decodedImage.mipImages.GetImageCount() == 0)
+		{
+			continue;
+		}
+
+		// ミップごとの大きさ
+		const DirectX::TexMetadata& metadata = decodedImage.mipImages.GetMetadata();
+		std::vector<uint64_t> mipSizes(metadata.mipLevels);
+		for (size_t mip = 0; mip < mipSizes.size(); ++mip)
+		{
+			mipSizes[mip] = decodedImage.mipImages.GetImage(mip, 0, 0)->slicePitch;
+		}
+		// 途中のミップからリソースを作れないものは、全部を1つのミップテールとして扱う
+		if (!CanStreamMips(metadata))
+		{
+			mipSizes.assign(1, decodedImage.mipImages.GetPixelsSize());
+		}
+		const uint32_t width = static_cast<uint32_t>(metadata.width);
+		const uint32_t height = static_cast<uint32_t>(metadata.height);
+		const uint32_t mipLevels = static_cast<uint32_t>(mipSizes.size());
+		if (!streamer.HasUploadBudget(TextureStreamer::GetMipTailBytes(width, height, mipSizes.data(), mipLevels)))
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			decodedImages.push_front(std::move(decodedImage));
+			break;
+		}
+
+		TextureData& textureData = textureDatas[decodedImage.textureIndex];
+		textureData.metadata = metadata;
+		textureData.mipImages = std::move(decodedImage.mipImages);
+		// 登録すると、SetResidentMipでミップテールのリソースが作られる
+		streamer.Register(decodedImage.textureIndex, width, height, mipSizes.data(), mipLevels);
+		textureData.isReady = true;
 	}
 
-	assert(0);
-	return 0;
+	// 前のフレームに報告された大きさから、細かいミップを読み込んだり捨てたりする
+	streamer.Update();
 }
-/**/
-// テクスチャ番号からGPUハンドルを取得
-D3D12_GPU_DESCRIPTOR_HANDLE TextureManager::GetSrvHandleGPU(uint32_t textureIndex)
+
+// 読み込み済みのテクスチャのハンドル
+TextureHandle TextureManager::GetTextureHandle(const std::string& filePath) const
 {
-	// 範囲外指定違反チェック
-	assert(textureIndex < textureDatas.size());
+	return pathTable.Find(filePath);
+}
 
-	TextureData& textureData = textureDatas[textureIndex];
+// テクスチャを解放する
+void TextureManager::UnloadTexture(TextureHandle handle)
+{
+	if (!IsValid(handle))
+	{
+		return;
+	}
+	// 番号は次に使うときに世代を進めて使い回す
+	pathTable.Remove(handle);
+	TextureData& textureData = textureDatas[handle.index];
+	textureData.isReady = false;
+	textureData.resource.Reset();
+	textureData.mipImages.Release();
+	streamer.Unregister(handle.index);
+
+	// まだデコードしていなければ依頼を取り消す（デコード中のものはUpdateで捨てる）
+	std::lock_guard<std::mutex> lock(queueMutex);
+	std::erase_if(decodeJobs, [&](const DecodeJob& job) { return job.textureIndex == handle.index; });
+}
+
+// ハンドルが今も有効か
+bool TextureManager::IsValid(TextureHandle handle) const
+{
+	return pathTable.IsValid(handle);
+}
+
+// 転送が済んでいるか
+bool TextureManager::IsReady(TextureHandle handle) const
+{
+	return IsValid(handle) && textureDatas[handle.index].isReady;
+}
+
+// 描画したテクスチャの画面上の大きさを報告する
+void TextureManager::ReportTextureUsage(TextureHandle handle, float screenSize)
+{
+	if (IsReady(handle))
+	{
+		streamer.ReportUsage(handle.index, screenSize);
+	}
+}
+
+// ハンドルからGPUハンドルを取得
+D3D12_GPU_DESCRIPTOR_HANDLE TextureManager::GetSrvHandleGPU(TextureHandle handle)
+{
+	// 解放済みや範囲外のハンドルの違反チェック
+	assert(IsValid(handle));
+
+	TextureData& textureData = textureDatas[handle.index];
 	return textureData.srvHandleGPU;
 
 }
 
 // メタデータ取得
-const DirectX::TexMetadata& TextureManager::GetMetaData(uint32_t textureIndex)
+const DirectX::TexMetadata& TextureManager::GetMetaData(TextureHandle handle)
 {
-	// 範囲外指定違反チェック
-	assert(textureIndex < textureDatas.size());
+	// 解放済みや範囲外のハンドルの違反チェック
+	assert(IsValid(handle));
 
-	TextureData& textureData = textureDatas[textureIndex];
+	TextureData& textureData = textureDatas[handle.index];
 	return textureData.metadata;
 }
-/*
-D3D12_GPU_DESCRIPTOR_HANDLE TextureManager::GetSrvHandleGPU(uint32_t index)
+
+// ワーカースレッドの処理
+void TextureManager::WorkerMain()
 {
-	return textureDatas[index].srvHandleGPU;
-}*/
\ No newline at end of file
+	// WICはスレッドごとにCOMの初期化が要る
+	HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	assert(SUCCEEDED(hr));
+
+	while (true)
+	{
+		DecodeJob job{};
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			jobCondition.wait(lock, [&]() { return isStopping || !decodeJobs.empty(); });
+			if (isStopping)
+			{
+				break;
+			}
+			job = std::move(decodeJobs.front());
+			decodeJobs.pop_front();
+		}
+
+		// ミップマップ付きのDDSを読む（初回は変換してから）
+		DirectX::ScratchImage mipImages{};
+		const bool isLoaded = TextureCooker::LoadTexture(job.filePath, mipImages, job.compression);
+		assert(isLoaded); // とりあえず読めなかったら止める（リリースでは仮のテクスチャのまま）
+
+		// 転送は描画スレッドのUpdateで行う
+		std::lock_guard<std::mutex> lock(queueMutex);
+		decodedImages.push_back({ job.textureIndex, job.generation, std::move(mipImages) });
+	}
+
+	CoUninitialize();
+}
+
+// resourceをmostDetailedMipから下のミップだけで作り直す
+void TextureManager::SetResidentMip(uint32_t textureId, uint32_t mostDetailedMip)
+{
+	TextureData& textureData = textureDatas[textureId];
+	// 持っているミップだけの大きさのテクスチャにする（前のフレームのコマンドは実行し終わっているので、前のリソースはすぐ解放してよい）
+	DirectX::TexMetadata residentMetadata = textureData.metadata;
+	residentMetadata.width = (std::max)(size_t(1), residentMetadata.width >> mostDetailedMip);
+	residentMetadata.height = (std::max)(size_t(1), residentMetadata.height >> mostDetailedMip);
+	residentMetadata.mipLevels -= mostDetailedMip;
+	textureData.resource = dxCommon->CreateTextureResource(residentMetadata);
+	// 転送用に生成した中間リソースは、コマンドを実行し終わるまで持っておく
+	retiredIntermediateResources.push_back(dxCommon->UploadTextureData(textureData.resource,
+		textureData.mipImages.GetImages() + mostDetailedMip, residentMetadata.mipLevels, residentMetadata));
+	// 同じ位置に書き直すので、GPUハンドルは変わらない。転送のあとに積む描画から新しいリソースを使う
+	CreateSRV(textureData, textureData.resource.Get(), residentMetadata);
+	textureData.residentMip = mostDetailedMip;
+}
+
+// SRVを書き込む
+void TextureManager::CreateSRV(const TextureData& textureData, ID3D12Resource* resource, const DirectX::TexMetadata& metadata)
+{
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+	srvDesc.Format = metadata.format;
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; // 2Dテクスチャ
+	srvDesc.Texture2D.MipLevels = UINT(metadata.mipLevels);
+	// 生成
+	dxCommon->GetDevice()->CreateShaderResourceView(resource, &srvDesc, textureData.srvHandleCPU);
+}
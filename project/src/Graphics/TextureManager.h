@@ -2,8 +2,18 @@
 #include "string"
 #include <dxgi1_6.h>      // DXGI_FORMAT 等
 #include <vector>
+#include <cstdint>
+#include <string_view>
+#include "TextureHandle.h"
+#include "TexturePathTable.h"
+#include "TextureCooker.h"
+#include "TextureStreamer.h"
 #include <algorithm>
 #include <cassert>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include "DirectXTex-mar2023/DirectXTex/DirectXTex.h"
 #include "DirectXTex-mar2023/DirectXTex/d3dx12.h"
 
@@ -17,18 +27,20 @@ using Microsoft::WRL::ComPtr;
 
 class DirectXCommon;
 
-class TextureManager
+// 細かいミップはTextureStreamerが画面上の大きさとメモリの上限から決め、このクラスが読み込む
+class TextureManager : private TextureStreamingBackend
 {
 public:
 
 	// テクスチャ1枚分のデータ
 	struct TextureData
 	{
-		std::string filePath;
-		DirectX::TexMetadata metadata;
+		bool isReady = false; // 転送が済んで本物の画像を指しているか（それまでは仮のテクスチャを指す）
+		DirectX::TexMetadata metadata; // 転送が済むまでは仮のテクスチャのもの。済んだらミップを全部持ったときのもの
+		DirectX::ScratchImage mipImages; // 全部のミップ（ストリーミングで細かいミップを読み込むときのためにメインメモリに持つ）
+		uint32_t residentMip = 0; // resourceが持っている一番細かいミップ
 
 		ComPtr<ID3D12Resource> resource;
-		ComPtr<ID3D12Resource> intermediateResource;
 		D3D12_CPU_DESCRIPTOR_HANDLE srvHandleCPU{};
 		D3D12_GPU_DESCRIPTOR_HANDLE srvHandleGPU{};
 	};
@@ -43,29 +55,98 @@ public:
 	// 終了
 	void Finalize();
 
-	// テクスチャファイルの読み込み
-	void LoadTexture(const std::string& filePath);
-	// SRVインデックスの開始番号
-	uint32_t GetTextureIndexByFilePath(const std::string& filePath);
-	// テクスチャ番号からGPUハンドルを取得
-	D3D12_GPU_DESCRIPTOR_HANDLE GetSrvHandleGPU(uint32_t textureIndex);
+	// テクスチャファイルの読み込み（読み込み済みならそのハンドルを返す）
+	// すぐにハンドルを返し、SRVは転送が済むまで仮のテクスチャを指す。読み込みはワーカースレッドで行う
+	// PNGなどは初回だけミップマップ付きのBC圧縮のDDSに変換し（TextureCooker）、以降は変換したDDSをそのまま読む
+	TextureHandle LoadTexture(const std::string& filePath);
+	// これから読み込むテクスチャの圧縮の形式（読み込み済みのものは変わらない）
+	void SetCompression(TextureCompression compression) { textureCompression = compression; }
+	// デコードが済んだテクスチャをコマンドリストに積んで転送する（毎フレーム描画前に描画スレッドで呼ぶ）
+	void Update();
+	// 読み込み済みのテクスチャのハンドル（読んでいなければ無効なハンドル）
+	TextureHandle GetTextureHandle(const std::string& filePath) const;
+	// テクスチャを解放する（GPUが使い終わってから呼ぶこと。ハンドルは無効になる）
+	void UnloadTexture(TextureHandle handle);
+	// ハンドルが今も読み込まれているテクスチャを指しているか
+	bool IsValid(TextureHandle handle) const;
+	// 転送が済んで本物の画像を使えるか
+	bool IsReady(TextureHandle handle) const;
+	// 描画したテクスチャの画面上の大きさ（テクスチャ全体が覆う画素数）を報告する。大きいものほど細かいミップを読み込む
+	void ReportTextureUsage(TextureHandle handle, float screenSize);
+	// テクスチャのミップに使うメモリの上限
+	void SetStreamingBudget(uint64_t budgetBytes) { streamer.SetMemoryBudget(budgetBytes); }
+	const TextureStreamer& GetStreamer() const { return streamer; }
+	// ハンドルからGPUハンドルを取得
+	D3D12_GPU_DESCRIPTOR_HANDLE GetSrvHandleGPU(TextureHandle handle);
 	// メタデータ取得
-	const DirectX::TexMetadata& GetMetaData(uint32_t textureIndex);
+	const DirectX::TexMetadata& GetMetaData(TextureHandle handle);
 
 
 private:
 
-	// テクスチャデータ
+	// ワーカースレッドに渡すデコードの依頼
+	struct DecodeJob
+	{
+		uint32_t textureIndex;
+		uint32_t generation; // 完成したときに番号が使い回されていないか確かめる
+		std::string filePath;
+		TextureCompression compression;
+	};
+	// デコードが済んだ画像
+	struct DecodedImage
+	{
+		uint32_t textureIndex;
+		uint32_t generation;
+		DirectX::ScratchImage mipImages; // 読めなかったら空
+	};
+
+	// 1フレームに転送する量の上限（ミップテールの登録とストリーミングの読み込み・解放の合計。これを超える画像は1フレームに1枚だけ）
+	static constexpr size_t kUploadBudgetBytes = 16 * 1024 * 1024;
+	// テクスチャのミップに使うメモリの上限の初期値
+	static constexpr uint64_t kStreamingBudgetBytes = 256ull * 1024 * 1024;
+	// ワーカースレッドの最大数
+	static constexpr uint32_t kMaxWorkerCount = 4;
+
+	// ワーカースレッドの処理（依頼がなくなるまでデコードし続ける）
+	void WorkerMain();
+	// resourceをmostDetailedMipから下のミップだけで作り直す（TextureStreamerから呼ばれる）
+	// 捨てるときも残すミップを全部転送し直すので、その分はTextureStreamerが転送の上限に数えている
+	void SetResidentMip(uint32_t textureId, uint32_t mostDetailedMip) override;
+	// SRVを書き込む
+	void CreateSRV(const TextureData& textureData, ID3D12Resource* resource, const DirectX::TexMetadata& metadata);
+
+	// テクスチャデータ（番号とSRVの位置は対応していて、解放しても詰めない）
 	std::vector<TextureData> textureDatas;
+	// パスからハンドルを探すテーブル（番号の使い回しと世代もここで決める）
+	TexturePathTable pathTable;
+
+	// 転送が済むまで使う1x1の白いテクスチャ
+	ComPtr<ID3D12Resource> placeholderResource;
+	ComPtr<ID3D12Resource> placeholderIntermediateResource;
+	DirectX::TexMetadata placeholderMetadata{};
+	// 前のフレームで転送に使った中間リソース（PostDrawでGPUを待つので次のUpdateで解放できる）
+	std::vector<ComPtr<ID3D12Resource>> retiredIntermediateResources;
+
+	// ワーカースレッドとやり取りするキュー（mutexで守る）
+	std::vector<std::thread> workers;
+	std::mutex queueMutex;
+	std::condition_variable jobCondition;
+	std::deque<DecodeJob> decodeJobs;
+	std::deque<DecodedImage> decodedImages;
+	bool isStopping = false;
 
 	static TextureManager* instance;
 	// SRVインデックスの開始番号
 	static uint32_t kSRVIndexTop;
 
 	DirectXCommon* dxCommon = nullptr;
+	// ミップのストリーミング（番号はテクスチャデータの番号）
+	TextureStreamer streamer;
+	// これから読み込むテクスチャの圧縮の形式
+	TextureCompression textureCompression = TextureCompression::BC7;
 
 	TextureManager() = default;
-	~TextureManager() = default;
+	~TextureManager();
 	TextureManager(TextureManager&) = delete;
 	TextureManager& operator=(TextureManager&) = delete;
 };
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "TexturePathTable.h"
+#include <cassert>
+
+#include "HashUtility.h"
+
+// 初期化
+void TexturePathTable::Initialize(uint32_t maxCount)
+{
+	maxCount_ = maxCount;
+	entries_.clear();
+	entries_.reserve(maxCount);
+	freeIndices_.clear();
+
+	// 全部埋まっても半分以上空いている大きさにして、探す長さを短く保つ
+	size_t slotCount = 16;
+	while (slotCount < size_t(maxCount) * 2)
+	{
+		slotCount *= 2;
+	}
+	slots_.assign(slotCount, Slot{ 0, kEmptySlot });
+}
+
+// 登録済みならそのハンドル
+TextureHandle TexturePathTable::Find(std::string_view path) const
+{
+	const uint32_t slot = FindSlot(path, HashUtility::ComputeHash64(path.data(), path.size()));
+	if (slot == kEmptySlot)
+	{
+		return {};
+	}
+	const uint32_t index = slots_[slot].index;
+	return { index, entries_[index].generation };
+}
+
+// 登録する
+TextureHandle TexturePathTable::Insert(std::string_view path)
+{
+	assert(!IsFull());
+	const uint64_t hash = HashUtility::ComputeHash64(path.data(), path.size());
+	assert(FindSlot(path, hash) == kEmptySlot);
+
+	// 解放した番号があれば使い回し、なければ追加する
+	uint32_t index = 0;
+	if (!freeIndices_.empty())
+	{
+		index = freeIndices_.back();
+		freeIndices_.pop_back();
+	}
+	else
+	{
+		index = static_cast<uint32_t>(entries_.size());
+		entries_.emplace_back();
+	}
+	Entry& entry = entries_[index];
+	entry.path = path;
+	entry.hash = hash;
+	// 世代を進める（0は無効なハンドルに使うので飛ばす）
+	entry.generation = entry.generation + 1 == 0 ? 1 : entry.generation + 1;
+	entry.isUsed = true;
+
+	// ハッシュテーブルに登録する（空きは必ずある）
+	const uint32_t mask = static_cast<uint32_t>(slots_.size() - 1);
+	uint32_t slot = static_cast<uint32_t>(hash & mask);
+	while (slots_[slot].index != kEmptySlot)
+	{
+		slot = (slot + 1) & mask;
+	}
+	slots_[slot] = { hash, index };
+
+	return { index, entry.generation };
+}
+
+// 登録を外す
+void TexturePathTable::Remove(TextureHandle handle)
+{
+	if (!IsValid(handle))
+	{
+		return;
+	}
+	Entry& entry = entries_[handle.index];
+	RemoveSlot(FindSlot(entry.path, entry.hash));
+	// 世代は残し、次に使うときに進める
+	entry.path.clear();
+	entry.isUsed = false;
+	freeIndices_.push_back(handle.index);
+}
+
+// ハンドルが今も有効か
+bool TexturePathTable::IsValid(TextureHandle handle) const
+{
+	return handle.generation != 0 && handle.index < entries_.size() &&
+		entries_[handle.index].isUsed && entries_[handle.index].generation == handle.generation;
+}
+
+// ハッシュテーブルの中の位置
+uint32_t TexturePathTable::FindSlot(std::string_view path, uint64_t hash) const
+{
+	const uint32_t mask = static_cast<uint32_t>(slots_.size() - 1);
+	for (uint32_t slot = static_cast<uint32_t>(hash & mask); slots_[slot].index != kEmptySlot; slot = (slot + 1) & mask)
+	{
+		// 文字列を比べるのは64bitのハッシュ値が一致したときだけ
+		if (slots_[slot].hash == hash && entries_[slots_[slot].index].path == path)
+		{
+			return slot;
+		}
+	}
+	return kEmptySlot;
+}
+
+// ハッシュテーブルから取り除く
+void TexturePathTable::RemoveSlot(uint32_t slot)
+{
+	assert(slot != kEmptySlot);
+	const uint32_t mask = static_cast<uint32_t>(slots_.size() - 1);
+	uint32_t hole = slot;
+	for (uint32_t next = (hole + 1) & mask; slots_[next].index != kEmptySlot; next = (next + 1) & mask)
+	{
+		// 本来の位置から穴を越えずに届くものは動かさない
+		const uint32_t home = static_cast<uint32_t>(slots_[next].hash & mask);
+		if (((next - home) & mask) >= ((next - hole) & mask))
+		{
+			slots_[hole] = slots_[next];
+			hole = next;
+		}
+	}
+	slots_[hole] = { 0, kEmptySlot };
+}
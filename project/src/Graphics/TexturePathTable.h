@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "TextureHandle.h"
+
+// テクスチャのパスとハンドルの対応（D3D12を使わないので、TextureManagerの外でも確かめられる）
+// 番号は解放したものを使い回し、使い回すたびに世代を進めるので、古いハンドルは無効だと分かる
+class TexturePathTable
+{
+public:
+	// 初期化（maxCountは同時に登録できる数。番号は0からmaxCount-1）
+	void Initialize(uint32_t maxCount);
+
+	// 登録済みならそのハンドル（なければ無効なハンドル）
+	TextureHandle Find(std::string_view path) const;
+	// 登録する（登録済みでないこと。空いていることは呼ぶ側で確かめる）
+	TextureHandle Insert(std::string_view path);
+	// 登録を外す（無効なハンドルなら何もしない）
+	void Remove(TextureHandle handle);
+	// ハンドルが今も登録されているパスを指しているか
+	bool IsValid(TextureHandle handle) const;
+
+	// getter
+	bool IsFull() const { return freeIndices_.empty() && entries_.size() >= maxCount_; }
+	// 使ったことのある番号の数（番号ごとのデータの配列はこの大きさにする）
+	uint32_t GetIndexCount() const { return static_cast<uint32_t>(entries_.size()); }
+
+private:
+	// ハッシュテーブルの要素（オープンアドレス法）
+	// 文字列は番号ごとに1つだけ持ち、ハッシュ値が一致したときだけ比べる
+	struct Slot
+	{
+		uint64_t hash;
+		uint32_t index; // kEmptySlotなら空き
+	};
+	static constexpr uint32_t kEmptySlot = UINT32_MAX;
+
+	// 番号ごとの状態
+	struct Entry
+	{
+		std::string path;
+		uint64_t hash = 0;
+		uint32_t generation = 0; // 番号を使い回すたびに増やす
+		bool isUsed = false; // 解放して空いている番号ならfalse
+	};
+
+	// ハッシュテーブルの中の位置（なければkEmptySlot）
+	uint32_t FindSlot(std::string_view path, uint64_t hash) const;
+	// ハッシュテーブルから取り除く（後ろの要素を詰めて、探す途中に空きができないようにする）
+	void RemoveSlot(uint32_t slot);
+
+	// ハッシュテーブル（大きさは2のべき乗で、maxCountの2倍以上）
+	std::vector<Slot> slots_;
+	std::vector<Entry> entries_;
+	// 解放して空いている番号
+	std::vector<uint32_t> freeIndices_;
+	uint32_t maxCount_ = 0;
+};
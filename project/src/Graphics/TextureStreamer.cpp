@@ -0,0 +1,286 @@
+#include "TextureStreamer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+// 初期化
+void TextureStreamer::Initialize(TextureStreamingBackend* backend, uint64_t memoryBudget, uint64_t uploadBudget)
+{
+	assert(backend != nullptr);
+	backend_ = backend;
+	memoryBudget_ = memoryBudget;
+	uploadBudget_ = uploadBudget;
+}
+
+// テクスチャを登録し、ミップテールを読み込ませる
+void TextureStreamer::Register(uint32_t textureId, uint32_t width, uint32_t height, const uint64_t* mipSizes, uint32_t mipLevels)
+{
+	assert(mipLevels >= 1);
+	if (textureId >= textures_.size())
+	{
+		textures_.resize(size_t(textureId) + 1);
+	}
+	StreamingTexture& texture = textures_[textureId];
+	assert(!texture.isRegistered);
+
+	texture.width = width;
+	texture.height = height;
+	texture.mipLevels = mipLevels;
+	texture.tailMip = ComputeTailMip(width, height, mipLevels);
+	texture.residentBytes.assign(size_t(mipLevels) + 1, 0);
+	for (uint32_t mip = mipLevels; mip-- > 0;)
+	{
+		texture.residentBytes[mip] = texture.residentBytes[mip + 1] + mipSizes[mip];
+	}
+	texture.residentMip = texture.tailMip;
+	texture.backendMip = texture.tailMip;
+	texture.wantedMip = texture.tailMip;
+	texture.screenSize = 0.0f;
+	texture.reportedSize = 0.0f;
+	texture.lastUsedFrame = frame_;
+	texture.isRegistered = true;
+
+	// ミップテールはメモリの上限に関係なく置く
+	residentBytes_ += texture.residentBytes[texture.residentMip];
+	registeredBytes_ += texture.residentBytes[texture.residentMip];
+	backend_->SetResidentMip(textureId, texture.residentMip);
+}
+
+// Registerで転送するミップテールのバイト数
+uint64_t TextureStreamer::GetMipTailBytes(uint32_t width, uint32_t height, const uint64_t* mipSizes, uint32_t mipLevels)
+{
+	uint64_t bytes = 0;
+	for (uint32_t mip = ComputeTailMip(width, height, mipLevels); mip < mipLevels; ++mip)
+	{
+		bytes += mipSizes[mip];
+	}
+	return bytes;
+}
+
+// 登録を外す
+void TextureStreamer::Unregister(uint32_t textureId)
+{
+	if (!IsRegistered(textureId))
+	{
+		return;
+	}
+	StreamingTexture& texture = textures_[textureId];
+	residentBytes_ -= texture.residentBytes[texture.residentMip];
+	texture.residentBytes.clear();
+	texture.isRegistered = false;
+}
+
+// 描画したテクスチャの画面上の大きさを報告する
+void TextureStreamer::ReportUsage(uint32_t textureId, float screenSize)
+{
+	if (!IsRegistered(textureId))
+	{
+		return;
+	}
+	StreamingTexture& texture = textures_[textureId];
+	texture.reportedSize = (std::max)(texture.reportedSize, screenSize);
+}
+
+// 読み込むミップと捨てるミップを決める
+void TextureStreamer::Update()
+{
+	++frame_;
+	requests_.clear();
+	candidates_.clear();
+	changedTextures_.clear();
+
+	for (uint32_t textureId = 0; textureId < textures_.size(); ++textureId)
+	{
+		StreamingTexture& texture = textures_[textureId];
+		if (!texture.isRegistered)
+		{
+			continue;
+		}
+		// 報告があったフレームの大きさを使い、しばらく報告がなければ使われていないとみなす
+		if (texture.reportedSize > 0.0f)
+		{
+			texture.screenSize = texture.reportedSize;
+			texture.lastUsedFrame = frame_;
+		}
+		else if (frame_ - texture.lastUsedFrame > kUnusedFrameCount)
+		{
+			texture.screenSize = 0.0f;
+		}
+		texture.reportedSize = 0.0f;
+		texture.wantedMip = ComputeWantedMip(texture);
+
+		if (texture.wantedMip < texture.residentMip)
+		{
+			requests_.push_back({ GetMagnification(texture, texture.residentMip), textureId });
+		}
+		if (texture.residentMip < texture.tailMip)
+		{
+			candidates_.push_back({ GetMagnification(texture, texture.residentMip + 1), textureId, texture.residentMip });
+		}
+	}
+	std::make_heap(requests_.begin(), requests_.end());
+	std::make_heap(candidates_.begin(), candidates_.end());
+
+	// このフレームに転送する量（登録したミップテールと、変えたテクスチャごとに最後に決めたミップから下の合計）
+	uint64_t uploadedBytes = registeredBytes_;
+	registeredBytes_ = 0;
+	// 置くミップを変える（バックエンドに伝えるのは最後にまとめて）
+	const auto setResidentMip = [&](uint32_t textureId, uint32_t mip)
+		{
+			StreamingTexture& texture = textures_[textureId];
+			uploadedBytes -= GetUploadBytes(texture);
+			residentBytes_ = residentBytes_ - texture.residentBytes[texture.residentMip] + texture.residentBytes[mip];
+			texture.residentMip = mip;
+			uploadedBytes += GetUploadBytes(texture);
+			changedTextures_.push_back(textureId);
+		};
+	// textureをmipにしたときのuploadedBytes
+	const auto getUploadedBytesAfter = [&](const StreamingTexture& texture, uint32_t mip)
+		{
+			return uploadedBytes - GetUploadBytes(texture) + (mip != texture.backendMip ? texture.residentBytes[mip] : 0);
+		};
+
+	// 捨てたときの拡大率がmaxCostより十分小さいテクスチャの、一番細かいミップを1つ捨てる（捨てられなければfalse）
+	// 捨てても残りのミップを転送し直すので、reservedBytes（このあとの読み込みの分）と合わせて転送の上限に入るものだけ
+	// 何も転送しないフレームにならないように、このフレームにほかの転送（登録したミップテールも含む）がなければ1つは上限を超えてもよい
+	const auto evictOne = [&](float maxCost, uint64_t reservedBytes)
+		{
+			while (!candidates_.empty())
+			{
+				std::pop_heap(candidates_.begin(), candidates_.end());
+				const EvictCandidate candidate = candidates_.back();
+				StreamingTexture& texture = textures_[candidate.textureId];
+				// 候補にしてから読み込んだり捨てたりしたものは古い候補
+				if (!texture.isRegistered || texture.residentMip != candidate.residentMip)
+				{
+					candidates_.pop_back();
+					continue;
+				}
+				// 一番安い候補でも足りなければ捨てない
+				const bool isTooExpensive = candidate.cost * kEvictHysteresis >= maxCost;
+				const bool isOverUploadBudget = uploadedBytes + reservedBytes > 0 &&
+					getUploadedBytesAfter(texture, texture.residentMip + 1) + reservedBytes > uploadBudget_;
+				if (isTooExpensive || isOverUploadBudget)
+				{
+					std::push_heap(candidates_.begin(), candidates_.end());
+					return false;
+				}
+				candidates_.pop_back();
+
+				evictions_.push_back(candidate);
+				setResidentMip(candidate.textureId, texture.residentMip + 1);
+				if (texture.residentMip < texture.tailMip)
+				{
+					candidates_.push_back({ GetMagnification(texture, texture.residentMip + 1), candidate.textureId, texture.residentMip });
+					std::push_heap(candidates_.begin(), candidates_.end());
+				}
+				return true;
+			}
+			return false;
+		};
+
+	// 上限を下げたときなどは、超えている分を安いものから捨てる（転送の上限を超える分は次のUpdateに回す）
+	while (residentBytes_ > memoryBudget_ && evictOne(std::numeric_limits<float>::infinity(), 0))
+	{
+	}
+
+	// ぼやけて見えているものから読み込む
+	while (!requests_.empty())
+	{
+		std::pop_heap(requests_.begin(), requests_.end());
+		const StreamRequest request = requests_.back();
+		requests_.pop_back();
+		StreamingTexture& texture = textures_[request.textureId];
+
+		// 欲しいミップまで入らなければ、1段ずつ粗くして試す
+		for (uint32_t targetMip = texture.wantedMip; targetMip < texture.residentMip; ++targetMip)
+		{
+			// 読み込みは置いているミップも含めて作り直すので、転送量はtargetMipから下の合計
+			const uint64_t uploadedBytesAfter = getUploadedBytesAfter(texture, targetMip);
+			if (uploadedBytes > 0 && uploadedBytesAfter > uploadBudget_)
+			{
+				continue;
+			}
+
+			// 入るまで安いものから捨ててみて、それでも入らなければ捨てたものを元に戻す
+			// バックエンドに伝えるのは最後なので、戻したものは転送も解放もされない
+			const uint64_t addedBytes = texture.residentBytes[targetMip] - texture.residentBytes[texture.residentMip];
+			const uint64_t reservedBytes = uploadedBytesAfter - uploadedBytes;
+			evictions_.clear();
+			while (residentBytes_ + addedBytes > memoryBudget_ && evictOne(request.priority, reservedBytes))
+			{
+			}
+			if (residentBytes_ + addedBytes > memoryBudget_)
+			{
+				for (auto eviction = evictions_.rbegin(); eviction != evictions_.rend(); ++eviction)
+				{
+					setResidentMip(eviction->textureId, eviction->residentMip);
+					candidates_.push_back(*eviction);
+					std::push_heap(candidates_.begin(), candidates_.end());
+				}
+				continue;
+			}
+
+			setResidentMip(request.textureId, targetMip);
+			// 読み込んだものも、もっと大事なテクスチャのためなら捨てられる
+			if (texture.residentMip < texture.tailMip)
+			{
+				candidates_.push_back({ GetMagnification(texture, texture.residentMip + 1), request.textureId, texture.residentMip });
+				std::push_heap(candidates_.begin(), candidates_.end());
+			}
+			break;
+		}
+	}
+
+	// 読み込みと解放は、同じテクスチャを何度か変えても最後の状態だけを伝える（元に戻ったものは伝えない）
+	std::sort(changedTextures_.begin(), changedTextures_.end());
+	changedTextures_.erase(std::unique(changedTextures_.begin(), changedTextures_.end()), changedTextures_.end());
+	for (uint32_t textureId : changedTextures_)
+	{
+		StreamingTexture& texture = textures_[textureId];
+		if (texture.residentMip == texture.backendMip)
+		{
+			continue;
+		}
+		texture.backendMip = texture.residentMip;
+		backend_->SetResidentMip(textureId, texture.residentMip);
+	}
+}
+
+// ミップテールの始まり
+uint32_t TextureStreamer::ComputeTailMip(uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+	uint32_t tailMip = 0;
+	while (tailMip + 1 < mipLevels && (std::max)(width >> tailMip, height >> tailMip) > kMipTailSize)
+	{
+		++tailMip;
+	}
+	return tailMip;
+}
+
+// このUpdateでバックエンドが転送する量
+uint64_t TextureStreamer::GetUploadBytes(const StreamingTexture& texture)
+{
+	return texture.residentMip != texture.backendMip ? texture.residentBytes[texture.residentMip] : 0;
+}
+
+// mipを表示したときの拡大率
+float TextureStreamer::GetMagnification(const StreamingTexture& texture, uint32_t mip)
+{
+	const uint32_t mipSize = (std::max)(1u, (std::max)(texture.width, texture.height) >> mip);
+	return texture.screenSize / static_cast<float>(mipSize);
+}
+
+// 画面上の大きさに足りる一番粗いミップ
+uint32_t TextureStreamer::ComputeWantedMip(const StreamingTexture& texture)
+{
+	if (texture.screenSize <= 0.0f)
+	{
+		return texture.tailMip;
+	}
+	// 画面の画素数以上の大きさがある一番小さいミップ
+	const float ratio = static_cast<float>((std::max)(texture.width, texture.height)) / texture.screenSize;
+	const uint32_t mip = ratio > 1.0f ? static_cast<uint32_t>(std::floor(std::log2(ratio))) : 0;
+	return (std::min)(mip, texture.tailMip);
+}
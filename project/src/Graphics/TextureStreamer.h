@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// テクスチャのミップを実際に読み込む・捨てる側（D3D12ではTextureManager。確かめるときはCPUだけの偽物に差し替えられる）
+class TextureStreamingBackend
+{
+public:
+	virtual ~TextureStreamingBackend() = default;
+
+	// mostDetailedMipから一番小さいミップまでだけを持つようにする（増やすときは転送、減らすときは解放）
+	virtual void SetResidentMip(uint32_t textureId, uint32_t mostDetailedMip) = 0;
+};
+
+// ミップ単位のテクスチャのストリーミング
+// 最初は小さいミップ（ミップテール）だけを置き、描画が報告した画面上の大きさに応じて細かいミップを足す
+// メモリの上限を超えるときは、使われていない・画面上で小さいテクスチャの細かいミップから捨てる
+class TextureStreamer
+{
+public:
+	// これ以下の大きさ（幅と高さの大きい方）のミップは常に置いておく
+	static constexpr uint32_t kMipTailSize = 64;
+	// この間報告がなければ使われていないとみなす（フレーム数）
+	static constexpr uint32_t kUnusedFrameCount = 60;
+	// 捨てる側の拡大率がこの割合より小さいときだけ、ほかのテクスチャのために捨てる（行ったり来たりしないように）
+	static constexpr float kEvictHysteresis = 2.0f;
+
+	// 初期化（memoryBudgetは置いておくミップの合計、uploadBudgetは1フレームに転送する量の上限）
+	// ミップを変えるとバックエンドは残すミップを全部転送し直すので、捨てるときの転送もuploadBudgetに含める
+	// 前のUpdateからRegisterしたミップテールの転送も、次のUpdateまでの1フレーム分としてuploadBudgetに含める
+	void Initialize(TextureStreamingBackend* backend, uint64_t memoryBudget, uint64_t uploadBudget);
+
+	// テクスチャを登録し、ミップテールを読み込ませる（mipSizesはミップごとのバイト数。番号は呼ぶ側が決める）
+	// 今フレームの転送の上限に入るかは、呼ぶ側がGetMipTailBytesとHasUploadBudgetで確かめる
+	void Register(uint32_t textureId, uint32_t width, uint32_t height, const uint64_t* mipSizes, uint32_t mipLevels);
+	// Registerで転送するミップテールのバイト数
+	static uint64_t GetMipTailBytes(uint32_t width, uint32_t height, const uint64_t* mipSizes, uint32_t mipLevels);
+	// 今フレームにあとbytesを転送しても上限に入るか（まだ何も転送していなければ、上限より大きくても転送する）
+	bool HasUploadBudget(uint64_t bytes) const { return registeredBytes_ == 0 || registeredBytes_ + bytes <= uploadBudget_; }
+	// 登録を外す（読み込んでいたミップは呼ぶ側で解放する）
+	void Unregister(uint32_t textureId);
+
+	// 描画したテクスチャの画面上の大きさ（テクスチャ全体が覆う画素数。幅と高さの大きい方）を報告する
+	// 1フレームに何度報告してもよく、一番大きいものを使う
+	void ReportUsage(uint32_t textureId, float screenSize);
+	// 報告をもとに読み込むミップと捨てるミップを決める（1フレームに1回呼ぶ）
+	void Update();
+
+	// memoryBudgetの変更（減らしたときは次のUpdateから、転送の上限に入る分ずつ捨てる）
+	void SetMemoryBudget(uint64_t memoryBudget) { memoryBudget_ = memoryBudget; }
+
+	// getter
+	bool IsRegistered(uint32_t textureId) const { return textureId < textures_.size() && textures_[textureId].isRegistered; }
+	uint32_t GetResidentMip(uint32_t textureId) const { return textures_[textureId].residentMip; }
+	uint32_t GetWantedMip(uint32_t textureId) const { return textures_[textureId].wantedMip; }
+	uint64_t GetResidentBytes() const { return residentBytes_; }
+	uint64_t GetMemoryBudget() const { return memoryBudget_; }
+
+private:
+	// テクスチャ1枚分の状態
+	struct StreamingTexture
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 0;
+		uint32_t tailMip = 0; // これより小さいミップは常に置く
+		uint32_t residentMip = 0; // 置いている一番細かいミップ
+		uint32_t backendMip = 0; // バックエンドに最後に伝えたミップ（residentMipと違えば、このUpdateで転送する）
+		uint32_t wantedMip = 0; // 画面上の大きさから決めたミップ
+		float screenSize = 0.0f; // 最後に報告された大きさ
+		float reportedSize = 0.0f; // 今のフレームに報告された大きさ
+		uint64_t lastUsedFrame = 0;
+		std::vector<uint64_t> residentBytes; // ミップnから一番小さいミップまでの合計（添字はn）
+		bool isRegistered = false;
+	};
+
+	// 読み込みの要求（拡大率が大きい＝ぼやけて見えているものほど先に）
+	struct StreamRequest
+	{
+		float priority;
+		uint32_t textureId;
+		bool operator<(const StreamRequest& other) const { return priority < other.priority; }
+	};
+	// 捨てる候補（細かいミップを1つ捨てたときの拡大率が小さいものほど先に）
+	struct EvictCandidate
+	{
+		float cost;
+		uint32_t textureId;
+		uint32_t residentMip; // 候補にしたときの状態（変わっていたら古い候補）
+		bool operator<(const EvictCandidate& other) const { return cost > other.cost; }
+	};
+
+	// ミップテールの始まり（幅と高さがkMipTailSize以下になる最初のミップ。足りなければ一番小さいミップ）
+	static uint32_t ComputeTailMip(uint32_t width, uint32_t height, uint32_t mipLevels);
+	// このUpdateでバックエンドが転送する量（residentMipを伝えると、そこから下のミップを全部転送する）
+	static uint64_t GetUploadBytes(const StreamingTexture& texture);
+	// mipを表示したときの拡大率（画面の画素数÷ミップの画素数。1を超えるとぼやける）
+	static float GetMagnification(const StreamingTexture& texture, uint32_t mip);
+	// 画面上の大きさに足りる一番粗いミップ
+	static uint32_t ComputeWantedMip(const StreamingTexture& texture);
+
+	TextureStreamingBackend* backend_ = nullptr;
+	std::vector<StreamingTexture> textures_;
+	uint64_t memoryBudget_ = 0;
+	uint64_t uploadBudget_ = 0;
+	uint64_t residentBytes_ = 0;
+	// 前のUpdateからRegisterで転送した量（次のUpdateの転送の上限から引く）
+	uint64_t registeredBytes_ = 0;
+	uint64_t frame_ = 0;
+	// 使い回す作業用の配列
+	std::vector<StreamRequest> requests_;
+	std::vector<EvictCandidate> candidates_;
+	std::vector<EvictCandidate> evictions_; // 1つの読み込みのために捨てたもの（入らなければ元に戻す）
+	std::vector<uint32_t> changedTextures_;
+};
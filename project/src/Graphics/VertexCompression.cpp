@@ -0,0 +1,244 @@
+#include "VertexCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	// 量子化の最大値（16bit UNORM）
+	constexpr float kUnormMax = 65535.0f;
+	// 八面体写像の最大値（16bit SNORM）
+	constexpr float kSnormMax = 32767.0f;
+
+	// 量子化の範囲（大きさ0の軸は1として扱う）
+	inline Vector3 GetQuantizeExtent(const AABB& bounds)
+	{
+		const Vector3 extent = bounds.max - bounds.min;
+		return { extent.x > 0.0f ? extent.x : 1.0f, extent.y > 0.0f ? extent.y : 1.0f, extent.z > 0.0f ? extent.z : 1.0f };
+	}
+
+	inline uint16_t QuantizeUnorm(float value)
+	{
+		return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * kUnormMax));
+	}
+
+	inline float SignNotZero(float value)
+	{
+		return value >= 0.0f ? 1.0f : -1.0f;
+	}
+
+	// 2つの単位ベクトルのなす角（小さい角度でも精度が落ちないようにatan2で求める）
+	inline float AngleBetween(const Vector3& a, const Vector3& b)
+	{
+		return std::atan2(VectorMath::Length(VectorMath::Cross(a, b)), VectorMath::Dot(a, b));
+	}
+}
+
+// 半精度浮動小数点数へ
+uint16_t VertexCompression::FloatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	const uint32_t absolute = bits & 0x7FFFFFFF;
+
+	// 無限大とNaN
+	if (absolute >= 0x7F800000)
+	{
+		return static_cast<uint16_t>(sign | (absolute > 0x7F800000 ? 0x7E00 : 0x7C00));
+	}
+	// 半精度で表せない大きさは無限大
+	if (absolute >= 0x477FF000)
+	{
+		return static_cast<uint16_t>(sign | 0x7C00);
+	}
+	// 非正規化数（2^-24単位に丸める）
+	if (absolute < 0x38800000)
+	{
+		float magnitude;
+		std::memcpy(&magnitude, &absolute, sizeof(magnitude));
+		return static_cast<uint16_t>(sign | static_cast<uint16_t>(std::nearbyint(magnitude * 16777216.0f)));
+	}
+	// 指数のバイアスを127から15に直し、仮数の下13bitを最近接偶数に丸める
+	const uint32_t rebiased = absolute - 0x38000000;
+	return static_cast<uint16_t>(sign | ((rebiased + 0x0FFF + ((rebiased >> 13) & 1)) >> 13));
+}
+
+// 半精度浮動小数点数から
+float VertexCompression::HalfToFloat(uint16_t value)
+{
+	const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1F;
+	const uint32_t mantissa = value & 0x3FF;
+	uint32_t bits;
+	if (exponent == 0)
+	{
+		// 非正規化数と0
+		const float magnitude = float(mantissa) / 16777216.0f;
+		std::memcpy(&bits, &magnitude, sizeof(bits));
+		bits |= sign;
+	}
+	else if (exponent == 31)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	float result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+// 法線を八面体に写して2つの16bitに詰める
+// 単位球を|x|+|y|+|z|=1の八面体に写し、下半分を折り返して[-1,1]の正方形に広げる
+void VertexCompression::EncodeOctahedral(const Vector3& normal, int16_t encoded[2])
+{
+	const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	float x = 0.0f;
+	float y = 0.0f;
+	if (length > 0.0f)
+	{
+		x = normal.x / length;
+		y = normal.y / length;
+		if (normal.z < 0.0f)
+		{
+			const float foldedX = (1.0f - std::abs(y)) * SignNotZero(x);
+			const float foldedY = (1.0f - std::abs(x)) * SignNotZero(y);
+			x = foldedX;
+			y = foldedY;
+		}
+	}
+	x = std::clamp(x, -1.0f, 1.0f) * kSnormMax;
+	y = std::clamp(y, -1.0f, 1.0f) * kSnormMax;
+
+	// 四捨五入が一番近いとは限らないので、切り捨てと切り上げの4通りから復元後の向きが一番近いものを選ぶ
+	const Vector3 target = VectorMath::Normalize(normal);
+	float bestAngle = 4.0f;
+	for (int32_t candidate = 0; candidate < 4; ++candidate)
+	{
+		const int16_t trial[2] = {
+			static_cast<int16_t>((candidate & 1) ? std::ceil(x) : std::floor(x)),
+			static_cast<int16_t>((candidate & 2) ? std::ceil(y) : std::floor(y)) };
+		const float angle = AngleBetween(DecodeOctahedral(trial), target);
+		if (angle < bestAngle)
+		{
+			bestAngle = angle;
+			encoded[0] = trial[0];
+			encoded[1] = trial[1];
+		}
+	}
+}
+
+// 八面体写像から法線へ（シェーダーのDecodeOctahedralと同じ計算）
+Vector3 VertexCompression::DecodeOctahedral(const int16_t encoded[2])
+{
+	// SNORMは-32768も-1になる
+	const float x = (std::max)(float(encoded[0]) / kSnormMax, -1.0f);
+	const float y = (std::max)(float(encoded[1]) / kSnormMax, -1.0f);
+	Vector3 normal = { x, y, 1.0f - std::abs(x) - std::abs(y) };
+	const float t = (std::max)(-normal.z, 0.0f);
+	normal.x += normal.x >= 0.0f ? -t : t;
+	normal.y += normal.y >= 0.0f ? -t : t;
+	return VectorMath::Normalize(normal);
+}
+
+// 1頂点を圧縮する
+PackedVertexData VertexCompression::Encode(const VertexData& vertex, const AABB& bounds, VertexFormat format)
+{
+	PackedVertexData packed = {};
+	if (format == VertexFormat::PackedQuantized)
+	{
+		const Vector3 extent = GetQuantizeExtent(bounds);
+		packed.position[0] = QuantizeUnorm((vertex.position.x - bounds.min.x) / extent.x);
+		packed.position[1] = QuantizeUnorm((vertex.position.y - bounds.min.y) / extent.y);
+		packed.position[2] = QuantizeUnorm((vertex.position.z - bounds.min.z) / extent.z);
+		packed.position[3] = QuantizeUnorm(1.0f);
+	}
+	else
+	{
+		packed.position[0] = FloatToHalf(vertex.position.x);
+		packed.position[1] = FloatToHalf(vertex.position.y);
+		packed.position[2] = FloatToHalf(vertex.position.z);
+		packed.position[3] = FloatToHalf(1.0f);
+	}
+	packed.texcoord[0] = FloatToHalf(vertex.texcoord.x);
+	packed.texcoord[1] = FloatToHalf(vertex.texcoord.y);
+	EncodeOctahedral(vertex.normal, packed.normal);
+	return packed;
+}
+
+// 1頂点を復元する
+VertexData VertexCompression::Decode(const PackedVertexData& vertex, const AABB& bounds, VertexFormat format)
+{
+	VertexData result = {};
+	if (format == VertexFormat::PackedQuantized)
+	{
+		const Vector3 extent = GetQuantizeExtent(bounds);
+		result.position.x = bounds.min.x + float(vertex.position[0]) / kUnormMax * extent.x;
+		result.position.y = bounds.min.y + float(vertex.position[1]) / kUnormMax * extent.y;
+		result.position.z = bounds.min.z + float(vertex.position[2]) / kUnormMax * extent.z;
+	}
+	else
+	{
+		result.position.x = HalfToFloat(vertex.position[0]);
+		result.position.y = HalfToFloat(vertex.position[1]);
+		result.position.z = HalfToFloat(vertex.position[2]);
+	}
+	result.position.w = 1.0f;
+	result.texcoord.x = HalfToFloat(vertex.texcoord[0]);
+	result.texcoord.y = HalfToFloat(vertex.texcoord[1]);
+	result.normal = DecodeOctahedral(vertex.normal);
+	return result;
+}
+
+// まとめて圧縮する
+void VertexCompression::EncodeVertices(const VertexData* vertices, size_t count, const AABB& bounds, VertexFormat format, PackedVertexData* destination)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		destination[i] = Encode(vertices[i], bounds, format);
+	}
+}
+
+// 元の頂点と比べた誤差
+VertexCompressionError VertexCompression::MeasureError(const VertexData* vertices, const PackedVertexData* packed, size_t count, const AABB& bounds, VertexFormat format)
+{
+	VertexCompressionError error = {};
+	float maxNormalAngle = 0.0f;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const VertexData decoded = Decode(packed[i], bounds, format);
+		const Vector3 positionDifference = {
+			decoded.position.x - vertices[i].position.x,
+			decoded.position.y - vertices[i].position.y,
+			decoded.position.z - vertices[i].position.z };
+		error.maxPositionError = (std::max)(error.maxPositionError, VectorMath::Length(positionDifference));
+		error.maxTexcoordError = (std::max)(error.maxTexcoordError, (std::max)(
+			std::abs(decoded.texcoord.x - vertices[i].texcoord.x),
+			std::abs(decoded.texcoord.y - vertices[i].texcoord.y)));
+		// 長さ0の法線（objに法線がない場合）は比べない
+		if (VectorMath::LengthSquared(vertices[i].normal) > 0.0f)
+		{
+			maxNormalAngle = (std::max)(maxNormalAngle, AngleBetween(decoded.normal, VectorMath::Normalize(vertices[i].normal)));
+		}
+	}
+	error.maxNormalErrorDegrees = maxNormalAngle * 180.0f / 3.14159265f;
+	return error;
+}
+
+// 量子化した位置を元に戻す行列
+// position = min + q * extent を行ベクトルの変換として表す
+Matrix4x4 VertexCompression::MakeDequantizeMatrix(const AABB& bounds, VertexFormat format)
+{
+	if (format != VertexFormat::PackedQuantized)
+	{
+		return MatrixMath::MakeIdentity4x4();
+	}
+	Matrix4x4 result = MatrixMath::MakeScale(GetQuantizeExtent(bounds));
+	result.m[3][0] = bounds.min.x;
+	result.m[3][1] = bounds.min.y;
+	result.m[3][2] = bounds.min.z;
+	return result;
+}
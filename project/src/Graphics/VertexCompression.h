@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "VertexData.h"
+#include "Culling.h"
+#include "Matrix4x4.h"
+
+// 圧縮による誤差
+struct VertexCompressionError
+{
+	float maxPositionError; // 位置の誤差の最大（モデルのローカル空間の距離）
+	float maxTexcoordError; // UVの誤差の最大
+	float maxNormalErrorDegrees; // 法線の角度の誤差の最大（度）
+};
+
+// 頂点データの圧縮と復元
+// GPUで読む頂点バッファを小さくするためのもので、復元はシェーダーと同じ計算をCPUでも行えるようにしておく
+namespace VertexCompression
+{
+	// 半精度浮動小数点数（最近接偶数への丸め）
+	uint16_t FloatToHalf(float value);
+	float HalfToFloat(uint16_t value);
+
+	// 法線を八面体に写して2つの16bitに詰める
+	// 復元した向きの誤差は0.04度以下（MathBenchmarkの--checkで100万個のランダムな法線について確かめる）
+	void EncodeOctahedral(const Vector3& normal, int16_t encoded[2]);
+	Vector3 DecodeOctahedral(const int16_t encoded[2]);
+
+	// 1頂点の圧縮と復元（boundsはPackedQuantizedで位置を量子化する範囲）
+	PackedVertexData Encode(const VertexData& vertex, const AABB& bounds, VertexFormat format);
+	VertexData Decode(const PackedVertexData& vertex, const AABB& bounds, VertexFormat format);
+
+	// まとめて圧縮する
+	void EncodeVertices(const VertexData* vertices, size_t count, const AABB& bounds, VertexFormat format, PackedVertexData* destination);
+	// 元の頂点と比べた誤差
+	VertexCompressionError MeasureError(const VertexData* vertices, const PackedVertexData* packed, size_t count, const AABB& bounds, VertexFormat format);
+
+	// 量子化した位置を元に戻す行列（world行列の前に掛ける。PackedQuantized以外は単位行列）
+	Matrix4x4 MakeDequantizeMatrix(const AABB& bounds, VertexFormat format);
+	// 頂点1つのバイト数
+	inline uint32_t GetVertexStride(VertexFormat format)
+	{
+		return static_cast<uint32_t>(format == VertexFormat::Float ? sizeof(VertexData) : sizeof(PackedVertexData));
+	}
+}
@@ -1,4 +1,7 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+
 #include "Vector4.h"
 #include "Vector3.h"
 #include "Vector2.h"
@@ -7,6 +10,25 @@
 // 頂点データの拡張
 struct VertexData
 {
-	Vector4 position;
-	Vector2 texcoord;
+	Vector4 position; // 頂点座標
+	Vector2 texcoord; // テクスチャ座標
+	Vector3 normal; // 法線
+};
+
+// 頂点バッファの形式
+enum class VertexFormat
+{
+	Float, // VertexDataのまま
+	PackedQuantized, // PackedVertexData（位置はメッシュのAABBに対して16bitに量子化）
+	PackedHalf, // PackedVertexData（位置は半精度浮動小数点数）
+};
+constexpr size_t kVertexFormatCount = 3;
+
+// 圧縮した頂点データ（16バイト）
+struct PackedVertexData
+{
+	uint16_t position[4]; // R16G16B16A16_UNORM か R16G16B16A16_FLOAT（wは1）
+	uint16_t texcoord[2]; // R16G16_FLOAT
+	int16_t normal[2]; // R16G16_SNORM（八面体写像）
 };
+static_assert(sizeof(PackedVertexData) == 16);
@@ -0,0 +1,296 @@
+#include "Culling.h"
+#include "MathSIMD.h"
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+	// 行列のcol列目を取り出す
+	inline void GetColumn(const Matrix4x4& m, int col, float (&out)[4])
+	{
+		out[0] = m.m[0][col];
+		out[1] = m.m[1][col];
+		out[2] = m.m[2][col];
+		out[3] = m.m[3][col];
+	}
+
+	// 係数から正規化した平面を作る
+	inline Plane MakePlane(float a, float b, float c, float d)
+	{
+		const float length = std::sqrt(a * a + b * b + c * c);
+		const float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+		return { { a * invLength, b * invLength, c * invLength }, d * invLength };
+	}
+
+	// 平面までの符号付き距離
+	inline float Distance(const Plane& plane, float x, float y, float z)
+	{
+		return plane.normal.x * x + plane.normal.y * y + plane.normal.z * z + plane.distance;
+	}
+
+	// AABBが平面の内側に一部でも入っているか
+	inline bool IsInside(const Plane& plane, float cx, float cy, float cz, float ex, float ey, float ez)
+	{
+		const float radius = std::fabs(plane.normal.x) * ex + std::fabs(plane.normal.y) * ey + std::fabs(plane.normal.z) * ez;
+		return Distance(plane, cx, cy, cz) + radius >= 0.0f;
+	}
+}
+
+// 視錐台の平面を取り出す
+Frustum Culling::ExtractFrustum(const Matrix4x4& viewProjection)
+{
+	// 行ベクトル規約なので clip = p * M の各成分は行列の列との内積になる
+	float c0[4], c1[4], c2[4], c3[4];
+	GetColumn(viewProjection, 0, c0);
+	GetColumn(viewProjection, 1, c1);
+	GetColumn(viewProjection, 2, c2);
+	GetColumn(viewProjection, 3, c3);
+
+	Frustum frustum;
+	// 左 (x >= -w)
+	frustum.planes[0] = MakePlane(c3[0] + c0[0], c3[1] + c0[1], c3[2] + c0[2], c3[3] + c0[3]);
+	// 右 (x <= w)
+	frustum.planes[1] = MakePlane(c3[0] - c0[0], c3[1] - c0[1], c3[2] - c0[2], c3[3] - c0[3]);
+	// 下 (y >= -w)
+	frustum.planes[2] = MakePlane(c3[0] + c1[0], c3[1] + c1[1], c3[2] + c1[2], c3[3] + c1[3]);
+	// 上 (y <= w)
+	frustum.planes[3] = MakePlane(c3[0] - c1[0], c3[1] - c1[1], c3[2] - c1[2], c3[3] - c1[3]);
+	// 近 (z >= 0)
+	frustum.planes[4] = MakePlane(c2[0], c2[1], c2[2], c2[3]);
+	// 遠 (z <= w)
+	frustum.planes[5] = MakePlane(c3[0] - c2[0], c3[1] - c2[1], c3[2] - c2[2], c3[3] - c2[3]);
+	return frustum;
+}
+
+// 頂点列を包むAABB
+AABB Culling::ComputeAABB(const Vector3* points, size_t count, size_t stride)
+{
+	if (count == 0)
+	{
+		return { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+	}
+
+	AABB result = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+	const char* bytes = reinterpret_cast<const char*>(points);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Vector3& point = *reinterpret_cast<const Vector3*>(bytes + i * stride);
+		result.min = VectorMath::Min(result.min, point);
+		result.max = VectorMath::Max(result.max, point);
+	}
+	return result;
+}
+
+// AABBを行列で変換したものを包むAABB
+AABB Culling::TransformAABB(const AABB& aabb, const Matrix4x4& m)
+{
+	const Vector3 center = (aabb.min + aabb.max) * 0.5f;
+	const Vector3 extent = (aabb.max - aabb.min) * 0.5f;
+
+	// 中心はそのまま変換し、大きさは行列の絶対値で広げる
+	const Vector3 newCenter = MatrixMath::TransformNormal(center, m) + Vector3{ m.m[3][0], m.m[3][1], m.m[3][2] };
+	const Vector3 newExtent =
+	{
+		std::fabs(m.m[0][0]) * extent.x + std::fabs(m.m[1][0]) * extent.y + std::fabs(m.m[2][0]) * extent.z,
+		std::fabs(m.m[0][1]) * extent.x + std::fabs(m.m[1][1]) * extent.y + std::fabs(m.m[2][1]) * extent.z,
+		std::fabs(m.m[0][2]) * extent.x + std::fabs(m.m[1][2]) * extent.y + std::fabs(m.m[2][2]) * extent.z
+	};
+	return { newCenter - newExtent, newCenter + newExtent };
+}
+
+// 視錐台とAABBの判定
+bool Culling::IsVisible(const Frustum& frustum, const AABB& aabb)
+{
+	const Vector3 center = (aabb.min + aabb.max) * 0.5f;
+	const Vector3 extent = (aabb.max - aabb.min) * 0.5f;
+	for (const Plane& plane : frustum.planes)
+	{
+		if (!IsInside(plane, center.x, center.y, center.z, extent.x, extent.y, extent.z))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// 視錐台と境界球の判定
+bool Culling::IsVisible(const Frustum& frustum, const Sphere& sphere)
+{
+	for (const Plane& plane : frustum.planes)
+	{
+		if (Distance(plane, sphere.center.x, sphere.center.y, sphere.center.z) + sphere.radius < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// AABBをまとめて判定
+size_t Culling::CullAABBs(const Frustum& frustum, const AABBSoA& aabbs, size_t count, uint32_t* visibleIndices)
+{
+	assert(count == 0 || visibleIndices);
+
+	size_t visibleCount = 0;
+	size_t i = 0;
+
+#if defined(MATH_SIMD_AVX2)
+	// 8個ずつ判定する
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256 cx = _mm256_loadu_ps(&aabbs.centerX[i]);
+		const __m256 cy = _mm256_loadu_ps(&aabbs.centerY[i]);
+		const __m256 cz = _mm256_loadu_ps(&aabbs.centerZ[i]);
+		const __m256 ex = _mm256_loadu_ps(&aabbs.extentX[i]);
+		const __m256 ey = _mm256_loadu_ps(&aabbs.extentY[i]);
+		const __m256 ez = _mm256_loadu_ps(&aabbs.extentZ[i]);
+
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const Plane& plane : frustum.planes)
+		{
+			const __m256 nx = _mm256_set1_ps(plane.normal.x);
+			const __m256 ny = _mm256_set1_ps(plane.normal.y);
+			const __m256 nz = _mm256_set1_ps(plane.normal.z);
+			// 中心の距離 + 平面の法線方向へのAABBの半径
+			__m256 distance = MathSIMD::MultiplyAdd(nx, cx, _mm256_set1_ps(plane.distance));
+			distance = MathSIMD::MultiplyAdd(ny, cy, distance);
+			distance = MathSIMD::MultiplyAdd(nz, cz, distance);
+			distance = MathSIMD::MultiplyAdd(_mm256_set1_ps(std::fabs(plane.normal.x)), ex, distance);
+			distance = MathSIMD::MultiplyAdd(_mm256_set1_ps(std::fabs(plane.normal.y)), ey, distance);
+			distance = MathSIMD::MultiplyAdd(_mm256_set1_ps(std::fabs(plane.normal.z)), ez, distance);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+
+		// 見えているものの番号を分岐なしで詰める
+		const int mask = _mm256_movemask_ps(inside);
+		for (int lane = 0; lane < 8; ++lane)
+		{
+			visibleIndices[visibleCount] = static_cast<uint32_t>(i + lane);
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+#elif defined(MATH_SIMD_SSE)
+	// 4個ずつ判定する
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 cx = _mm_loadu_ps(&aabbs.centerX[i]);
+		const __m128 cy = _mm_loadu_ps(&aabbs.centerY[i]);
+		const __m128 cz = _mm_loadu_ps(&aabbs.centerZ[i]);
+		const __m128 ex = _mm_loadu_ps(&aabbs.extentX[i]);
+		const __m128 ey = _mm_loadu_ps(&aabbs.extentY[i]);
+		const __m128 ez = _mm_loadu_ps(&aabbs.extentZ[i]);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const Plane& plane : frustum.planes)
+		{
+			const __m128 nx = _mm_set1_ps(plane.normal.x);
+			const __m128 ny = _mm_set1_ps(plane.normal.y);
+			const __m128 nz = _mm_set1_ps(plane.normal.z);
+			// 中心の距離 + 平面の法線方向へのAABBの半径
+			__m128 distance = MathSIMD::MultiplyAdd(nx, cx, _mm_set1_ps(plane.distance));
+			distance = MathSIMD::MultiplyAdd(ny, cy, distance);
+			distance = MathSIMD::MultiplyAdd(nz, cz, distance);
+			distance = MathSIMD::MultiplyAdd(_mm_set1_ps(std::fabs(plane.normal.x)), ex, distance);
+			distance = MathSIMD::MultiplyAdd(_mm_set1_ps(std::fabs(plane.normal.y)), ey, distance);
+			distance = MathSIMD::MultiplyAdd(_mm_set1_ps(std::fabs(plane.normal.z)), ez, distance);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+		}
+
+		// 見えているものの番号を分岐なしで詰める
+		const int mask = _mm_movemask_ps(inside);
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			visibleIndices[visibleCount] = static_cast<uint32_t>(i + lane);
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+#endif
+
+	// 残りは1つずつ判定する
+	for (; i < count; ++i)
+	{
+		bool inside = true;
+		for (const Plane& plane : frustum.planes)
+		{
+			inside = inside && IsInside(plane, aabbs.centerX[i], aabbs.centerY[i], aabbs.centerZ[i], aabbs.extentX[i], aabbs.extentY[i], aabbs.extentZ[i]);
+		}
+		visibleIndices[visibleCount] = static_cast<uint32_t>(i);
+		visibleCount += inside ? 1 : 0;
+	}
+
+	return visibleCount;
+}
+
+// 境界球をまとめて判定
+size_t Culling::CullSpheres(const Frustum& frustum, const SphereSoA& spheres, size_t count, uint32_t* visibleIndices)
+{
+	assert(count == 0 || visibleIndices);
+
+	size_t visibleCount = 0;
+	size_t i = 0;
+
+#if defined(MATH_SIMD_AVX2)
+	// 8個ずつ判定する
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256 cx = _mm256_loadu_ps(&spheres.centerX[i]);
+		const __m256 cy = _mm256_loadu_ps(&spheres.centerY[i]);
+		const __m256 cz = _mm256_loadu_ps(&spheres.centerZ[i]);
+		const __m256 radius = _mm256_loadu_ps(&spheres.radius[i]);
+
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const Plane& plane : frustum.planes)
+		{
+			__m256 distance = MathSIMD::MultiplyAdd(_mm256_set1_ps(plane.normal.x), cx, _mm256_set1_ps(plane.distance));
+			distance = MathSIMD::MultiplyAdd(_mm256_set1_ps(plane.normal.y), cy, distance);
+			distance = MathSIMD::MultiplyAdd(_mm256_set1_ps(plane.normal.z), cz, distance);
+			distance = _mm256_add_ps(distance, radius);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+
+		const int mask = _mm256_movemask_ps(inside);
+		for (int lane = 0; lane < 8; ++lane)
+		{
+			visibleIndices[visibleCount] = static_cast<uint32_t>(i + lane);
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+#elif defined(MATH_SIMD_SSE)
+	// 4個ずつ判定する
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 cx = _mm_loadu_ps(&spheres.centerX[i]);
+		const __m128 cy = _mm_loadu_ps(&spheres.centerY[i]);
+		const __m128 cz = _mm_loadu_ps(&spheres.centerZ[i]);
+		const __m128 radius = _mm_loadu_ps(&spheres.radius[i]);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const Plane& plane : frustum.planes)
+		{
+			__m128 distance = MathSIMD::MultiplyAdd(_mm_set1_ps(plane.normal.x), cx, _mm_set1_ps(plane.distance));
+			distance = MathSIMD::MultiplyAdd(_mm_set1_ps(plane.normal.y), cy, distance);
+			distance = MathSIMD::MultiplyAdd(_mm_set1_ps(plane.normal.z), cz, distance);
+			distance = _mm_add_ps(distance, radius);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+		}
+
+		const int mask = _mm_movemask_ps(inside);
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			visibleIndices[visibleCount] = static_cast<uint32_t>(i + lane);
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+#endif
+
+	// 残りは1つずつ判定する
+	for (; i < count; ++i)
+	{
+		const Sphere sphere = { { spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i] }, spheres.radius[i] };
+		visibleIndices[visibleCount] = static_cast<uint32_t>(i);
+		visibleCount += IsVisible(frustum, sphere) ? 1 : 0;
+	}
+
+	return visibleCount;
+}
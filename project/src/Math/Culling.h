@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Vector3.h"
+#include "Matrix4x4.h"
+
+// 平面（dot(normal, p) + distance >= 0 の側を内側とする）
+struct Plane
+{
+	Vector3 normal;
+	float distance;
+};
+
+// 視錐台（左、右、下、上、近、遠の6平面）
+struct Frustum
+{
+	Plane planes[6];
+};
+
+// 軸平行境界ボックス
+struct AABB
+{
+	Vector3 min;
+	Vector3 max;
+};
+
+// 境界球
+struct Sphere
+{
+	Vector3 center;
+	float radius;
+};
+
+// SoA形式のAABB配列（中心と半分の大きさ）
+struct AABBSoA
+{
+	const float* centerX;
+	const float* centerY;
+	const float* centerZ;
+	const float* extentX;
+	const float* extentY;
+	const float* extentZ;
+};
+
+// SoA形式の境界球配列
+struct SphereSoA
+{
+	const float* centerX;
+	const float* centerY;
+	const float* centerZ;
+	const float* radius;
+};
+
+namespace Culling
+{
+	// ビュー射影行列（PerspectiveFov / Orthographic を含む）から視錐台の平面を取り出す
+	// world行列も掛けておけばローカル空間の視錐台になる
+	Frustum ExtractFrustum(const Matrix4x4& viewProjection);
+
+	// 頂点列を包むAABB
+	AABB ComputeAABB(const Vector3* points, size_t count, size_t stride = sizeof(Vector3));
+	// AABBを行列で変換したものを包むAABB
+	AABB TransformAABB(const AABB& aabb, const Matrix4x4& m);
+
+	// 視錐台との判定（一部でも内側にあればtrue）
+	bool IsVisible(const Frustum& frustum, const AABB& aabb);
+	bool IsVisible(const Frustum& frustum, const Sphere& sphere);
+
+	// まとめて判定し、見えているものの番号をvisibleIndicesに詰めて書き込む
+	// visibleIndicesはcount要素分確保しておくこと。戻り値は見えている数
+	size_t CullAABBs(const Frustum& frustum, const AABBSoA& aabbs, size_t count, uint32_t* visibleIndices);
+	size_t CullSpheres(const Frustum& frustum, const SphereSoA& spheres, size_t count, uint32_t* visibleIndices);
+}
@@ -0,0 +1,214 @@
+#include "FastTrig.h"
+#include "MathSIMD.h"
+#include <cassert>
+
+using namespace FastTrig::Detail;
+
+namespace
+{
+#if defined(MATH_SIMD_AVX2)
+	// 8要素すべての象限の絶対値がmaxQuadrant未満か（NaNを含めばfalse）
+	inline bool IsReducible8(__m256 x, float maxQuadrant)
+	{
+		const __m256 scaled = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_mul_ps(x, _mm256_set1_ps(kTwoOverPi)));
+		return _mm256_movemask_ps(_mm256_cmp_ps(scaled, _mm256_set1_ps(maxQuadrant), _CMP_LT_OQ)) == 0xFF;
+	}
+
+	// 8要素分のsin/cos
+	template<TrigPrecision precision>
+	inline void SinCos8(__m256 x, __m256& sine, __m256& cosine)
+	{
+		// 象限（丸めモードは既定の最近接偶数丸め）
+		const __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(kTwoOverPi)));
+		const __m256 q = _mm256_cvtepi32_ps(quadrant);
+
+		__m256 s;
+		__m256 c;
+		if constexpr (precision == TrigPrecision::Precise)
+		{
+			__m256 r = MathSIMD::MultiplyAdd(q, _mm256_set1_ps(-kHalfPiHi), x);
+			r = MathSIMD::MultiplyAdd(q, _mm256_set1_ps(-kHalfPiMid), r);
+			r = MathSIMD::MultiplyAdd(q, _mm256_set1_ps(-kHalfPiLo), r);
+			const __m256 r2 = _mm256_mul_ps(r, r);
+
+			s = MathSIMD::MultiplyAdd(r2, _mm256_set1_ps(kSinP2), _mm256_set1_ps(kSinP1));
+			s = MathSIMD::MultiplyAdd(r2, s, _mm256_set1_ps(kSinP0));
+			s = MathSIMD::MultiplyAdd(_mm256_mul_ps(r, r2), s, r);
+
+			c = MathSIMD::MultiplyAdd(r2, _mm256_set1_ps(kCosP2), _mm256_set1_ps(kCosP1));
+			c = MathSIMD::MultiplyAdd(r2, c, _mm256_set1_ps(kCosP0));
+			c = MathSIMD::MultiplyAdd(_mm256_mul_ps(r2, r2), c, MathSIMD::MultiplyAdd(r2, _mm256_set1_ps(-0.5f), _mm256_set1_ps(1.0f)));
+		}
+		else
+		{
+			const __m256 r = MathSIMD::MultiplyAdd(q, _mm256_set1_ps(-kHalfPi), x);
+			const __m256 r2 = _mm256_mul_ps(r, r);
+
+			s = MathSIMD::MultiplyAdd(r2, _mm256_set1_ps(kSinF1), _mm256_set1_ps(kSinF0));
+			s = MathSIMD::MultiplyAdd(_mm256_mul_ps(r, r2), s, r);
+
+			c = MathSIMD::MultiplyAdd(r2, _mm256_set1_ps(kCosF1), _mm256_set1_ps(kCosF0));
+			c = MathSIMD::MultiplyAdd(r2, c, _mm256_set1_ps(1.0f));
+		}
+
+		// 奇数象限ではsinとcosを入れ替える
+		const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+		const __m256 sineAbs = _mm256_blendv_ps(s, c, swap);
+		const __m256 cosineAbs = _mm256_blendv_ps(c, s, swap);
+
+		// 象限の2ビット目で符号が決まる（cosは1象限ずらす）
+		const __m256 sineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+		const __m256 cosineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+		sine = _mm256_xor_ps(sineAbs, sineSign);
+		cosine = _mm256_xor_ps(cosineAbs, cosineSign);
+	}
+#elif defined(MATH_SIMD_SSE)
+	// 4要素すべての象限の絶対値がmaxQuadrant未満か（NaNを含めばfalse）
+	inline bool IsReducible4(__m128 x, float maxQuadrant)
+	{
+		const __m128 scaled = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_mul_ps(x, _mm_set1_ps(kTwoOverPi)));
+		return _mm_movemask_ps(_mm_cmplt_ps(scaled, _mm_set1_ps(maxQuadrant))) == 0xF;
+	}
+
+	// 4要素分のsin/cos
+	template<TrigPrecision precision>
+	inline void SinCos4(__m128 x, __m128& sine, __m128& cosine)
+	{
+		// 象限（丸めモードは既定の最近接偶数丸め）
+		const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(kTwoOverPi)));
+		const __m128 q = _mm_cvtepi32_ps(quadrant);
+
+		__m128 s;
+		__m128 c;
+		if constexpr (precision == TrigPrecision::Precise)
+		{
+			__m128 r = MathSIMD::MultiplyAdd(q, _mm_set1_ps(-kHalfPiHi), x);
+			r = MathSIMD::MultiplyAdd(q, _mm_set1_ps(-kHalfPiMid), r);
+			r = MathSIMD::MultiplyAdd(q, _mm_set1_ps(-kHalfPiLo), r);
+			const __m128 r2 = _mm_mul_ps(r, r);
+
+			s = MathSIMD::MultiplyAdd(r2, _mm_set1_ps(kSinP2), _mm_set1_ps(kSinP1));
+			s = MathSIMD::MultiplyAdd(r2, s, _mm_set1_ps(kSinP0));
+			s = MathSIMD::MultiplyAdd(_mm_mul_ps(r, r2), s, r);
+
+			c = MathSIMD::MultiplyAdd(r2, _mm_set1_ps(kCosP2), _mm_set1_ps(kCosP1));
+			c = MathSIMD::MultiplyAdd(r2, c, _mm_set1_ps(kCosP0));
+			c = MathSIMD::MultiplyAdd(_mm_mul_ps(r2, r2), c, MathSIMD::MultiplyAdd(r2, _mm_set1_ps(-0.5f), _mm_set1_ps(1.0f)));
+		}
+		else
+		{
+			const __m128 r = MathSIMD::MultiplyAdd(q, _mm_set1_ps(-kHalfPi), x);
+			const __m128 r2 = _mm_mul_ps(r, r);
+
+			s = MathSIMD::MultiplyAdd(r2, _mm_set1_ps(kSinF1), _mm_set1_ps(kSinF0));
+			s = MathSIMD::MultiplyAdd(_mm_mul_ps(r, r2), s, r);
+
+			c = MathSIMD::MultiplyAdd(r2, _mm_set1_ps(kCosF1), _mm_set1_ps(kCosF0));
+			c = MathSIMD::MultiplyAdd(r2, c, _mm_set1_ps(1.0f));
+		}
+
+		// 奇数象限ではsinとcosを入れ替える（SSE2にはblendvがないのでand/andnot/orで選ぶ）
+		const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+		const __m128 sineAbs = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+		const __m128 cosineAbs = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+
+		// 象限の2ビット目で符号が決まる（cosは1象限ずらす）
+		const __m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+		const __m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+		sine = _mm_xor_ps(sineAbs, sineSign);
+		cosine = _mm_xor_ps(cosineAbs, cosineSign);
+	}
+#endif
+
+	// 近似版のまとめて計算
+	template<TrigPrecision precision>
+	void SinCosBatchKernel(const float* radians, float* sines, float* cosines, size_t count)
+	{
+		// この精度の多項式で計算できる象限の上限（Fastは超えるとPreciseで計算する）
+		constexpr float kMaxPrecisionQuadrant = precision == TrigPrecision::Fast ? kMaxFastQuadrant : kMaxQuadrant;
+		size_t i = 0;
+#if defined(MATH_SIMD_AVX2)
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 x = _mm256_loadu_ps(&radians[i]);
+			// 大きすぎる値が混ざっていれば、その8要素は1つずつ（標準ライブラリで）計算する
+			if (!IsReducible8(x, kMaxQuadrant))
+			{
+				for (size_t j = i; j < i + 8; ++j)
+				{
+					FastTrig::SinCos(radians[j], sines[j], cosines[j], precision);
+				}
+				continue;
+			}
+			__m256 sine;
+			__m256 cosine;
+			// Fastで範囲を超える値が混ざっていれば、その8要素はPreciseで計算する
+			if (IsReducible8(x, kMaxPrecisionQuadrant))
+			{
+				SinCos8<precision>(x, sine, cosine);
+			}
+			else
+			{
+				SinCos8<TrigPrecision::Precise>(x, sine, cosine);
+			}
+			_mm256_storeu_ps(&sines[i], sine);
+			_mm256_storeu_ps(&cosines[i], cosine);
+		}
+#elif defined(MATH_SIMD_SSE)
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(&radians[i]);
+			// 大きすぎる値が混ざっていれば、その4要素は1つずつ（標準ライブラリで）計算する
+			if (!IsReducible4(x, kMaxQuadrant))
+			{
+				for (size_t j = i; j < i + 4; ++j)
+				{
+					FastTrig::SinCos(radians[j], sines[j], cosines[j], precision);
+				}
+				continue;
+			}
+			__m128 sine;
+			__m128 cosine;
+			// Fastで範囲を超える値が混ざっていれば、その4要素はPreciseで計算する
+			if (IsReducible4(x, kMaxPrecisionQuadrant))
+			{
+				SinCos4<precision>(x, sine, cosine);
+			}
+			else
+			{
+				SinCos4<TrigPrecision::Precise>(x, sine, cosine);
+			}
+			_mm_storeu_ps(&sines[i], sine);
+			_mm_storeu_ps(&cosines[i], cosine);
+		}
+#endif
+		// 残りは1つずつ
+		for (; i < count; ++i)
+		{
+			FastTrig::SinCos(radians[i], sines[i], cosines[i], precision);
+		}
+	}
+}
+
+// sinとcosをまとめて求める
+void FastTrig::SinCosBatch(const float* radians, float* sines, float* cosines, size_t count, TrigPrecision precision)
+{
+	assert(count == 0 || (radians && sines && cosines));
+
+	switch (precision)
+	{
+	case TrigPrecision::Exact:
+		for (size_t i = 0; i < count; ++i)
+		{
+			sines[i] = std::sin(radians[i]);
+			cosines[i] = std::cos(radians[i]);
+		}
+		break;
+	case TrigPrecision::Precise:
+		SinCosBatchKernel<TrigPrecision::Precise>(radians, sines, cosines, count);
+		break;
+	case TrigPrecision::Fast:
+		SinCosBatchKernel<TrigPrecision::Fast>(radians, sines, cosines, count);
+		break;
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "MathSIMD.h"
+
+// sin/cosの計算精度（どの関数も既定はExactで、近似は呼ぶ側が選んだときだけ使う）
+enum class TrigPrecision
+{
+	Exact,   // 標準ライブラリ（std::sin / std::cos）
+	Precise, // 多項式近似（誤差 約1e-6、±10万ラジアンまで。超えると標準ライブラリで計算する）
+	Fast,    // 低次の多項式近似（誤差 約1.5e-5、±100ラジアンまで。超えるとPreciseで計算する）
+};
+
+namespace FastTrig
+{
+	namespace Detail
+	{
+		// 2/π
+		constexpr float kTwoOverPi = 0.636619772367581343f;
+		// π/2を3つに分けたもの（Cody-Waite法の範囲縮小で桁落ちを防ぐ）
+		constexpr float kHalfPiHi = 1.5703125f;
+		constexpr float kHalfPiMid = 4.837512969970703125e-4f;
+		constexpr float kHalfPiLo = 7.54978995489188216e-8f;
+		// π/2（Fast用、1回で範囲縮小する）
+		constexpr float kHalfPi = 1.57079632679489662f;
+
+		// [-π/4, π/4] の多項式近似の係数（Precise）
+		constexpr float kSinP0 = -1.6666654611e-1f;
+		constexpr float kSinP1 = 8.3321608736e-3f;
+		constexpr float kSinP2 = -1.9515295891e-4f;
+		constexpr float kCosP0 = 4.166664568298827e-2f;
+		constexpr float kCosP1 = -1.388731625493765e-3f;
+		constexpr float kCosP2 = 2.443315711809948e-5f;
+
+		// [-π/4, π/4] のミニマックス近似の係数（Fast）
+		constexpr float kSinF0 = -1.666283356e-1f;
+		constexpr float kSinF1 = 8.152987436e-3f;
+		constexpr float kCosF0 = -4.997762934e-1f;
+		constexpr float kCosF1 = 4.048890690e-2f;
+
+		// 象限の数（radian * 2/π）の絶対値がこれ以上なら範囲縮小できないので標準ライブラリで計算する
+		// kHalfPiHiは仮数が8bitなので、象限が2^16未満なら q * kHalfPiHi が誤差なく求まる（NaNもこの判定で外れる）
+		constexpr float kMaxQuadrant = 65536.0f;
+		// Fastの範囲縮小はπ/2を1つの定数で引くので、象限が大きいほどπ/2の丸め誤差が積み重なる
+		// 象限の絶対値がこれ以上ならPreciseの範囲縮小と多項式で計算する（±100ラジアン程度。誤差は約1.5e-5に収まる）
+		constexpr float kMaxFastQuadrant = 64.0f;
+
+		// 一番近い整数に丸める（SIMD版の_mm_cvtps_epi32と同じく既定の丸めモードで、ちょうど半分は偶数に丸める）
+		// |x| < kMaxQuadrant であること
+		inline int32_t RoundToInt(float x)
+		{
+#if defined(MATH_SIMD_SSE)
+			return _mm_cvtss_si32(_mm_set_ss(x));
+#else
+			return static_cast<int32_t>(std::nearbyint(x));
+#endif
+		}
+	}
+
+	// sinとcosを同時に求める
+	inline void SinCos(float radian, float& sine, float& cosine, TrigPrecision precision = TrigPrecision::Exact)
+	{
+		using namespace Detail;
+
+		const float scaledRadian = radian * kTwoOverPi;
+		if (precision == TrigPrecision::Fast && !(std::fabs(scaledRadian) < kMaxFastQuadrant))
+		{
+			precision = TrigPrecision::Precise;
+		}
+		if (precision == TrigPrecision::Exact || !(std::fabs(scaledRadian) < kMaxQuadrant))
+		{
+			sine = std::sin(radian);
+			cosine = std::cos(radian);
+			return;
+		}
+
+		// radian = quadrant * π/2 + r （|r| <= π/4）に分解する
+		const int32_t quadrant = RoundToInt(scaledRadian);
+		const float q = static_cast<float>(quadrant);
+		float s;
+		float c;
+		if (precision == TrigPrecision::Precise)
+		{
+			const float r = ((radian - q * kHalfPiHi) - q * kHalfPiMid) - q * kHalfPiLo;
+			const float r2 = r * r;
+			s = r + r * r2 * (kSinP0 + r2 * (kSinP1 + r2 * kSinP2));
+			c = 1.0f - 0.5f * r2 + r2 * r2 * (kCosP0 + r2 * (kCosP1 + r2 * kCosP2));
+		}
+		else
+		{
+			const float r = radian - q * kHalfPi;
+			const float r2 = r * r;
+			s = r + r * r2 * (kSinF0 + r2 * kSinF1);
+			c = 1.0f + r2 * (kCosF0 + r2 * kCosF1);
+		}
+
+		// 象限に合わせて入れ替えと符号反転を行う
+		switch (quadrant & 3)
+		{
+		case 0: sine = s;  cosine = c;  break;
+		case 1: sine = c;  cosine = -s; break;
+		case 2: sine = -s; cosine = -c; break;
+		default: sine = -c; cosine = s; break;
+		}
+	}
+
+	// sinとcosをまとめて求める（sines[i] = sin(radians[i]), cosines[i] = cos(radians[i])）
+	void SinCosBatch(const float* radians, float* sines, float* cosines, size_t count, TrigPrecision precision = TrigPrecision::Exact);
+}
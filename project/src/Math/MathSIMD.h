@@ -0,0 +1,67 @@
+#pragma once
+
+// SIMD命令セットの選択（コンパイル時に決定）
+// /arch:AVX2 (MSVC) や -mavx2 -mfma (GCC/Clang) を指定するとAVX2版が有効になる
+// x64ではSSE2は常に利用できるため、最低でもSSE版が選ばれる
+// MATH_FORCE_SCALAR を定義するとスカラー版を強制する
+#if !defined(MATH_FORCE_SCALAR) && defined(__AVX2__)
+#define MATH_SIMD_AVX2 1
+#define MATH_SIMD_SSE 1
+#elif !defined(MATH_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MATH_SIMD_SSE 1
+#endif
+
+// FMA命令はMSVCの/arch:AVX2では常に有効、GCC/Clangでは-mfmaの指定が必要
+#if defined(MATH_SIMD_AVX2) && (defined(__FMA__) || defined(_MSC_VER))
+#define MATH_SIMD_FMA 1
+#endif
+
+#if defined(MATH_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(MATH_SIMD_SSE)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#endif
+
+namespace MathSIMD
+{
+	// 一度に処理できるfloatの数
+#if defined(MATH_SIMD_AVX2)
+	constexpr int kWidth = 8;
+#elif defined(MATH_SIMD_SSE)
+	constexpr int kWidth = 4;
+#else
+	constexpr int kWidth = 1;
+#endif
+
+#if defined(MATH_SIMD_SSE)
+	// 4要素すべてに同じ要素をコピーする
+	template<int i>
+	inline __m128 Splat(__m128 v)
+	{
+		return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i));
+	}
+
+	// a * b + c
+	inline __m128 MultiplyAdd(__m128 a, __m128 b, __m128 c)
+	{
+#if defined(MATH_SIMD_FMA)
+		return _mm_fmadd_ps(a, b, c);
+#else
+		return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+	}
+#endif
+
+#if defined(MATH_SIMD_AVX2)
+	// a * b + c
+	inline __m256 MultiplyAdd(__m256 a, __m256 b, __m256 c)
+	{
+#if defined(MATH_SIMD_FMA)
+		return _mm256_fmadd_ps(a, b, c);
+#else
+		return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+	}
+#endif
+}
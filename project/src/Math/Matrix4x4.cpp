@@ -1,273 +1,645 @@
 #define _USE_MATH_DEFINES 
 #include "Matrix4x4.h"
+#include "MathSIMD.h"
 #include <math.h>
 #include <cassert>
+#include <cfloat>
 #include <cmath>
 
 using namespace MatrixMath;
 
-// 行列の加法
-Matrix4x4 MatrixMath::Add(const Matrix4x4& m1, const Matrix4x4& m2) {
-    Matrix4x4 result = {};
-
-    for (int row = 0; row < 4; row++)
+namespace
+{
+    // 行列式が行ベクトルの長さの積に対して小さすぎる（ほぼ特異）か
+    // 長さの積と比べることで拡大縮小の大きさに依存しない判定にする（平方根を取らずに2乗同士で比べる）
+    inline bool IsNearlySingular(float det, float rowLengthSqProduct)
     {
-        for (int col = 0; col < 4; col++)
-        {
-            result.m[row][col] = m1.m[row][col] + m2.m[row][col];
-        }
+        // NaNも特異として扱う
+        return !(det * det > FLT_EPSILON * FLT_EPSILON * rowLengthSqProduct);
     }
 
-    return result;
-}
-// 行列の減法
-Matrix4x4 MatrixMath::Subtract(const Matrix4x4& m1, const Matrix4x4& m2) {
-    Matrix4x4 result = {};
-
-    for (int row = 0; row < 4; row++)
+#if defined(MATH_SIMD_SSE)
+    // 2x2行列（行優先で4要素に詰めたもの）の積 A * B
+    inline __m128 Mat2Multiply(__m128 a, __m128 b)
     {
-        for (int col = 0; col < 4; col++)
-        {
-            result.m[row][col] = m1.m[row][col] - m2.m[row][col];
-        }
+        return _mm_add_ps(
+            _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+            _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
     }
-    return result;
-}
-// 4x4行列の積
-Matrix4x4 MatrixMath::Multipty(const Matrix4x4& m1, const Matrix4x4& m2) {
-    Matrix4x4 result;
+    // 2x2行列の余因子行列との積 adj(A) * B
+    inline __m128 Mat2AdjMultiply(__m128 a, __m128 b)
+    {
+        return _mm_sub_ps(
+            _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+            _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+    // 2x2行列と余因子行列の積 A * adj(B)
+    inline __m128 Mat2MultiplyAdj(__m128 a, __m128 b)
+    {
+        return _mm_sub_ps(
+            _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+            _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    }
+#endif
 
-    for (int row = 0; row < 4; ++row)
+    // 4x4行列の積（結果はresultへ書き込む）
+    inline void MultiptyKernel(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& result)
     {
-        for (int col = 0; col < 4; ++col)
+#if defined(MATH_SIMD_AVX2)
+        // m2の各行を上下128bitに複製しておき、m1は2行ずつまとめて処理する
+        const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m2.m[0]));
+        const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m2.m[1]));
+        const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m2.m[2]));
+        const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m2.m[3]));
+        for (int row = 0; row < 4; row += 2)
+        {
+            const __m256 a = _mm256_loadu_ps(m1.m[row]);
+            __m256 r = _mm256_mul_ps(_mm256_permute_ps(a, 0x00), b0);
+            r = MathSIMD::MultiplyAdd(_mm256_permute_ps(a, 0x55), b1, r);
+            r = MathSIMD::MultiplyAdd(_mm256_permute_ps(a, 0xAA), b2, r);
+            r = MathSIMD::MultiplyAdd(_mm256_permute_ps(a, 0xFF), b3, r);
+            _mm256_storeu_ps(result.m[row], r);
+        }
+#elif defined(MATH_SIMD_SSE)
+        const __m128 b0 = _mm_loadu_ps(m2.m[0]);
+        const __m128 b1 = _mm_loadu_ps(m2.m[1]);
+        const __m128 b2 = _mm_loadu_ps(m2.m[2]);
+        const __m128 b3 = _mm_loadu_ps(m2.m[3]);
+        for (int row = 0; row < 4; ++row)
+        {
+            // 結果の1行 = m1の行の各要素 * m2の対応する行 の総和
+            const __m128 a = _mm_loadu_ps(m1.m[row]);
+            __m128 r = _mm_mul_ps(MathSIMD::Splat<0>(a), b0);
+            r = MathSIMD::MultiplyAdd(MathSIMD::Splat<1>(a), b1, r);
+            r = MathSIMD::MultiplyAdd(MathSIMD::Splat<2>(a), b2, r);
+            r = MathSIMD::MultiplyAdd(MathSIMD::Splat<3>(a), b3, r);
+            _mm_storeu_ps(result.m[row], r);
+        }
+#else
+        // resultがm1やm2と同じ場所を指していても良いように一時変数で計算する
+        Matrix4x4 temp;
+        for (int row = 0; row < 4; ++row)
         {
-            result.m[row][col] = 0;
-            for (int k = 0; k < 4; ++k)
+            for (int col = 0; col < 4; ++col)
             {
-                result.m[row][col] += m1.m[row][k] * m2.m[k][col];
+                temp.m[row][col] = 0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    temp.m[row][col] += m1.m[row][k] * m2.m[k][col];
+                }
             }
         }
+        result = temp;
+#endif
     }
 
-    return result;
-}
-// 4x4行列の逆行列
-Matrix4x4 MatrixMath::Inverse(const Matrix4x4& m)
-{
-    float aug[4][8] = {};
-    for (int row = 0; row < 4; row++)
+    // 4x4行列の逆行列（特異ならresultに単位行列を入れてfalseを返す）
+#if defined(MATH_SIMD_SSE)
+    // 2x2ブロックの余因子を使う
+    inline bool InverseKernel(const Matrix4x4& m, Matrix4x4& result)
     {
-        for (int col = 0; col < 4; col++)
+        const __m128 r0 = _mm_loadu_ps(m.m[0]);
+        const __m128 r1 = _mm_loadu_ps(m.m[1]);
+        const __m128 r2 = _mm_loadu_ps(m.m[2]);
+        const __m128 r3 = _mm_loadu_ps(m.m[3]);
+
+        // M = | A B |
+        //     | C D |  の2x2ブロックに分解
+        const __m128 a = _mm_movelh_ps(r0, r1);
+        const __m128 b = _mm_movehl_ps(r1, r0);
+        const __m128 c = _mm_movelh_ps(r2, r3);
+        const __m128 d = _mm_movehl_ps(r3, r2);
+
+        // 各ブロックの行列式 (|A| |B| |C| |D|)
+        const __m128 detSub = _mm_sub_ps(
+            _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+            _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0))));
+        const __m128 detA = MathSIMD::Splat<0>(detSub);
+        const __m128 detB = MathSIMD::Splat<1>(detSub);
+        const __m128 detC = MathSIMD::Splat<2>(detSub);
+        const __m128 detD = MathSIMD::Splat<3>(detSub);
+
+        const __m128 dc = Mat2AdjMultiply(d, c);
+        const __m128 ab = Mat2AdjMultiply(a, b);
+        // 逆行列の各ブロックの余因子
+        __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Multiply(b, dc));
+        __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Multiply(c, ab));
+        __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MultiplyAdj(d, ab));
+        __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MultiplyAdj(a, dc));
+
+        // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+        __m128 detM = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+        __m128 tr = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+        tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(2, 3, 0, 1)));
+        tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 0, 3, 2)));
+        detM = _mm_sub_ps(detM, tr);
+
+        // 各行の長さの2乗 (|r0|^2 |r1|^2 |r2|^2 |r3|^2)
+        __m128 l0 = _mm_mul_ps(r0, r0);
+        __m128 l1 = _mm_mul_ps(r1, r1);
+        __m128 l2 = _mm_mul_ps(r2, r2);
+        __m128 l3 = _mm_mul_ps(r3, r3);
+        _MM_TRANSPOSE4_PS(l0, l1, l2, l3);
+        __m128 lengthSq = _mm_add_ps(_mm_add_ps(l0, l1), _mm_add_ps(l2, l3));
+        lengthSq = _mm_mul_ps(lengthSq, _mm_shuffle_ps(lengthSq, lengthSq, _MM_SHUFFLE(2, 3, 0, 1)));
+        lengthSq = _mm_mul_ps(lengthSq, _mm_shuffle_ps(lengthSq, lengthSq, _MM_SHUFFLE(1, 0, 3, 2)));
+        if (IsNearlySingular(_mm_cvtss_f32(detM), _mm_cvtss_f32(lengthSq)))
         {
-            aug[row][col] = m.m[row][col];
+            result = MakeIdentity4x4();
+            return false;
         }
-    }
-    // 単位行列の追加
-    aug[0][4] = 1.0f;
-    aug[1][5] = 1.0f;
-    aug[2][6] = 1.0f;
-    aug[3][7] = 1.0f;
 
-    for (int i = 0; i < 4; i++)
+        // (1/|M|, -1/|M|, -1/|M|, 1/|M|)
+        const __m128 rcpDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+        x = _mm_mul_ps(x, rcpDet);
+        y = _mm_mul_ps(y, rcpDet);
+        z = _mm_mul_ps(z, rcpDet);
+        w = _mm_mul_ps(w, rcpDet);
+
+        // 余因子の並び替えと書き込みをまとめて行う
+        _mm_storeu_ps(result.m[0], _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(result.m[1], _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+        _mm_storeu_ps(result.m[2], _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(result.m[3], _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+        return true;
+    }
+#else
+    // 2x2小行列式による余因子展開
+    inline bool InverseKernel(const Matrix4x4& m, Matrix4x4& result)
     {
-        // ピボットが0の場合下の行と入れ替える
-        if (aug[i][i] == 0.0f)
+        const float (&a)[4][4] = m.m;
+
+        // 上2行から作る2x2小行列式
+        const float s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+        const float s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+        const float s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+        const float s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+        const float s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+        const float s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+        // 下2行から作る2x2小行列式
+        const float c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+        const float c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+        const float c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+        const float c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+        const float c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+        const float c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+        const float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+        float lengthSq = 1.0f;
+        for (int row = 0; row < 4; ++row)
         {
-            for (int j = i + 1; j < 4; j++)
-            {
-                if (aug[j][i] != 0.0f)
-                {
-                    // 行を交換する
-                    for (int k = 0; k < 8; k++)
-                    { // 列
-                        float copyNum = aug[i][k]; //もともとの上の行を代入
-                        aug[i][k] = aug[j][k]; //上の行
-                        aug[j][k] = copyNum; //下の行
-                    }
-                    break;
-                }
-            }
+            lengthSq *= a[row][0] * a[row][0] + a[row][1] * a[row][1] + a[row][2] * a[row][2] + a[row][3] * a[row][3];
         }
-
-        // ピボットを1にする
-        float pivot = aug[i][i];
-        for (int k = 0; k < 8; k++)
+        if (IsNearlySingular(det, lengthSq))
         {
-            aug[i][k] /= pivot;
+            result = MakeIdentity4x4();
+            return false;
         }
 
-        //i列目のピボット以外を0にする
-        for (int j = 0; j < 4; j++)
+        const float invDet = 1.0f / det;
+        Matrix4x4 inv;
+        inv.m[0][0] = (a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * invDet;
+        inv.m[0][1] = (-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * invDet;
+        inv.m[0][2] = (a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * invDet;
+        inv.m[0][3] = (-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * invDet;
+        inv.m[1][0] = (-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * invDet;
+        inv.m[1][1] = (a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * invDet;
+        inv.m[1][2] = (-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * invDet;
+        inv.m[1][3] = (a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * invDet;
+        inv.m[2][0] = (a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * invDet;
+        inv.m[2][1] = (-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * invDet;
+        inv.m[2][2] = (a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * invDet;
+        inv.m[2][3] = (-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * invDet;
+        inv.m[3][0] = (-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * invDet;
+        inv.m[3][1] = (a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * invDet;
+        inv.m[3][2] = (-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * invDet;
+        inv.m[3][3] = (a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * invDet;
+        // resultがmと同じ場所を指していても良いように最後に書き込む
+        result = inv;
+        return true;
+    }
+#endif
+
+#if defined(MATH_SIMD_SSE)
+    // 4つの行列の逆行列をまとめて計算する（ほぼ特異な行列には単位行列を入れる）
+    // 4つの行列の同じ要素を1つのレジスタに並べ（SoA）、スカラー版と同じ2x2小行列式による余因子展開を4つ同時に行う
+    // 1つずつ計算するときのような並び替えがいらず、転置の分を足しても1行列あたりの命令数は半分以下になる
+    inline void InverseKernel4(const Matrix4x4* m, Matrix4x4* results)
+    {
+        // a[row][col]のレーンkがm[k].m[row][col]
+        __m128 a[4][4];
+        for (int row = 0; row < 4; ++row)
         {
-            if (j != i)
+            a[row][0] = _mm_loadu_ps(m[0].m[row]);
+            a[row][1] = _mm_loadu_ps(m[1].m[row]);
+            a[row][2] = _mm_loadu_ps(m[2].m[row]);
+            a[row][3] = _mm_loadu_ps(m[3].m[row]);
+            _MM_TRANSPOSE4_PS(a[row][0], a[row][1], a[row][2], a[row][3]);
+        }
+        // x * y - z * w
+        const auto det2 = [](__m128 x, __m128 y, __m128 z, __m128 w)
             {
-                float factor = aug[j][i];
-                for (int k = 0; k < 8; k++)
-                {
-                    aug[j][k] -= factor * aug[i][k];
-                }
-            }
+                return _mm_sub_ps(_mm_mul_ps(x, y), _mm_mul_ps(z, w));
+            };
+
+        // 上2行から作る2x2小行列式
+        const __m128 s0 = det2(a[0][0], a[1][1], a[1][0], a[0][1]);
+        const __m128 s1 = det2(a[0][0], a[1][2], a[1][0], a[0][2]);
+        const __m128 s2 = det2(a[0][0], a[1][3], a[1][0], a[0][3]);
+        const __m128 s3 = det2(a[0][1], a[1][2], a[1][1], a[0][2]);
+        const __m128 s4 = det2(a[0][1], a[1][3], a[1][1], a[0][3]);
+        const __m128 s5 = det2(a[0][2], a[1][3], a[1][2], a[0][3]);
+        // 下2行から作る2x2小行列式
+        const __m128 c5 = det2(a[2][2], a[3][3], a[3][2], a[2][3]);
+        const __m128 c4 = det2(a[2][1], a[3][3], a[3][1], a[2][3]);
+        const __m128 c3 = det2(a[2][1], a[3][2], a[3][1], a[2][2]);
+        const __m128 c2 = det2(a[2][0], a[3][3], a[3][0], a[2][3]);
+        const __m128 c1 = det2(a[2][0], a[3][2], a[3][0], a[2][2]);
+        const __m128 c0 = det2(a[2][0], a[3][1], a[3][0], a[2][1]);
+
+        // det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0
+        const __m128 det = _mm_add_ps(
+            _mm_add_ps(det2(s0, c5, s1, c4), det2(s2, c3, s4, c1)),
+            _mm_add_ps(_mm_mul_ps(s3, c2), _mm_mul_ps(s5, c0)));
+
+        // 特異かどうかは行列ごとのマスクにして、特異なものだけ単位行列を選ぶ（NaNも特異になる）
+        __m128 lengthSq = _mm_set1_ps(1.0f);
+        for (int row = 0; row < 4; ++row)
+        {
+            __m128 rowLengthSq = _mm_mul_ps(a[row][0], a[row][0]);
+            rowLengthSq = MathSIMD::MultiplyAdd(a[row][1], a[row][1], rowLengthSq);
+            rowLengthSq = MathSIMD::MultiplyAdd(a[row][2], a[row][2], rowLengthSq);
+            rowLengthSq = MathSIMD::MultiplyAdd(a[row][3], a[row][3], rowLengthSq);
+            lengthSq = _mm_mul_ps(lengthSq, rowLengthSq);
         }
+        const __m128 isRegular = _mm_cmpgt_ps(_mm_mul_ps(det, det), _mm_mul_ps(_mm_set1_ps(FLT_EPSILON * FLT_EPSILON), lengthSq));
+        const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
 
-    }
+        const __m128 negInvDet = _mm_xor_ps(invDet, _mm_set1_ps(-0.0f));
 
-    Matrix4x4 result = {};
-    for (int row = 0; row < 4; row++)
-    {
-        for (int col = 0; col < 4; col++)
+        // x * p - y * q + z * r にscale（±1/det）を掛け、特異なら単位行列の要素にする
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const auto element = [&](__m128 x, __m128 p, __m128 y, __m128 q, __m128 z, __m128 r, __m128 scale, __m128 identity)
+            {
+                const __m128 value = _mm_mul_ps(MathSIMD::MultiplyAdd(z, r, det2(x, p, y, q)), scale);
+                return _mm_or_ps(_mm_and_ps(isRegular, value), _mm_andnot_ps(isRegular, identity));
+            };
+
+        __m128 inv[4][4];
+        inv[0][0] = element(a[1][1], c5, a[1][2], c4, a[1][3], c3, invDet, one);
+        inv[0][1] = element(a[0][1], c5, a[0][2], c4, a[0][3], c3, negInvDet, zero);
+        inv[0][2] = element(a[3][1], s5, a[3][2], s4, a[3][3], s3, invDet, zero);
+        inv[0][3] = element(a[2][1], s5, a[2][2], s4, a[2][3], s3, negInvDet, zero);
+        inv[1][0] = element(a[1][0], c5, a[1][2], c2, a[1][3], c1, negInvDet, zero);
+        inv[1][1] = element(a[0][0], c5, a[0][2], c2, a[0][3], c1, invDet, one);
+        inv[1][2] = element(a[3][0], s5, a[3][2], s2, a[3][3], s1, negInvDet, zero);
+        inv[1][3] = element(a[2][0], s5, a[2][2], s2, a[2][3], s1, invDet, zero);
+        inv[2][0] = element(a[1][0], c4, a[1][1], c2, a[1][3], c0, invDet, zero);
+        inv[2][1] = element(a[0][0], c4, a[0][1], c2, a[0][3], c0, negInvDet, zero);
+        inv[2][2] = element(a[3][0], s4, a[3][1], s2, a[3][3], s0, invDet, one);
+        inv[2][3] = element(a[2][0], s4, a[2][1], s2, a[2][3], s0, negInvDet, zero);
+        inv[3][0] = element(a[1][0], c3, a[1][1], c1, a[1][2], c0, negInvDet, zero);
+        inv[3][1] = element(a[0][0], c3, a[0][1], c1, a[0][2], c0, invDet, zero);
+        inv[3][2] = element(a[3][0], s3, a[3][1], s1, a[3][2], s0, negInvDet, zero);
+        inv[3][3] = element(a[2][0], s3, a[2][1], s1, a[2][2], s0, invDet, one);
+
+        // 行列ごとの並びに戻して書き込む（入力はすべて読み終えているので、resultsがmと同じ場所でも良い）
+        for (int row = 0; row < 4; ++row)
         {
-            result.m[row][col] = aug[row][col + 4];
+            _MM_TRANSPOSE4_PS(inv[row][0], inv[row][1], inv[row][2], inv[row][3]);
+            _mm_storeu_ps(results[0].m[row], inv[row][0]);
+            _mm_storeu_ps(results[1].m[row], inv[row][1]);
+            _mm_storeu_ps(results[2].m[row], inv[row][2]);
+            _mm_storeu_ps(results[3].m[row], inv[row][3]);
         }
     }
+#endif
+
+    // S * Rx * Ry * Rz * T を展開した結果を直接書き込む
+    inline void WriteAffine(
+        float scaleX, float scaleY, float scaleZ,
+        float sx, float cx, float sy, float cy, float sz, float cz,
+        float translateX, float translateY, float translateZ,
+        Matrix4x4& result)
+    {
+        // 回転行列 Rx * Ry * Rz の各行に拡大率を掛ける
+        result.m[0][0] = scaleX * (cy * cz);
+        result.m[0][1] = scaleX * (cy * sz);
+        result.m[0][2] = scaleX * (-sy);
+        result.m[0][3] = 0.0f;
+
+        const float sxsy = sx * sy;
+        result.m[1][0] = scaleY * (sxsy * cz - cx * sz);
+        result.m[1][1] = scaleY * (sxsy * sz + cx * cz);
+        result.m[1][2] = scaleY * (sx * cy);
+        result.m[1][3] = 0.0f;
+
+        const float cxsy = cx * sy;
+        result.m[2][0] = scaleZ * (cxsy * cz + sx * sz);
+        result.m[2][1] = scaleZ * (cxsy * sz - sx * cz);
+        result.m[2][2] = scaleZ * (cx * cy);
+        result.m[2][3] = 0.0f;
+
+        // 平行移動はそのまま4行目に入る
+        result.m[3][0] = translateX;
+        result.m[3][1] = translateY;
+        result.m[3][2] = translateZ;
+        result.m[3][3] = 1.0f;
+    }
+}
+
+// 4x4行列の積
+Matrix4x4 MatrixMath::Multipty(const Matrix4x4& m1, const Matrix4x4& m2) {
+    Matrix4x4 result;
+
+    MultiptyKernel(m1, m2, result);
 
     return result;
 }
-// 転置行列
-Matrix4x4 MatrixMath::Transpoce(const Matrix4x4& m)
+// 4x4行列の積をまとめて計算
+void MatrixMath::MultiptyBatch(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* results, size_t count)
 {
-    Matrix4x4 result = {};
+    assert(count == 0 || (m1 && m2 && results));
 
-    for (int row = 0; row < 4; ++row)
+    for (size_t i = 0; i < count; ++i)
     {
-        for (int col = 0; col < 4; ++col)
-        {
-            result.m[row][col] = m.m[col][row];
-        }
+        MultiptyKernel(m1[i], m2[i], results[i]);
     }
-
-    return result;
 }
-// 単位行列の作成
-Matrix4x4 MatrixMath::MakeIdentity4x4()
+// 複数の行列に同じ行列を右から掛ける
+void MatrixMath::MultiptyBatch(const Matrix4x4* m1, const Matrix4x4& m2, Matrix4x4* results, size_t count)
 {
-    Matrix4x4 result = {};
+    assert(count == 0 || (m1 && results));
 
-    for (int i = 0; i < 4; ++i)
+    for (size_t i = 0; i < count; ++i)
     {
-        result.m[i][i] = 1.0f;
+        MultiptyKernel(m1[i], m2, results[i]);
     }
+}
+// 4x4行列の逆行列
+Matrix4x4 MatrixMath::Inverse(const Matrix4x4& m)
+{
+    Matrix4x4 result;
+
+    InverseKernel(m, result);
+
     return result;
 }
+// 逆行列をまとめて計算
+void MatrixMath::InverseBatch(const Matrix4x4* m, Matrix4x4* results, size_t count)
+{
+    assert(count == 0 || (m && results));
 
-// 平行移動行列
-Matrix4x4 MatrixMath::MakeTranslate(const Vector3& translate)
+    size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+    for (; i + 4 <= count; i += 4)
+    {
+        InverseKernel4(m + i, results + i);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        InverseKernel(m[i], results[i]);
+    }
+}
+// アフィン変換行列の逆行列
+Matrix4x4 MatrixMath::InverseAffine(const Matrix4x4& m)
 {
+    Matrix4x4 result;
+#if defined(MATH_SIMD_SSE)
+    // 左上3x3を転置して列ベクトルにする（4行目に0を入れるので、各列の4要素目は0になる）
+    __m128 k0 = _mm_loadu_ps(m.m[0]);
+    __m128 k1 = _mm_loadu_ps(m.m[1]);
+    __m128 k2 = _mm_loadu_ps(m.m[2]);
+    __m128 k3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(k0, k1, k2, k3);
+    const __m128 t = _mm_loadu_ps(m.m[3]);
+
+    // 外積 a.yzx * b.zxy - a.zxy * b.yzx（a * b.yzx - a.yzx * b を求めてからyzxに並べ替え、シャッフルを1回減らす）
+    const auto cross = [](__m128 a, __m128 b)
+        {
+            const __m128 c = _mm_sub_ps(
+                _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1))),
+                _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), b));
+            return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+        };
+    // 3x3部分の余因子行列（列同士の外積がそのまま逆行列 * 行列式の各行になる）
+    const __m128 a0 = cross(k1, k2);
+    const __m128 a1 = cross(k2, k0);
+    const __m128 a2 = cross(k0, k1);
+
+    // 行列式 dot(k0, a0)
+    __m128 det = _mm_mul_ps(k0, a0);
+    det = _mm_add_ps(det, _mm_movehl_ps(det, det));
+    det = _mm_add_ss(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(1, 1, 1, 1)));
+    // 各行の長さの2乗は列の2乗を要素ごとに足したもの (|r0|^2 |r1|^2 |r2|^2 0)
+    __m128 lengthSq = _mm_mul_ps(k0, k0);
+    lengthSq = MathSIMD::MultiplyAdd(k1, k1, lengthSq);
+    lengthSq = MathSIMD::MultiplyAdd(k2, k2, lengthSq);
+    lengthSq = _mm_mul_ss(_mm_mul_ss(lengthSq, MathSIMD::Splat<1>(lengthSq)), _mm_movehl_ps(lengthSq, lengthSq));
+    if (IsNearlySingular(_mm_cvtss_f32(det), _mm_cvtss_f32(lengthSq)))
+    {
+        return MakeIdentity4x4();
+    }
 
-    Matrix4x4 result = {};
-    // 単位行列の作成
-    result.m[0][0] = 1.0f;
-    result.m[1][1] = 1.0f;
-    result.m[2][2] = 1.0f;
+    const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), MathSIMD::Splat<0>(det));
+    const __m128 i0 = _mm_mul_ps(a0, invDet);
+    const __m128 i1 = _mm_mul_ps(a1, invDet);
+    const __m128 i2 = _mm_mul_ps(a2, invDet);
+    _mm_storeu_ps(result.m[0], i0);
+    _mm_storeu_ps(result.m[1], i1);
+    _mm_storeu_ps(result.m[2], i2);
+
+    // 平行移動は -t * 逆行列（4列目は 1 - 0 で1になる）
+    __m128 translate = _mm_mul_ps(MathSIMD::Splat<0>(t), i0);
+    translate = MathSIMD::MultiplyAdd(MathSIMD::Splat<1>(t), i1, translate);
+    translate = MathSIMD::MultiplyAdd(MathSIMD::Splat<2>(t), i2, translate);
+    _mm_storeu_ps(result.m[3], _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), translate));
+#else
+    // 左上3x3の各行
+    const float (&r0)[4] = m.m[0];
+    const float (&r1)[4] = m.m[1];
+    const float (&r2)[4] = m.m[2];
+
+    // 3x3部分の余因子（行同士の外積）
+    const float c0[3] = { r1[1] * r2[2] - r1[2] * r2[1], r1[2] * r2[0] - r1[0] * r2[2], r1[0] * r2[1] - r1[1] * r2[0] };
+    const float c1[3] = { r2[1] * r0[2] - r2[2] * r0[1], r2[2] * r0[0] - r2[0] * r0[2], r2[0] * r0[1] - r2[1] * r0[0] };
+    const float c2[3] = { r0[1] * r1[2] - r0[2] * r1[1], r0[2] * r1[0] - r0[0] * r1[2], r0[0] * r1[1] - r0[1] * r1[0] };
+
+    const float det = r0[0] * c0[0] + r0[1] * c0[1] + r0[2] * c0[2];
+    const float lengthSq =
+        (r0[0] * r0[0] + r0[1] * r0[1] + r0[2] * r0[2]) *
+        (r1[0] * r1[0] + r1[1] * r1[1] + r1[2] * r1[2]) *
+        (r2[0] * r2[0] + r2[1] * r2[1] + r2[2] * r2[2]);
+    if (IsNearlySingular(det, lengthSq))
+    {
+        return MakeIdentity4x4();
+    }
+    const float invDet = 1.0f / det;
+
+    // 3x3部分の逆行列は余因子を列に並べたもの
+    for (int row = 0; row < 3; ++row)
+    {
+        result.m[row][0] = c0[row] * invDet;
+        result.m[row][1] = c1[row] * invDet;
+        result.m[row][2] = c2[row] * invDet;
+        result.m[row][3] = 0.0f;
+    }
+    // 平行移動は -t * 逆行列
+    const float tx = m.m[3][0];
+    const float ty = m.m[3][1];
+    const float tz = m.m[3][2];
+    for (int col = 0; col < 3; ++col)
+    {
+        result.m[3][col] = -(tx * result.m[0][col] + ty * result.m[1][col] + tz * result.m[2][col]);
+    }
     result.m[3][3] = 1.0f;
-    // 平行移動の成分
-    result.m[3][0] = translate.x;
-    result.m[3][1] = translate.y;
-    result.m[3][2] = translate.z;
+#endif
 
-    return result;// 完成した平行移動を返す
+    return result;
 }
-// 拡大縮小行列
-Matrix4x4 MatrixMath::MakeScale(const Vector3& scale)
+// 剛体変換（回転と平行移動のみ）行列の逆行列
+Matrix4x4 MatrixMath::InverseRigid(const Matrix4x4& m)
 {
-
-    Matrix4x4 result = {};
-    // 拡大率の設定
-    result.m[0][0] = scale.x;
-    result.m[1][1] = scale.y;
-    result.m[2][2] = scale.z;
+    Matrix4x4 result;
+#if defined(MATH_SIMD_SSE)
+    // 回転部分は転置するだけで逆行列になる（4行目に0を入れて転置し、4列目を0にする）
+    __m128 r0 = _mm_loadu_ps(m.m[0]);
+    __m128 r1 = _mm_loadu_ps(m.m[1]);
+    __m128 r2 = _mm_loadu_ps(m.m[2]);
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(result.m[0], r0);
+    _mm_storeu_ps(result.m[1], r1);
+    _mm_storeu_ps(result.m[2], r2);
+
+    // 平行移動は -t * R^T
+    const __m128 t = _mm_loadu_ps(m.m[3]);
+    __m128 translate = _mm_mul_ps(MathSIMD::Splat<0>(t), r0);
+    translate = MathSIMD::MultiplyAdd(MathSIMD::Splat<1>(t), r1, translate);
+    translate = MathSIMD::MultiplyAdd(MathSIMD::Splat<2>(t), r2, translate);
+    _mm_storeu_ps(result.m[3], _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), translate));
+#else
+    // 回転部分は転置するだけで逆行列になる
+    for (int row = 0; row < 3; ++row)
+    {
+        result.m[row][0] = m.m[0][row];
+        result.m[row][1] = m.m[1][row];
+        result.m[row][2] = m.m[2][row];
+        result.m[row][3] = 0.0f;
+    }
+    // 平行移動は -t * R^T
+    const float tx = m.m[3][0];
+    const float ty = m.m[3][1];
+    const float tz = m.m[3][2];
+    for (int col = 0; col < 3; ++col)
+    {
+        result.m[3][col] = -(tx * m.m[col][0] + ty * m.m[col][1] + tz * m.m[col][2]);
+    }
     result.m[3][3] = 1.0f;
+#endif
 
-    return result;// 拡大(スケ―リンク)行列を返す
+    return result;
 }
-
 //X軸の回転行列
-Matrix4x4 MatrixMath::MakeRotateX(float radian)
+Matrix4x4 MatrixMath::MakeRotateX(float radian, TrigPrecision precision)
 {
+    float sine;
+    float cosine;
+    FastTrig::SinCos(radian, sine, cosine, precision);
 
     Matrix4x4 result = {};
     // 3次元のX軸周りの回転行列
     result.m[0][0] = 1.0f;// X軸方向のベクトル変化しない
-    result.m[1][1] = std::cos(radian); // Y成分の回転
-    result.m[1][2] = std::sin(radian); // Z成分への影響
-    result.m[2][1] = -std::sin(radian);// Y成分への影響  
-    result.m[2][2] = std::cos(radian); // Z成分の回転
+    result.m[1][1] = cosine; // Y成分の回転
+    result.m[1][2] = sine; // Z成分への影響
+    result.m[2][1] = -sine;// Y成分への影響  
+    result.m[2][2] = cosine; // Z成分の回転
     result.m[3][3] = 1.0f;// 同時系列のw成分(固定値1)
 
     return result;// X軸の回転行列を返す
 }
 // Y軸の回転行列
-Matrix4x4 MatrixMath::MakeRotateY(float radian)
+Matrix4x4 MatrixMath::MakeRotateY(float radian, TrigPrecision precision)
 {
+    float sine;
+    float cosine;
+    FastTrig::SinCos(radian, sine, cosine, precision);
 
     Matrix4x4 result = {};
     // 3次元のY軸周りの回転行列
-    result.m[0][0] = std::cos(radian); // X成分の回転
-    result.m[0][2] = -std::sin(radian);// Z成分への影響
+    result.m[0][0] = cosine; // X成分の回転
+    result.m[0][2] = -sine;// Z成分への影響
     result.m[1][1] = 1.0f;// Y軸は固定
-    result.m[2][0] = std::sin(radian); // X成分への影響
-    result.m[2][2] = std::cos(radian); // Z成分の回転
+    result.m[2][0] = sine; // X成分への影響
+    result.m[2][2] = cosine; // Z成分の回転
     result.m[3][3] = 1.0f;// 同次座標系のw成分(固定値1)
 
     return result;// Y軸の回転行列を返す
 }
 // Z軸の回転行列
-Matrix4x4 MatrixMath::MakeRotateZ(float radian)
+Matrix4x4 MatrixMath::MakeRotateZ(float radian, TrigPrecision precision)
 {
+    float sine;
+    float cosine;
+    FastTrig::SinCos(radian, sine, cosine, precision);
 
     Matrix4x4 result = {};
     // 3次元のZ軸周りの回転行列
-    result.m[0][0] = std::cos(radian); // X成分の回転
-    result.m[0][1] = std::sin(radian);  // Y成分への影響  
-    result.m[1][0] = -std::sin(radian); // X成分への影響
-    result.m[1][1] = std::cos(radian);  // Y成分の回転
+    result.m[0][0] = cosine; // X成分の回転
+    result.m[0][1] = sine;  // Y成分への影響  
+    result.m[1][0] = -sine; // X成分への影響
+    result.m[1][1] = cosine;  // Y成分の回転
     result.m[2][2] = 1.0f;// Z軸は固定
     result.m[3][3] = 1.0f;// 同時座標系のw成分(固定値1)
 
     return result;// Z軸の回転行列を返す
 }
 // 3次元アフィン変換行列
-Matrix4x4 MatrixMath::MakeAffine(const Vector3& scale, const Vector3& rotate, const Vector3& translate)
+Matrix4x4 MatrixMath::MakeAffine(const Vector3& scale, const Vector3& rotate, const Vector3& translate, TrigPrecision precision)
 {
+    // 各軸のsin/cosは1回ずつだけ計算する
+    float sx, cx, sy, cy, sz, cz;
+    FastTrig::SinCos(rotate.x, sx, cx, precision);
+    FastTrig::SinCos(rotate.y, sy, cy, precision);
+    FastTrig::SinCos(rotate.z, sz, cz, precision);
 
-    Matrix4x4 result = {};
-    // 拡大縮小を生成
-    Matrix4x4 scaleMatrix = MakeScale(scale);
-
-    // X軸の回転行列を生成
-    Matrix4x4 rotateXMatrix = MakeRotateX(rotate.x);
-    // Y軸の回転行列を生成
-    Matrix4x4 rotateYMatrix = MakeRotateY(rotate.y);
-    // Z軸の回転行列を生成
-    Matrix4x4 rotateZMatrix = MakeRotateZ(rotate.z);
-    // X軸、Y軸、Z軸の順に回転を合成
-    Matrix4x4 rotateXYZMatrix = Multipty(Multipty(rotateXMatrix, rotateYMatrix), rotateZMatrix);
-
-    // 平行移動を生成
-    Matrix4x4 translateMatrix = MakeTranslate(translate);
-
-    // 最終的なアフィン変換行列： T * R * S
-    result = Multipty(Multipty(scaleMatrix, rotateXYZMatrix), translateMatrix);
-
-
+    Matrix4x4 result;
+    WriteAffine(scale.x, scale.y, scale.z, sx, cx, sy, cy, sz, cz, translate.x, translate.y, translate.z, result);
 
     return result;
 }
-// 正射影行列
-Matrix4x4 MatrixMath::Orthographic(float left, float top, float right, float bottom, float nearClip, float farClip)
+// 3次元アフィン変換行列をまとめて作成
+void MatrixMath::MakeAffineBatch(const AffineSoA& params, Matrix4x4* results, size_t count, TrigPrecision precision)
 {
+    assert(count == 0 || results);
 
-    Matrix4x4 result = {};
+    // sin/cosをブロック単位でまとめて計算してから行列を組み立てる
+    constexpr size_t kBlockSize = 64;
+    float sinX[kBlockSize], cosX[kBlockSize];
+    float sinY[kBlockSize], cosY[kBlockSize];
+    float sinZ[kBlockSize], cosZ[kBlockSize];
 
-    result.m[0][0] = 2.0f / (right - left);
-    result.m[1][1] = 2.0f / (top - bottom);
-    result.m[2][2] = 1.0f / (farClip - nearClip);
-    result.m[3][0] = (left + right) / (left - right);
-    result.m[3][1] = (top + bottom) / (bottom - top);
-    result.m[3][2] = nearClip / (nearClip - farClip);
-    result.m[3][3] = 1.0f;
+    for (size_t begin = 0; begin < count; begin += kBlockSize)
+    {
+        const size_t blockCount = (count - begin < kBlockSize) ? count - begin : kBlockSize;
 
+        FastTrig::SinCosBatch(&params.rotateX[begin], sinX, cosX, blockCount, precision);
+        FastTrig::SinCosBatch(&params.rotateY[begin], sinY, cosY, blockCount, precision);
+        FastTrig::SinCosBatch(&params.rotateZ[begin], sinZ, cosZ, blockCount, precision);
 
-    return result;
+        for (size_t i = 0; i < blockCount; ++i)
+        {
+            const size_t index = begin + i;
+            WriteAffine(
+                params.scaleX[index], params.scaleY[index], params.scaleZ[index],
+                sinX[i], cosX[i], sinY[i], cosY[i], sinZ[i], cosZ[i],
+                params.translateX[index], params.translateY[index], params.translateZ[index],
+                results[index]);
+        }
+    }
 }
 // 透視投影行列
 Matrix4x4 MatrixMath::PerspectiveFov(float fovY, float aspectRatio, float nearClip, float farClip)
@@ -287,29 +659,3 @@ Matrix4x4 MatrixMath::PerspectiveFov(float fovY, float aspectRatio, float nearCl
 
     return result;
 }
-// ビューポート変換行列
-Matrix4x4 MatrixMath::Viewport(float left, float top, float width, float height, float minDepth, float maxDepth)
-{
-
-    Matrix4x4 result = {};
-
-    result.m[0][0] = width / 2.0f;
-    result.m[1][1] = -height / 2.0f;
-    result.m[2][2] = maxDepth - minDepth;
-    result.m[3][0] = left + (width / 2.0f);
-    result.m[3][1] = top + (height / 2.0f);
-    result.m[3][2] = minDepth;
-    result.m[3][3] = 1.0f;
-
-    return result;
-}
-// クロス積
-Vector3 MatrixMath::Cross(const Vector3& v1, const Vector3& v2)
-{
-    return Vector3
-    (
-        v1.y * v2.z - v1.z * v2.y,
-        v1.z * v2.x - v1.x * v2.z,
-        v1.x * v2.y - v1.y * v2.x
-    );
-}
\ No newline at end of file
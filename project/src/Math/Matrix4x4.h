@@ -1,59 +1,217 @@
 #pragma once
+#include <cstddef>
+#include <type_traits>
+
+#include "Vector3.h"
+#include "Vector4.h"
+#include "FastTrig.h"
+
 struct Matrix4x4
 {
 
 	float m[4][4];
 };
-/*
-struct Vector2
-{
-	float x;
-	float y;
-};*/
-
 
-
-struct Vector3
+// SoA形式のアフィン変換パラメータ（各配列は同じ要素数を持つ）
+struct AffineSoA
 {
-	float x, y, z;
+	const float* scaleX;
+	const float* scaleY;
+	const float* scaleZ;
+	const float* rotateX;
+	const float* rotateY;
+	const float* rotateZ;
+	const float* translateX;
+	const float* translateY;
+	const float* translateZ;
 };
 
 namespace MatrixMath
 {
 	// 行列の加法
-	Matrix4x4 Add(const Matrix4x4& m1, const Matrix4x4& m2);
+	constexpr Matrix4x4 Add(const Matrix4x4& m1, const Matrix4x4& m2)
+	{
+		Matrix4x4 result = {};
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				result.m[row][col] = m1.m[row][col] + m2.m[row][col];
+			}
+		}
+		return result;
+	}
 	// 行列の減法
-	Matrix4x4 Subtract(const Matrix4x4& m1, const Matrix4x4& m2);
+	constexpr Matrix4x4 Subtract(const Matrix4x4& m1, const Matrix4x4& m2)
+	{
+		Matrix4x4 result = {};
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				result.m[row][col] = m1.m[row][col] - m2.m[row][col];
+			}
+		}
+		return result;
+	}
 	// 行列の積
 	Matrix4x4 Multipty(const Matrix4x4& m1, const Matrix4x4& m2);
-	// 逆行列
+	// 行列の積をまとめて計算（results[i] = m1[i] * m2[i]）
+	void MultiptyBatch(const Matrix4x4* m1, const Matrix4x4* m2, Matrix4x4* results, size_t count);
+	// 複数の行列に同じ行列を掛ける（results[i] = m1[i] * m2）
+	void MultiptyBatch(const Matrix4x4* m1, const Matrix4x4& m2, Matrix4x4* results, size_t count);
+	// 逆行列（ほぼ特異な行列には単位行列を返す）
 	Matrix4x4 Inverse(const Matrix4x4& m);
+	// 逆行列をまとめて計算（results[i] = Inverse(m[i])）
+	void InverseBatch(const Matrix4x4* m, Matrix4x4* results, size_t count);
+	// アフィン変換行列（4列目が(0,0,0,1)）の逆行列。ほぼ特異なら単位行列を返す
+	Matrix4x4 InverseAffine(const Matrix4x4& m);
+	// 剛体変換行列（回転と平行移動のみ）の逆行列
+	Matrix4x4 InverseRigid(const Matrix4x4& m);
 	// 転置行列
-	Matrix4x4 Transpoce(const Matrix4x4& m);
+	constexpr Matrix4x4 Transpoce(const Matrix4x4& m)
+	{
+		Matrix4x4 result = {};
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				result.m[row][col] = m.m[col][row];
+			}
+		}
+		return result;
+	}
 	// 単位行列の作成
-	Matrix4x4 MakeIdentity4x4();
+	constexpr Matrix4x4 MakeIdentity4x4()
+	{
+		Matrix4x4 result = {};
+		result.m[0][0] = 1.0f;
+		result.m[1][1] = 1.0f;
+		result.m[2][2] = 1.0f;
+		result.m[3][3] = 1.0f;
+		return result;
+	}
 	// 平行移動行列
-	Matrix4x4 MakeTranslate(const Vector3& translate);
+	constexpr Matrix4x4 MakeTranslate(const Vector3& translate)
+	{
+		Matrix4x4 result = MakeIdentity4x4();
+		// 平行移動の成分
+		result.m[3][0] = translate.x;
+		result.m[3][1] = translate.y;
+		result.m[3][2] = translate.z;
+		return result;
+	}
 	// 拡大縮小行列
-	Matrix4x4 MakeScale(const Vector3& scale);
+	constexpr Matrix4x4 MakeScale(const Vector3& scale)
+	{
+		Matrix4x4 result = {};
+		// 拡大率の設定
+		result.m[0][0] = scale.x;
+		result.m[1][1] = scale.y;
+		result.m[2][2] = scale.z;
+		result.m[3][3] = 1.0f;
+		return result;
+	}
 
-	// X軸の回転行列
-	Matrix4x4 MakeRotateX(float radian);
+	// X軸の回転行列（precisionで近似版のsin/cosを選べる）
+	Matrix4x4 MakeRotateX(float radian, TrigPrecision precision = TrigPrecision::Exact);
 	// Y軸の回転行列
-	Matrix4x4 MakeRotateY(float radian);
+	Matrix4x4 MakeRotateY(float radian, TrigPrecision precision = TrigPrecision::Exact);
 	// Z軸の回転行列
-	Matrix4x4 MakeRotateZ(float radian);
+	Matrix4x4 MakeRotateZ(float radian, TrigPrecision precision = TrigPrecision::Exact);
 
-	// 3次元アフィン変換行列
-	Matrix4x4 MakeAffine(const Vector3& scale, const Vector3& rotate, const Vector3& translate);
+	// 3次元アフィン変換行列（S * Rx * Ry * Rz * T）
+	Matrix4x4 MakeAffine(const Vector3& scale, const Vector3& rotate, const Vector3& translate, TrigPrecision precision = TrigPrecision::Exact);
+	// 3次元アフィン変換行列をまとめて作成
+	void MakeAffineBatch(const AffineSoA& params, Matrix4x4* results, size_t count, TrigPrecision precision = TrigPrecision::Exact);
 
 	// 正射影行列
-	Matrix4x4 Orthographic(float left, float top, float right, float bottom, float nearClip, float farClip);
+	constexpr Matrix4x4 Orthographic(float left, float top, float right, float bottom, float nearClip, float farClip)
+	{
+		Matrix4x4 result = {};
+		result.m[0][0] = 2.0f / (right - left);
+		result.m[1][1] = 2.0f / (top - bottom);
+		result.m[2][2] = 1.0f / (farClip - nearClip);
+		result.m[3][0] = (left + right) / (left - right);
+		result.m[3][1] = (top + bottom) / (bottom - top);
+		result.m[3][2] = nearClip / (nearClip - farClip);
+		result.m[3][3] = 1.0f;
+		return result;
+	}
 	// 透視投影行列
 	Matrix4x4 PerspectiveFov(float fovY, float aspectRatio, float nearClip, float farClip);
 	// ビューポート変換行列
-	Matrix4x4 Viewport(float left, float top, float width, float height, float minDepth, float maxDepth);
+	constexpr Matrix4x4 Viewport(float left, float top, float width, float height, float minDepth, float maxDepth)
+	{
+		Matrix4x4 result = {};
+		result.m[0][0] = width / 2.0f;
+		result.m[1][1] = -height / 2.0f;
+		result.m[2][2] = maxDepth - minDepth;
+		result.m[3][0] = left + (width / 2.0f);
+		result.m[3][1] = top + (height / 2.0f);
+		result.m[3][2] = minDepth;
+		result.m[3][3] = 1.0f;
+		return result;
+	}
 	// クロス積
-	Vector3 Cross(const Vector3& v1, const Vector3& v2);
+	constexpr Vector3 Cross(const Vector3& v1, const Vector3& v2)
+	{
+		return VectorMath::Cross(v1, v2);
+	}
+
+	// 座標変換（w除算あり）
+	constexpr Vector3 TransformCoord(const Vector3& v, const Matrix4x4& m)
+	{
+		const float x = v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + m.m[3][0];
+		const float y = v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + m.m[3][1];
+		const float z = v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + m.m[3][2];
+		const float w = v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + m.m[3][3];
+		return { x / w, y / w, z / w };
+	}
+	// 方向ベクトルの変換（平行移動を無視する）
+	constexpr Vector3 TransformNormal(const Vector3& v, const Matrix4x4& m)
+	{
+		return
+		{
+			v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0],
+			v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1],
+			v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2]
+		};
+	}
+	// 同次座標の変換
+	constexpr Vector4 TransformVector(const Vector4& v, const Matrix4x4& m)
+	{
+		return
+		{
+			v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + v.w * m.m[3][0],
+			v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + v.w * m.m[3][1],
+			v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + v.w * m.m[3][2],
+			v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + v.w * m.m[3][3]
+		};
+	}
 
-}
\ No newline at end of file
+}
+
+// 行列の演算子
+constexpr Matrix4x4 operator+(const Matrix4x4& m1, const Matrix4x4& m2) { return MatrixMath::Add(m1, m2); }
+constexpr Matrix4x4 operator-(const Matrix4x4& m1, const Matrix4x4& m2) { return MatrixMath::Subtract(m1, m2); }
+// 行列の積。コンパイル時はスカラーで計算し、実行時はSIMD版のMultiptyを使う
+constexpr Matrix4x4 operator*(const Matrix4x4& m1, const Matrix4x4& m2)
+{
+	if (std::is_constant_evaluated())
+	{
+		Matrix4x4 result = {};
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				for (int k = 0; k < 4; ++k)
+				{
+					result.m[row][col] += m1.m[row][k] * m2.m[k][col];
+				}
+			}
+		}
+		return result;
+	}
+	return MatrixMath::Multipty(m1, m2);
+}
@@ -0,0 +1,357 @@
+#include "Quaternion.h"
+#include "MathSIMD.h"
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	// これ以上近い姿勢同士はSlerpの代わりにNlerpで補間する
+	constexpr float kSlerpThreshold = 0.9995f;
+
+	// 正規化済みクォータニオンから回転行列を書き込む
+	inline void WriteRotateMatrix(float x, float y, float z, float w, Matrix4x4& result)
+	{
+		const float xx = x * x;
+		const float yy = y * y;
+		const float zz = z * z;
+		const float xy = x * y;
+		const float xz = x * z;
+		const float yz = y * z;
+		const float wx = w * x;
+		const float wy = w * y;
+		const float wz = w * z;
+
+		result.m[0][0] = 1.0f - 2.0f * (yy + zz);
+		result.m[0][1] = 2.0f * (xy + wz);
+		result.m[0][2] = 2.0f * (xz - wy);
+		result.m[0][3] = 0.0f;
+
+		result.m[1][0] = 2.0f * (xy - wz);
+		result.m[1][1] = 1.0f - 2.0f * (xx + zz);
+		result.m[1][2] = 2.0f * (yz + wx);
+		result.m[1][3] = 0.0f;
+
+		result.m[2][0] = 2.0f * (xz + wy);
+		result.m[2][1] = 2.0f * (yz - wx);
+		result.m[2][2] = 1.0f - 2.0f * (xx + yy);
+		result.m[2][3] = 0.0f;
+
+		result.m[3][0] = 0.0f;
+		result.m[3][1] = 0.0f;
+		result.m[3][2] = 0.0f;
+		result.m[3][3] = 1.0f;
+	}
+
+	// q0 * weight0 + q1 * weight1 を正規化して回転行列を書き込む
+	// q0とq1が逆向きの半球にあるときはq1を反転して最短経路にする
+	inline void WriteBlendedRotateMatrix(const Quaternion& q0, const Quaternion& q1, float weight0, float weight1, Matrix4x4& result)
+	{
+		if (QuaternionMath::Dot(q0, q1) < 0.0f)
+		{
+			weight1 = -weight1;
+		}
+		Quaternion q = q0 * weight0 + q1 * weight1;
+		q = QuaternionMath::Normalize(q);
+		WriteRotateMatrix(q.x, q.y, q.z, q.w, result);
+	}
+
+	// Slerpの重みを求める（cosThetaは符号を揃えた内積）
+	inline void ComputeSlerpWeights(float cosTheta, float t, float& weight0, float& weight1)
+	{
+		if (cosTheta > kSlerpThreshold)
+		{
+			// ほぼ同じ向きなら線形補間で十分
+			weight0 = 1.0f - t;
+			weight1 = t;
+			return;
+		}
+		const float theta = std::acos(cosTheta);
+		const float invSinTheta = 1.0f / std::sin(theta);
+		weight0 = std::sin((1.0f - t) * theta) * invSinTheta;
+		weight1 = std::sin(t * theta) * invSinTheta;
+	}
+
+#if defined(MATH_SIMD_SSE)
+	// 4つのクォータニオンの補間と回転行列の作成をまとめて行う
+	// weight0/weight1は各レーンの重み（符号は内積から自動で揃える）
+	inline void BlendedRotateMatrix4(const Quaternion* q0, const Quaternion* q1, __m128 weight0, __m128 weight1, Matrix4x4* results)
+	{
+		// AoSからSoAへ並び替える
+		__m128 x0 = _mm_loadu_ps(&q0[0].x);
+		__m128 y0 = _mm_loadu_ps(&q0[1].x);
+		__m128 z0 = _mm_loadu_ps(&q0[2].x);
+		__m128 w0 = _mm_loadu_ps(&q0[3].x);
+		_MM_TRANSPOSE4_PS(x0, y0, z0, w0);
+		__m128 x1 = _mm_loadu_ps(&q1[0].x);
+		__m128 y1 = _mm_loadu_ps(&q1[1].x);
+		__m128 z1 = _mm_loadu_ps(&q1[2].x);
+		__m128 w1 = _mm_loadu_ps(&q1[3].x);
+		_MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+
+		// 内積が負ならq1側の重みを反転する
+		__m128 dot = _mm_mul_ps(x0, x1);
+		dot = MathSIMD::MultiplyAdd(y0, y1, dot);
+		dot = MathSIMD::MultiplyAdd(z0, z1, dot);
+		dot = MathSIMD::MultiplyAdd(w0, w1, dot);
+		const __m128 signMask = _mm_and_ps(dot, _mm_set1_ps(-0.0f));
+		weight1 = _mm_xor_ps(weight1, signMask);
+
+		__m128 x = MathSIMD::MultiplyAdd(x1, weight1, _mm_mul_ps(x0, weight0));
+		__m128 y = MathSIMD::MultiplyAdd(y1, weight1, _mm_mul_ps(y0, weight0));
+		__m128 z = MathSIMD::MultiplyAdd(z1, weight1, _mm_mul_ps(z0, weight0));
+		__m128 w = MathSIMD::MultiplyAdd(w1, weight1, _mm_mul_ps(w0, weight0));
+
+		// 正規化（QuaternionMath::Normalizeと同じく、長さが0なら単位クォータニオンにする）
+		__m128 lengthSq = _mm_mul_ps(x, x);
+		lengthSq = MathSIMD::MultiplyAdd(y, y, lengthSq);
+		lengthSq = MathSIMD::MultiplyAdd(z, z, lengthSq);
+		lengthSq = MathSIMD::MultiplyAdd(w, w, lengthSq);
+		const __m128 isValid = _mm_cmpgt_ps(lengthSq, _mm_setzero_ps());
+		const __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSq));
+		x = _mm_and_ps(isValid, _mm_mul_ps(x, invLength));
+		y = _mm_and_ps(isValid, _mm_mul_ps(y, invLength));
+		z = _mm_and_ps(isValid, _mm_mul_ps(z, invLength));
+		w = _mm_or_ps(_mm_and_ps(isValid, _mm_mul_ps(w, invLength)), _mm_andnot_ps(isValid, _mm_set1_ps(1.0f)));
+
+		// 回転行列の各要素（4つ分）
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+		const __m128 xx = _mm_mul_ps(x, x);
+		const __m128 yy = _mm_mul_ps(y, y);
+		const __m128 zz = _mm_mul_ps(z, z);
+		const __m128 xy = _mm_mul_ps(x, y);
+		const __m128 xz = _mm_mul_ps(x, z);
+		const __m128 yz = _mm_mul_ps(y, z);
+		const __m128 wx = _mm_mul_ps(w, x);
+		const __m128 wy = _mm_mul_ps(w, y);
+		const __m128 wz = _mm_mul_ps(w, z);
+
+		__m128 m00 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+		__m128 m01 = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+		__m128 m02 = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+		__m128 m10 = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+		__m128 m11 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+		__m128 m12 = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+		__m128 m20 = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+		__m128 m21 = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+		__m128 m22 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+		// SoAからAoSへ戻して行ごとに書き込む
+		__m128 zero0 = _mm_setzero_ps();
+		__m128 zero1 = _mm_setzero_ps();
+		__m128 zero2 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(m00, m01, m02, zero0);
+		_MM_TRANSPOSE4_PS(m10, m11, m12, zero1);
+		_MM_TRANSPOSE4_PS(m20, m21, m22, zero2);
+		const __m128 row3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+
+		const __m128 rows0[4] = { m00, m01, m02, zero0 };
+		const __m128 rows1[4] = { m10, m11, m12, zero1 };
+		const __m128 rows2[4] = { m20, m21, m22, zero2 };
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			_mm_storeu_ps(results[lane].m[0], rows0[lane]);
+			_mm_storeu_ps(results[lane].m[1], rows1[lane]);
+			_mm_storeu_ps(results[lane].m[2], rows2[lane]);
+			_mm_storeu_ps(results[lane].m[3], row3);
+		}
+	}
+#endif
+}
+
+// ノルム
+float QuaternionMath::Norm(const Quaternion& q)
+{
+	return std::sqrt(Dot(q, q));
+}
+
+// 正規化
+Quaternion QuaternionMath::Normalize(const Quaternion& q)
+{
+	const float norm = Norm(q);
+	if (norm <= 0.0f)
+	{
+		return MakeIdentity();
+	}
+	return q * (1.0f / norm);
+}
+
+// 逆クォータニオン
+Quaternion QuaternionMath::Inverse(const Quaternion& q)
+{
+	const float normSq = Dot(q, q);
+	if (normSq <= 0.0f)
+	{
+		return MakeIdentity();
+	}
+	return Conjugate(q) * (1.0f / normSq);
+}
+
+// 積
+Quaternion QuaternionMath::Multiply(const Quaternion& q1, const Quaternion& q2)
+{
+	// 行ベクトルの規約に合わせてハミルトン積 q2 ⊗ q1 を計算する
+	const Quaternion& a = q2;
+	const Quaternion& b = q1;
+#if defined(MATH_SIMD_SSE)
+	const __m128 va = _mm_loadu_ps(&a.x);
+	const __m128 vb = _mm_loadu_ps(&b.x);
+
+	// a.w * (bx, by, bz, bw)
+	__m128 r = _mm_mul_ps(MathSIMD::Splat<3>(va), vb);
+	// a.x * (bw, -bz, by, -bx)
+	const __m128 bwzyx = _mm_mul_ps(_mm_shuffle_ps(vb, vb, _MM_SHUFFLE(0, 1, 2, 3)), _mm_setr_ps(1.0f, -1.0f, 1.0f, -1.0f));
+	r = MathSIMD::MultiplyAdd(MathSIMD::Splat<0>(va), bwzyx, r);
+	// a.y * (bz, bw, -bx, -by)
+	const __m128 bzwxy = _mm_mul_ps(_mm_shuffle_ps(vb, vb, _MM_SHUFFLE(1, 0, 3, 2)), _mm_setr_ps(1.0f, 1.0f, -1.0f, -1.0f));
+	r = MathSIMD::MultiplyAdd(MathSIMD::Splat<1>(va), bzwxy, r);
+	// a.z * (-by, bx, bw, -bz)
+	const __m128 byxwz = _mm_mul_ps(_mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 3, 0, 1)), _mm_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f));
+	r = MathSIMD::MultiplyAdd(MathSIMD::Splat<2>(va), byxwz, r);
+
+	Quaternion result;
+	_mm_storeu_ps(&result.x, r);
+	return result;
+#else
+	return
+	{
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+	};
+#endif
+}
+
+// 任意軸回転
+Quaternion QuaternionMath::MakeRotateAxisAngle(const Vector3& axis, float angle)
+{
+	const float s = std::sin(angle * 0.5f);
+	const float c = std::cos(angle * 0.5f);
+	return { axis.x * s, axis.y * s, axis.z * s, c };
+}
+
+// オイラー角から作成
+Quaternion QuaternionMath::MakeFromEuler(const Vector3& rotate)
+{
+	const float sx = std::sin(rotate.x * 0.5f);
+	const float cx = std::cos(rotate.x * 0.5f);
+	const float sy = std::sin(rotate.y * 0.5f);
+	const float cy = std::cos(rotate.y * 0.5f);
+	const float sz = std::sin(rotate.z * 0.5f);
+	const float cz = std::cos(rotate.z * 0.5f);
+
+	// Multiply(Multiply(qx, qy), qz) を展開したもの
+	return
+	{
+		sx * cy * cz - cx * sy * sz,
+		cx * sy * cz + sx * cy * sz,
+		cx * cy * sz - sx * sy * cz,
+		cx * cy * cz + sx * sy * sz
+	};
+}
+
+// ベクトルの回転
+Vector3 QuaternionMath::RotateVector(const Vector3& v, const Quaternion& q)
+{
+	// v' = v + 2w(u×v) + 2u×(u×v)
+	const Vector3 u = { q.x, q.y, q.z };
+	const Vector3 t = VectorMath::Cross(u, v) * 2.0f;
+	return v + t * q.w + VectorMath::Cross(u, t);
+}
+
+// 回転行列
+Matrix4x4 QuaternionMath::MakeRotateMatrix(const Quaternion& q)
+{
+	Matrix4x4 result;
+	WriteRotateMatrix(q.x, q.y, q.z, q.w, result);
+	return result;
+}
+
+// アフィン変換行列
+Matrix4x4 QuaternionMath::MakeAffine(const Vector3& scale, const Quaternion& rotate, const Vector3& translate)
+{
+	Matrix4x4 result;
+	WriteRotateMatrix(rotate.x, rotate.y, rotate.z, rotate.w, result);
+	// 回転行列の各行に拡大率を掛け、4行目に平行移動を入れる
+	const float scales[3] = { scale.x, scale.y, scale.z };
+	for (int row = 0; row < 3; ++row)
+	{
+		result.m[row][0] *= scales[row];
+		result.m[row][1] *= scales[row];
+		result.m[row][2] *= scales[row];
+	}
+	result.m[3][0] = translate.x;
+	result.m[3][1] = translate.y;
+	result.m[3][2] = translate.z;
+	return result;
+}
+
+// 正規化線形補間
+Quaternion QuaternionMath::Nlerp(const Quaternion& q0, const Quaternion& q1, float t)
+{
+	const float sign = Dot(q0, q1) < 0.0f ? -1.0f : 1.0f;
+	return Normalize(q0 * (1.0f - t) + q1 * (t * sign));
+}
+
+// 球面線形補間
+Quaternion QuaternionMath::Slerp(const Quaternion& q0, const Quaternion& q1, float t)
+{
+	float cosTheta = Dot(q0, q1);
+	const float sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+	cosTheta *= sign;
+
+	float weight0 = 0.0f;
+	float weight1 = 0.0f;
+	ComputeSlerpWeights(cosTheta, t, weight0, weight1);
+	return Normalize(q0 * weight0 + q1 * (weight1 * sign));
+}
+
+// まとめてNlerpして回転行列を作る
+void QuaternionMath::NlerpToMatrixBatch(const Quaternion* from, const Quaternion* to, const float* t, Matrix4x4* results, size_t count)
+{
+	assert(count == 0 || (from && to && t && results));
+
+	size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 weight1 = _mm_loadu_ps(&t[i]);
+		const __m128 weight0 = _mm_sub_ps(_mm_set1_ps(1.0f), weight1);
+		BlendedRotateMatrix4(&from[i], &to[i], weight0, weight1, &results[i]);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		WriteBlendedRotateMatrix(from[i], to[i], 1.0f - t[i], t[i], results[i]);
+	}
+}
+
+// まとめてSlerpして回転行列を作る
+void QuaternionMath::SlerpToMatrixBatch(const Quaternion* from, const Quaternion* to, const float* t, Matrix4x4* results, size_t count)
+{
+	assert(count == 0 || (from && to && t && results));
+
+	size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+	for (; i + 4 <= count; i += 4)
+	{
+		// 重みだけ先に求め、補間と行列化は4つまとめて行う
+		float weight0[4];
+		float weight1[4];
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			const float cosTheta = std::fabs(Dot(from[i + lane], to[i + lane]));
+			ComputeSlerpWeights(cosTheta, t[i + lane], weight0[lane], weight1[lane]);
+		}
+		BlendedRotateMatrix4(&from[i], &to[i], _mm_loadu_ps(weight0), _mm_loadu_ps(weight1), &results[i]);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		float weight0 = 0.0f;
+		float weight1 = 0.0f;
+		ComputeSlerpWeights(std::fabs(Dot(from[i], to[i])), t[i], weight0, weight1);
+		WriteBlendedRotateMatrix(from[i], to[i], weight0, weight1, results[i]);
+	}
+}
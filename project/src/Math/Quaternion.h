@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+
+#include "Vector3.h"
+#include "Matrix4x4.h"
+
+// クォータニオン（x, y, zが虚部、wが実部）
+struct Quaternion final
+{
+	float x;
+	float y;
+	float z;
+	float w;
+};
+
+// 二項演算子（要素ごと）
+constexpr Quaternion operator+(const Quaternion& q1, const Quaternion& q2) { return { q1.x + q2.x, q1.y + q2.y, q1.z + q2.z, q1.w + q2.w }; }
+constexpr Quaternion operator-(const Quaternion& q1, const Quaternion& q2) { return { q1.x - q2.x, q1.y - q2.y, q1.z - q2.z, q1.w - q2.w }; }
+constexpr Quaternion operator*(const Quaternion& q, float s) { return { q.x * s, q.y * s, q.z * s, q.w * s }; }
+constexpr Quaternion operator*(float s, const Quaternion& q) { return { q.x * s, q.y * s, q.z * s, q.w * s }; }
+// 単項演算子
+constexpr Quaternion operator-(const Quaternion& q) { return { -q.x, -q.y, -q.z, -q.w }; }
+
+namespace QuaternionMath
+{
+	// 単位クォータニオン
+	constexpr Quaternion MakeIdentity() { return { 0.0f, 0.0f, 0.0f, 1.0f }; }
+	// 共役
+	constexpr Quaternion Conjugate(const Quaternion& q) { return { -q.x, -q.y, -q.z, q.w }; }
+	// 内積
+	constexpr float Dot(const Quaternion& q1, const Quaternion& q2) { return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w; }
+	// ノルム
+	float Norm(const Quaternion& q);
+	// 正規化（長さ0なら単位クォータニオンを返す）
+	Quaternion Normalize(const Quaternion& q);
+	// 逆クォータニオン
+	Quaternion Inverse(const Quaternion& q);
+
+	// 積。q1の回転の後にq2の回転を行うクォータニオンを返す
+	// （MakeRotateMatrix(Multiply(q1, q2)) == Multipty(MakeRotateMatrix(q1), MakeRotateMatrix(q2))）
+	Quaternion Multiply(const Quaternion& q1, const Quaternion& q2);
+
+	// 任意軸回転（axisは正規化済みであること）
+	Quaternion MakeRotateAxisAngle(const Vector3& axis, float angle);
+	// オイラー角から作成（MakeAffineと同じX→Y→Zの順で回転する）
+	Quaternion MakeFromEuler(const Vector3& rotate);
+
+	// ベクトルの回転
+	Vector3 RotateVector(const Vector3& v, const Quaternion& q);
+	// 回転行列
+	Matrix4x4 MakeRotateMatrix(const Quaternion& q);
+	// アフィン変換行列（S * R(q) * T）
+	Matrix4x4 MakeAffine(const Vector3& scale, const Quaternion& rotate, const Vector3& translate);
+
+	// 正規化線形補間（最短経路）
+	Quaternion Nlerp(const Quaternion& q0, const Quaternion& q1, float t);
+	// 球面線形補間（最短経路）
+	Quaternion Slerp(const Quaternion& q0, const Quaternion& q1, float t);
+
+	// キーフレーム間をまとめて補間して回転行列を作る
+	// results[i] = MakeRotateMatrix(Nlerp(from[i], to[i], t[i]))
+	void NlerpToMatrixBatch(const Quaternion* from, const Quaternion* to, const float* t, Matrix4x4* results, size_t count);
+	// results[i] = MakeRotateMatrix(Slerp(from[i], to[i], t[i]))
+	void SlerpToMatrixBatch(const Quaternion* from, const Quaternion* to, const float* t, Matrix4x4* results, size_t count);
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "Vector3.h"
+
+// 拡大縮小・回転（オイラー角）・平行移動
+struct Transform
+{
+	Vector3 scale;
+	Vector3 rotate;
+	Vector3 translate;
+};
@@ -0,0 +1,102 @@
+#include "TransformHierarchy.h"
+#include <algorithm>
+#include <cassert>
+
+// 予約
+void TransformHierarchy::Reserve(size_t count)
+{
+	parents_.reserve(count);
+	locals_.reserve(count);
+	localMatrices_.reserve(count);
+	worldMatrices_.reserve(count);
+	dirtyFlags_.reserve(count);
+}
+
+// ノードの追加
+uint32_t TransformHierarchy::AddNode(const Transform& local, uint32_t parent)
+{
+	const uint32_t index = static_cast<uint32_t>(parents_.size());
+	// 親が先に並んでいないと1回の走査で更新できない
+	assert(parent == kNoParent || parent < index);
+
+	parents_.push_back(parent);
+	locals_.push_back(local);
+	localMatrices_.push_back(MatrixMath::MakeIdentity4x4());
+	worldMatrices_.push_back(MatrixMath::MakeIdentity4x4());
+	dirtyFlags_.push_back(kLocalDirty | kWorldDirty);
+	firstDirty_ = (std::min)(firstDirty_, static_cast<size_t>(index));
+	return index;
+}
+
+// 全ノードを削除
+void TransformHierarchy::Clear()
+{
+	parents_.clear();
+	locals_.clear();
+	localMatrices_.clear();
+	worldMatrices_.clear();
+	dirtyFlags_.clear();
+	firstDirty_ = SIZE_MAX;
+}
+
+// ローカル変換の設定
+void TransformHierarchy::SetLocal(uint32_t index, const Transform& local)
+{
+	assert(index < parents_.size());
+	locals_[index] = local;
+	MarkDirty(index);
+}
+
+// ダーティにする
+void TransformHierarchy::MarkDirty(uint32_t index)
+{
+	assert(index < parents_.size());
+	dirtyFlags_[index] |= kLocalDirty | kWorldDirty;
+	firstDirty_ = (std::min)(firstDirty_, static_cast<size_t>(index));
+}
+
+// ワールド行列の更新
+size_t TransformHierarchy::Update()
+{
+	// 何も変わっていなければ何もしない
+	if (firstDirty_ >= parents_.size())
+	{
+		firstDirty_ = SIZE_MAX;
+		return 0;
+	}
+
+	const size_t count = parents_.size();
+	size_t updateCount = 0;
+
+	// 親は必ず前にあるので、前から順に見れば親の更新は済んでいる
+	for (size_t i = firstDirty_; i < count; ++i)
+	{
+		const uint32_t parent = parents_[i];
+		// 親が更新されたら子のワールド行列も作り直す
+		if (parent != kNoParent && dirtyFlags_[parent])
+		{
+			dirtyFlags_[i] |= kWorldDirty;
+		}
+
+		const uint8_t flags = dirtyFlags_[i];
+		if (!flags)
+		{
+			continue;
+		}
+
+		if (flags & kLocalDirty)
+		{
+			const Transform& local = locals_[i];
+			localMatrices_[i] = MatrixMath::MakeAffine(local.scale, local.rotate, local.translate);
+		}
+		worldMatrices_[i] = parent == kNoParent
+			? localMatrices_[i]
+			: MatrixMath::Multipty(localMatrices_[i], worldMatrices_[parent]);
+		++updateCount;
+	}
+
+	// 子の判定に親のフラグを使うので、走査が終わってからまとめて下ろす
+	std::fill(dirtyFlags_.begin() + firstDirty_, dirtyFlags_.end(), uint8_t(0));
+	firstDirty_ = SIZE_MAX;
+	return updateCount;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Transform.h"
+#include "Matrix4x4.h"
+
+// 親子関係を持つTransformの集まり
+// ノードは親が必ず子より前に来る順（トポロジカル順）で平らな配列に並べる。
+// 変更されたノードとその子孫だけを、前から1回なめるだけでまとめて更新する
+class TransformHierarchy
+{
+public:
+	// 親がないことを表す番号
+	static constexpr uint32_t kNoParent = UINT32_MAX;
+
+	// 予約
+	void Reserve(size_t count);
+	// ノードを追加して番号を返す（親は追加済みのノードであること）
+	uint32_t AddNode(const Transform& local, uint32_t parent = kNoParent);
+	// 全ノードを削除
+	void Clear();
+
+	// ローカル変換の設定（そのノード以下が次のUpdateで更新される）
+	void SetLocal(uint32_t index, const Transform& local);
+	// ローカル変換を直接書き換えたときに呼ぶ
+	void MarkDirty(uint32_t index);
+
+	// 変更されたノードとその子孫のワールド行列を更新し、更新した数を返す
+	size_t Update();
+
+	// getter
+	const Transform& GetLocal(uint32_t index) const { return locals_[index]; }
+	const Matrix4x4& GetWorldMatrix(uint32_t index) const { return worldMatrices_[index]; }
+	uint32_t GetParent(uint32_t index) const { return parents_[index]; }
+	size_t GetNodeCount() const { return parents_.size(); }
+	bool IsDirty(uint32_t index) const { return dirtyFlags_[index] != 0; }
+
+private:
+	// ダーティフラグ
+	enum DirtyFlag : uint8_t
+	{
+		kLocalDirty = 1 << 0, // ローカル行列を作り直す
+		kWorldDirty = 1 << 1, // ワールド行列を作り直す（親が変わった）
+	};
+
+	// 親の番号
+	std::vector<uint32_t> parents_;
+	// ローカル変換
+	std::vector<Transform> locals_;
+	// ローカル行列
+	std::vector<Matrix4x4> localMatrices_;
+	// ワールド行列
+	std::vector<Matrix4x4> worldMatrices_;
+	// ダーティフラグ
+	std::vector<uint8_t> dirtyFlags_;
+
+	// 最初にダーティになっているノードの番号（これより前は更新しなくてよい）
+	size_t firstDirty_ = SIZE_MAX;
+};
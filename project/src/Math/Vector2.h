@@ -1,7 +1,46 @@
 #pragma once
+#include <cmath>
 
 struct Vector2 final
 {
 	float x;
 	float y;
+
+	// 複合代入演算子
+	constexpr Vector2& operator+=(const Vector2& v) { x += v.x; y += v.y; return *this; }
+	constexpr Vector2& operator-=(const Vector2& v) { x -= v.x; y -= v.y; return *this; }
+	constexpr Vector2& operator*=(float s) { x *= s; y *= s; return *this; }
+	constexpr Vector2& operator/=(float s) { x /= s; y /= s; return *this; }
 };
+
+// 二項演算子
+constexpr Vector2 operator+(const Vector2& v1, const Vector2& v2) { return { v1.x + v2.x, v1.y + v2.y }; }
+constexpr Vector2 operator-(const Vector2& v1, const Vector2& v2) { return { v1.x - v2.x, v1.y - v2.y }; }
+constexpr Vector2 operator*(const Vector2& v, float s) { return { v.x * s, v.y * s }; }
+constexpr Vector2 operator*(float s, const Vector2& v) { return { v.x * s, v.y * s }; }
+constexpr Vector2 operator/(const Vector2& v, float s) { return { v.x / s, v.y / s }; }
+// 単項演算子
+constexpr Vector2 operator-(const Vector2& v) { return { -v.x, -v.y }; }
+constexpr bool operator==(const Vector2& v1, const Vector2& v2) { return v1.x == v2.x && v1.y == v2.y; }
+
+namespace VectorMath
+{
+	// 内積
+	constexpr float Dot(const Vector2& v1, const Vector2& v2) { return v1.x * v2.x + v1.y * v2.y; }
+	// 長さの2乗
+	constexpr float LengthSquared(const Vector2& v) { return Dot(v, v); }
+	// 長さ
+	inline float Length(const Vector2& v) { return std::sqrt(LengthSquared(v)); }
+	// 正規化（長さ0ならそのまま返す）
+	inline Vector2 Normalize(const Vector2& v)
+	{
+		const float length = Length(v);
+		return length > 0.0f ? v / length : v;
+	}
+	// 要素ごとの積
+	constexpr Vector2 Multiply(const Vector2& v1, const Vector2& v2) { return { v1.x * v2.x, v1.y * v2.y }; }
+	// a * b + c（要素ごと）
+	constexpr Vector2 MultiplyAdd(const Vector2& a, const Vector2& b, const Vector2& c) { return { a.x * b.x + c.x, a.y * b.y + c.y }; }
+	// 線形補間
+	constexpr Vector2 Lerp(const Vector2& v1, const Vector2& v2, float t) { return v1 + (v2 - v1) * t; }
+}
@@ -1,7 +1,63 @@
 #pragma once
+#include <cmath>
+
 struct Vector3 final
 {
 	float x;
 	float y;
 	float z;
+
+	// 複合代入演算子
+	constexpr Vector3& operator+=(const Vector3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+	constexpr Vector3& operator-=(const Vector3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+	constexpr Vector3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+	constexpr Vector3& operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
 };
+
+// 二項演算子
+constexpr Vector3 operator+(const Vector3& v1, const Vector3& v2) { return { v1.x + v2.x, v1.y + v2.y, v1.z + v2.z }; }
+constexpr Vector3 operator-(const Vector3& v1, const Vector3& v2) { return { v1.x - v2.x, v1.y - v2.y, v1.z - v2.z }; }
+constexpr Vector3 operator*(const Vector3& v, float s) { return { v.x * s, v.y * s, v.z * s }; }
+constexpr Vector3 operator*(float s, const Vector3& v) { return { v.x * s, v.y * s, v.z * s }; }
+constexpr Vector3 operator/(const Vector3& v, float s) { return { v.x / s, v.y / s, v.z / s }; }
+// 単項演算子
+constexpr Vector3 operator-(const Vector3& v) { return { -v.x, -v.y, -v.z }; }
+constexpr bool operator==(const Vector3& v1, const Vector3& v2) { return v1.x == v2.x && v1.y == v2.y && v1.z == v2.z; }
+
+namespace VectorMath
+{
+	// 内積
+	constexpr float Dot(const Vector3& v1, const Vector3& v2) { return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z; }
+	// クロス積
+	constexpr Vector3 Cross(const Vector3& v1, const Vector3& v2)
+	{
+		return
+		{
+			v1.y * v2.z - v1.z * v2.y,
+			v1.z * v2.x - v1.x * v2.z,
+			v1.x * v2.y - v1.y * v2.x
+		};
+	}
+	// 長さの2乗
+	constexpr float LengthSquared(const Vector3& v) { return Dot(v, v); }
+	// 長さ
+	inline float Length(const Vector3& v) { return std::sqrt(LengthSquared(v)); }
+	// 正規化（長さ0ならそのまま返す）
+	inline Vector3 Normalize(const Vector3& v)
+	{
+		const float length = Length(v);
+		return length > 0.0f ? v / length : v;
+	}
+	// 要素ごとの積
+	constexpr Vector3 Multiply(const Vector3& v1, const Vector3& v2) { return { v1.x * v2.x, v1.y * v2.y, v1.z * v2.z }; }
+	// a * b + c（要素ごと）
+	constexpr Vector3 MultiplyAdd(const Vector3& a, const Vector3& b, const Vector3& c) { return { a.x * b.x + c.x, a.y * b.y + c.y, a.z * b.z + c.z }; }
+	// a * s + c
+	constexpr Vector3 MultiplyAdd(const Vector3& a, float s, const Vector3& c) { return { a.x * s + c.x, a.y * s + c.y, a.z * s + c.z }; }
+	// 要素ごとの最小値
+	constexpr Vector3 Min(const Vector3& v1, const Vector3& v2) { return { v1.x < v2.x ? v1.x : v2.x, v1.y < v2.y ? v1.y : v2.y, v1.z < v2.z ? v1.z : v2.z }; }
+	// 要素ごとの最大値
+	constexpr Vector3 Max(const Vector3& v1, const Vector3& v2) { return { v1.x > v2.x ? v1.x : v2.x, v1.y > v2.y ? v1.y : v2.y, v1.z > v2.z ? v1.z : v2.z }; }
+	// 線形補間
+	constexpr Vector3 Lerp(const Vector3& v1, const Vector3& v2, float t) { return v1 + (v2 - v1) * t; }
+}
@@ -1,8 +1,48 @@
 #pragma once
+#include <cmath>
+
 struct Vector4 final
 {
 	float x;
 	float y;
 	float z;
 	float w;
+
+	// 複合代入演算子
+	constexpr Vector4& operator+=(const Vector4& v) { x += v.x; y += v.y; z += v.z; w += v.w; return *this; }
+	constexpr Vector4& operator-=(const Vector4& v) { x -= v.x; y -= v.y; z -= v.z; w -= v.w; return *this; }
+	constexpr Vector4& operator*=(float s) { x *= s; y *= s; z *= s; w *= s; return *this; }
+	constexpr Vector4& operator/=(float s) { x /= s; y /= s; z /= s; w /= s; return *this; }
 };
+
+// 二項演算子
+constexpr Vector4 operator+(const Vector4& v1, const Vector4& v2) { return { v1.x + v2.x, v1.y + v2.y, v1.z + v2.z, v1.w + v2.w }; }
+constexpr Vector4 operator-(const Vector4& v1, const Vector4& v2) { return { v1.x - v2.x, v1.y - v2.y, v1.z - v2.z, v1.w - v2.w }; }
+constexpr Vector4 operator*(const Vector4& v, float s) { return { v.x * s, v.y * s, v.z * s, v.w * s }; }
+constexpr Vector4 operator*(float s, const Vector4& v) { return { v.x * s, v.y * s, v.z * s, v.w * s }; }
+constexpr Vector4 operator/(const Vector4& v, float s) { return { v.x / s, v.y / s, v.z / s, v.w / s }; }
+// 単項演算子
+constexpr Vector4 operator-(const Vector4& v) { return { -v.x, -v.y, -v.z, -v.w }; }
+constexpr bool operator==(const Vector4& v1, const Vector4& v2) { return v1.x == v2.x && v1.y == v2.y && v1.z == v2.z && v1.w == v2.w; }
+
+namespace VectorMath
+{
+	// 内積
+	constexpr float Dot(const Vector4& v1, const Vector4& v2) { return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w; }
+	// 長さの2乗
+	constexpr float LengthSquared(const Vector4& v) { return Dot(v, v); }
+	// 長さ
+	inline float Length(const Vector4& v) { return std::sqrt(LengthSquared(v)); }
+	// 正規化（長さ0ならそのまま返す）
+	inline Vector4 Normalize(const Vector4& v)
+	{
+		const float length = Length(v);
+		return length > 0.0f ? v / length : v;
+	}
+	// 要素ごとの積
+	constexpr Vector4 Multiply(const Vector4& v1, const Vector4& v2) { return { v1.x * v2.x, v1.y * v2.y, v1.z * v2.z, v1.w * v2.w }; }
+	// a * b + c（要素ごと）
+	constexpr Vector4 MultiplyAdd(const Vector4& a, const Vector4& b, const Vector4& c) { return { a.x * b.x + c.x, a.y * b.y + c.y, a.z * b.z + c.z, a.w * b.w + c.w }; }
+	// 線形補間
+	constexpr Vector4 Lerp(const Vector4& v1, const Vector4& v2, float t) { return v1 + (v2 - v1) * t; }
+}
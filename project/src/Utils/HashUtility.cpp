@@ -0,0 +1,109 @@
+#include "HashUtility.h"
+#include <cstring>
+
+namespace
+{
+	constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+	constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+	inline uint64_t RotateLeft(uint64_t value, int shift)
+	{
+		return (value << shift) | (value >> (64 - shift));
+	}
+
+	// 境界に揃っていない位置から読む
+	inline uint64_t Read64(const unsigned char* p)
+	{
+		uint64_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	inline uint32_t Read32(const unsigned char* p)
+	{
+		uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	inline uint64_t Round(uint64_t accumulator, uint64_t input)
+	{
+		accumulator += input * kPrime2;
+		accumulator = RotateLeft(accumulator, 31);
+		return accumulator * kPrime1;
+	}
+
+	inline uint64_t MergeRound(uint64_t accumulator, uint64_t value)
+	{
+		accumulator ^= Round(0, value);
+		return accumulator * kPrime1 + kPrime4;
+	}
+}
+
+// バイト列の64bitハッシュ
+uint64_t HashUtility::ComputeHash64(const void* data, size_t size, uint64_t seed)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	const unsigned char* end = p + size;
+	uint64_t hash;
+
+	if (size >= 32)
+	{
+		// 32バイトずつ4系統に分けて混ぜる
+		uint64_t v1 = seed + kPrime1 + kPrime2;
+		uint64_t v2 = seed + kPrime2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - kPrime1;
+		const unsigned char* limit = end - 32;
+		do
+		{
+			v1 = Round(v1, Read64(p + 0));
+			v2 = Round(v2, Read64(p + 8));
+			v3 = Round(v3, Read64(p + 16));
+			v4 = Round(v4, Read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+		hash = MergeRound(hash, v1);
+		hash = MergeRound(hash, v2);
+		hash = MergeRound(hash, v3);
+		hash = MergeRound(hash, v4);
+	}
+	else
+	{
+		hash = seed + kPrime5;
+	}
+	hash += static_cast<uint64_t>(size);
+
+	// 残りのバイト
+	while (p + 8 <= end)
+	{
+		hash ^= Round(0, Read64(p));
+		hash = RotateLeft(hash, 27) * kPrime1 + kPrime4;
+		p += 8;
+	}
+	if (p + 4 <= end)
+	{
+		hash ^= static_cast<uint64_t>(Read32(p)) * kPrime1;
+		hash = RotateLeft(hash, 23) * kPrime2 + kPrime3;
+		p += 4;
+	}
+	while (p < end)
+	{
+		hash ^= static_cast<uint64_t>(*p) * kPrime5;
+		hash = RotateLeft(hash, 11) * kPrime1;
+		++p;
+	}
+
+	// 最後に全体を混ぜる
+	hash ^= hash >> 33;
+	hash *= kPrime2;
+	hash ^= hash >> 29;
+	hash *= kPrime3;
+	hash ^= hash >> 32;
+	return hash;
+}
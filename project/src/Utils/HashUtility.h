@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// ハッシュ値の計算
+namespace HashUtility
+{
+	// バイト列の64bitハッシュ（XXH64と同じ計算。8バイトずつ4系統で並べて読むので大きいデータでも速い）
+	// ファイルの中身が変わったかどうかの判定などに使う。暗号用ではない
+	uint64_t ComputeHash64(const void* data, size_t size, uint64_t seed = 0);
+};
@@ -0,0 +1,148 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "StringUtility.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		data_ = std::exchange(other.data_, nullptr);
+		size_ = std::exchange(other.size_, 0);
+		isOpen_ = std::exchange(other.isOpen_, false);
+#ifdef _WIN32
+		fileHandle_ = std::exchange(other.fileHandle_, nullptr);
+		mappingHandle_ = std::exchange(other.mappingHandle_, nullptr);
+#endif
+	}
+	return *this;
+}
+
+// ファイルを開いてマップする
+bool MappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	// パスはUTF-8として扱い、ワイド文字版のAPIで開く
+	const std::wstring path = StringUtility::ConvertString(filePath);
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle_ = file;
+	size_ = static_cast<size_t>(fileSize.QuadPart);
+	isOpen_ = true;
+	// 空のファイルはマップできないので、開いただけにする
+	if (size_ == 0)
+	{
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		Close();
+		return false;
+	}
+	mappingHandle_ = mapping;
+
+	data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!data_)
+	{
+		Close();
+		return false;
+	}
+#else
+	const int file = ::open(filePath.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat status = {};
+	if (::fstat(file, &status) != 0)
+	{
+		::close(file);
+		return false;
+	}
+
+	size_ = static_cast<size_t>(status.st_size);
+	isOpen_ = true;
+	if (size_ > 0)
+	{
+		void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapped == MAP_FAILED)
+		{
+			::close(file);
+			size_ = 0;
+			isOpen_ = false;
+			return false;
+		}
+		// 前から順に読むことを伝えて先読みを効かせる
+		::madvise(mapped, size_, MADV_SEQUENTIAL);
+		data_ = static_cast<const char*>(mapped);
+	}
+	// マップしたあとはファイル記述子は不要
+	::close(file);
+#endif
+
+	return true;
+}
+
+// マップを解除して閉じる
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (data_)
+	{
+		UnmapViewOfFile(data_);
+	}
+	if (mappingHandle_)
+	{
+		CloseHandle(static_cast<HANDLE>(mappingHandle_));
+		mappingHandle_ = nullptr;
+	}
+	if (fileHandle_)
+	{
+		CloseHandle(static_cast<HANDLE>(fileHandle_));
+		fileHandle_ = nullptr;
+	}
+#else
+	if (data_)
+	{
+		::munmap(const_cast<char*>(data_), size_);
+	}
+#endif
+	data_ = nullptr;
+	size_ = 0;
+	isOpen_ = false;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// 読み込み専用でメモリにマップしたファイル
+// ファイル全体をコピーせずに、ポインタでそのまま中身を読める
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	// コピー禁止（ムーブは可）
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// ファイルを開いてマップする（失敗したらfalse）
+	bool Open(const std::string& filePath);
+	// マップを解除して閉じる
+	void Close();
+
+	// getter
+	const char* GetData() const { return data_; }
+	size_t GetSize() const { return size_; }
+	bool IsOpen() const { return isOpen_; }
+
+private:
+	// ファイルの中身の先頭
+	const char* data_ = nullptr;
+	// ファイルサイズ
+	size_t size_ = 0;
+	// 開いているか（空のファイルはdata_がnullptrのまま開いた扱いにする）
+	bool isOpen_ = false;
+
+#ifdef _WIN32
+	// ファイルハンドルとマッピングハンドル（Windows.hを公開しないためvoid*で持つ）
+	void* fileHandle_ = nullptr;
+	void* mappingHandle_ = nullptr;
+#endif
+};
@@ -0,0 +1,1428 @@
+// 数学ライブラリ（src/Math）のマイクロベンチマーク
+// 結果はJSONで標準出力に、読みやすい表は標準エラーに出す
+// 精度チェックには、数学ライブラリの上に作ったCPUだけのメッシュ処理（メッシュレットのカリング）の確認も含める
+//
+// 使い方:
+//   MathBenchmark [--filter=名前の一部] [--min-time-ms=200] [--check] [--check-speed]
+//   --check を付けると精度チェックに失敗したときに終了コード1を返す
+//   --check-speed を付けると速度の比較（計測のばらつきで結果が変わる）も失敗に含める
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include "Matrix4x4.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+#include "FastTrig.h"
+#include "Culling.h"
+#include "TransformHierarchy.h"
+#include "MathSIMD.h"
+#include "MeshletUtility.h"
+#include "PrimitiveGenerator.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "VertexCompression.h"
+
+using namespace MatrixMath;
+
+namespace
+{
+	// 1回の呼び出しで処理する要素数（シーン内のオブジェクト数程度）
+	constexpr size_t kElementCount = 1024;
+	// 計測の繰り返し回数（中央値と最小値を出す）
+	constexpr int kSampleCount = 7;
+
+	// 実行オプション
+	struct Options
+	{
+		std::string filter;
+		double minTimeMs = 200.0;
+		bool check = false;
+		bool checkSpeed = false;
+	};
+
+	// 計測結果
+	struct BenchmarkResult
+	{
+		std::string name;
+		uint64_t operations;
+		double nsPerOp;
+		double nsPerOpMin;
+		double opsPerSec;
+	};
+
+	// 精度チェックの結果
+	struct AccuracyResult
+	{
+		std::string name;
+		double maxError;
+		double limit;
+		bool pass;
+	};
+
+	// 速度の比較の結果（fastとslowの時間の比）
+	struct SpeedRatio
+	{
+		std::string name;
+		double ratio;
+	};
+
+	// 計算結果を捨てられないようにする
+	volatile char gSink;
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "g"(&value) : "memory");
+#else
+		gSink = *reinterpret_cast<const volatile char*>(&value);
+		_ReadWriteBarrier();
+#endif
+	}
+
+	// ベンチマークの実行
+	class Runner
+	{
+	public:
+		explicit Runner(const Options& options) : options_(options) {}
+
+		// operationsPerCallはfuncを1回呼んだときに処理する要素数
+		void Run(const std::string& name, size_t operationsPerCall, const std::function<void()>& func)
+		{
+			if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos)
+			{
+				return;
+			}
+
+			using Clock = std::chrono::steady_clock;
+
+			// ウォームアップしながら1サンプルの呼び出し回数を決める
+			uint64_t callsPerSample = 1;
+			const double sampleTimeNs = options_.minTimeMs * 1.0e6 / kSampleCount;
+			for (;;)
+			{
+				const Clock::time_point begin = Clock::now();
+				for (uint64_t call = 0; call < callsPerSample; ++call)
+				{
+					func();
+				}
+				const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+				if (elapsed >= sampleTimeNs || callsPerSample >= (uint64_t(1) << 40))
+				{
+					break;
+				}
+				callsPerSample *= 2;
+			}
+
+			// 計測
+			std::vector<double> samples;
+			samples.reserve(kSampleCount);
+			for (int sample = 0; sample < kSampleCount; ++sample)
+			{
+				const Clock::time_point begin = Clock::now();
+				for (uint64_t call = 0; call < callsPerSample; ++call)
+				{
+					func();
+				}
+				const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+				samples.push_back(elapsed / double(callsPerSample * operationsPerCall));
+			}
+			std::sort(samples.begin(), samples.end());
+
+			BenchmarkResult result;
+			result.name = name;
+			result.operations = callsPerSample * operationsPerCall * kSampleCount;
+			result.nsPerOp = samples[kSampleCount / 2];
+			result.nsPerOpMin = samples.front();
+			result.opsPerSec = 1.0e9 / result.nsPerOp;
+			results_.push_back(result);
+
+			std::fprintf(stderr, "%-40s %10.3f ns/op %14.0f ops/s\n", name.c_str(), result.nsPerOp, result.opsPerSec);
+		}
+
+		// 精度チェック
+		void Check(const std::string& name, double maxError, double limit)
+		{
+			if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos)
+			{
+				return;
+			}
+			const bool pass = maxError <= limit;
+			accuracies_.push_back({ name, maxError, limit, pass });
+			std::fprintf(stderr, "%-40s max error %.3g (limit %.3g) %s\n", name.c_str(), maxError, limit, pass ? "ok" : "FAILED");
+		}
+
+		// 速度の比較（fastとslowの時間の比を記録する）
+		// 別々に計測した結果を比べると、その間に他の処理が割り込んだだけで逆転するので、
+		// 交互に何度も計測してそれぞれの最小値を比べる
+		// それでも共有のビルドエージェントでは比が揺れるので、fastの方が遅いことを失敗にするのは--check-speedのときだけ
+		void CompareSpeed(const std::string& name, const std::function<void()>& fast, const std::function<void()>& slow)
+		{
+			if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos)
+			{
+				return;
+			}
+			constexpr int kRoundCount = 31;
+			constexpr int kCallsPerRound = 16;
+			const auto measure = [](const std::function<void()>& func)
+				{
+					const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+					for (int call = 0; call < kCallsPerRound; ++call)
+					{
+						func();
+					}
+					return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+				};
+			double fastTime = std::numeric_limits<double>::infinity();
+			double slowTime = std::numeric_limits<double>::infinity();
+			for (int round = 0; round < kRoundCount; ++round)
+			{
+				fastTime = (std::min)(fastTime, measure(fast));
+				slowTime = (std::min)(slowTime, measure(slow));
+			}
+			const double ratio = fastTime / slowTime;
+			speedRatios_.push_back({ name, ratio });
+			if (options_.checkSpeed)
+			{
+				Check(name, ratio, 1.0);
+			}
+			else
+			{
+				std::fprintf(stderr, "%-40s %10.3f x\n", name.c_str(), ratio);
+			}
+		}
+
+		// 精度チェックがすべて通ったか
+		bool AllPassed() const
+		{
+			return std::all_of(accuracies_.begin(), accuracies_.end(), [](const AccuracyResult& accuracy) { return accuracy.pass; });
+		}
+
+		// JSONで出力
+		void WriteJson(FILE* file) const
+		{
+			std::fprintf(file, "{\n  \"simd\": \"%s\",\n  \"element_count\": %zu,\n  \"benchmarks\": [\n", SimdName(), kElementCount);
+			for (size_t i = 0; i < results_.size(); ++i)
+			{
+				const BenchmarkResult& result = results_[i];
+				std::fprintf(file, "    {\"name\": \"%s\", \"operations\": %llu, \"ns_per_op\": %.4f, \"ns_per_op_min\": %.4f, \"ops_per_sec\": %.1f}%s\n",
+					result.name.c_str(), static_cast<unsigned long long>(result.operations), result.nsPerOp, result.nsPerOpMin, result.opsPerSec,
+					i + 1 < results_.size() ? "," : "");
+			}
+			std::fprintf(file, "  ],\n  \"accuracy\": [\n");
+			for (size_t i = 0; i < accuracies_.size(); ++i)
+			{
+				const AccuracyResult& accuracy = accuracies_[i];
+				std::fprintf(file, "    {\"name\": \"%s\", \"max_error\": %.6g, \"limit\": %.6g, \"pass\": %s}%s\n",
+					accuracy.name.c_str(), accuracy.maxError, accuracy.limit, accuracy.pass ? "true" : "false",
+					i + 1 < accuracies_.size() ? "," : "");
+			}
+			std::fprintf(file, "  ],\n  \"speed_ratios\": [\n");
+			for (size_t i = 0; i < speedRatios_.size(); ++i)
+			{
+				std::fprintf(file, "    {\"name\": \"%s\", \"ratio\": %.4f}%s\n",
+					speedRatios_[i].name.c_str(), speedRatios_[i].ratio, i + 1 < speedRatios_.size() ? "," : "");
+			}
+			std::fprintf(file, "  ]\n}\n");
+		}
+
+	private:
+		static const char* SimdName()
+		{
+#if defined(MATH_SIMD_AVX2)
+			return "avx2";
+#elif defined(MATH_SIMD_SSE)
+			return "sse";
+#else
+			return "scalar";
+#endif
+		}
+
+		const Options& options_;
+		std::vector<BenchmarkResult> results_;
+		std::vector<AccuracyResult> accuracies_;
+		std::vector<SpeedRatio> speedRatios_;
+	};
+
+	// 行列の要素ごとの差の最大値
+	float MaxDifference(const Matrix4x4& m1, const Matrix4x4& m2)
+	{
+		float result = 0.0f;
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				result = (std::max)(result, std::fabs(m1.m[row][col] - m2.m[row][col]));
+			}
+		}
+		return result;
+	}
+
+	// 倍精度の逆行列（精度チェックの基準、部分ピボット付きGauss-Jordan法）
+	void InverseReference(const Matrix4x4& m, double result[4][4])
+	{
+		double work[4][8];
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				work[row][col] = m.m[row][col];
+				work[row][col + 4] = row == col ? 1.0 : 0.0;
+			}
+		}
+		for (int col = 0; col < 4; ++col)
+		{
+			int pivot = col;
+			for (int row = col + 1; row < 4; ++row)
+			{
+				if (std::fabs(work[row][col]) > std::fabs(work[pivot][col]))
+				{
+					pivot = row;
+				}
+			}
+			for (int k = 0; k < 8; ++k)
+			{
+				std::swap(work[col][k], work[pivot][k]);
+			}
+			const double invPivot = 1.0 / work[col][col];
+			for (int k = 0; k < 8; ++k)
+			{
+				work[col][k] *= invPivot;
+			}
+			for (int row = 0; row < 4; ++row)
+			{
+				if (row == col)
+				{
+					continue;
+				}
+				const double factor = work[row][col];
+				for (int k = 0; k < 8; ++k)
+				{
+					work[row][k] -= factor * work[col][k];
+				}
+			}
+		}
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				result[row][col] = work[row][col + 4];
+			}
+		}
+	}
+
+	// 倍精度の逆行列との相対誤差
+	double InverseRelativeError(const Matrix4x4& m, const Matrix4x4& inverse)
+	{
+		double reference[4][4];
+		InverseReference(m, reference);
+		double maxValue = 0.0;
+		double maxError = 0.0;
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				maxValue = (std::max)(maxValue, std::fabs(reference[row][col]));
+				maxError = (std::max)(maxError, std::fabs(reference[row][col] - inverse.m[row][col]));
+			}
+		}
+		return maxError / maxValue;
+	}
+
+	// 入力データ（ゲーム中のオブジェクトに近い値の分布にする）
+	struct InputData
+	{
+		// アフィン変換のパラメータ
+		std::vector<float> scaleX, scaleY, scaleZ;
+		std::vector<float> rotateX, rotateY, rotateZ;
+		std::vector<float> translateX, translateY, translateZ;
+		// ワールド行列
+		std::vector<Matrix4x4> worlds;
+		// 剛体変換行列（カメラ）
+		std::vector<Matrix4x4> rigids;
+		// ワールドビュー射影行列
+		std::vector<Matrix4x4> wvps;
+		// ベクトル
+		std::vector<Vector3> vectors;
+		// クォータニオン
+		std::vector<Quaternion> quaternionsFrom;
+		std::vector<Quaternion> quaternionsTo;
+		std::vector<float> t;
+		// 透視投影のパラメータ
+		std::vector<float> fovY;
+		std::vector<float> aspectRatio;
+		// 境界（中心と半分の大きさ）
+		std::vector<float> centerX, centerY, centerZ;
+		std::vector<float> extentX, extentY, extentZ;
+
+		AffineSoA GetAffineSoA() const
+		{
+			return
+			{
+				scaleX.data(), scaleY.data(), scaleZ.data(),
+				rotateX.data(), rotateY.data(), rotateZ.data(),
+				translateX.data(), translateY.data(), translateZ.data()
+			};
+		}
+	};
+
+	InputData MakeInputData()
+	{
+		std::mt19937 engine(20240601u);
+		std::uniform_real_distribution<float> scaleDist(0.5f, 2.0f);
+		std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f);
+		std::uniform_real_distribution<float> positionDist(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> unitDist(0.0f, 1.0f);
+
+		InputData data;
+		const Matrix4x4 view = InverseRigid(MakeAffine({ 1.0f, 1.0f, 1.0f }, { 0.3f, 0.2f, 0.0f }, { 0.0f, 10.0f, -150.0f }));
+		const Matrix4x4 projection = PerspectiveFov(0.45f, 1280.0f / 720.0f, 0.1f, 1000.0f);
+		const Matrix4x4 viewProjection = Multipty(view, projection);
+
+		for (size_t i = 0; i < kElementCount; ++i)
+		{
+			data.scaleX.push_back(scaleDist(engine));
+			data.scaleY.push_back(scaleDist(engine));
+			data.scaleZ.push_back(scaleDist(engine));
+			data.rotateX.push_back(angleDist(engine));
+			data.rotateY.push_back(angleDist(engine));
+			data.rotateZ.push_back(angleDist(engine));
+			data.translateX.push_back(positionDist(engine));
+			data.translateY.push_back(positionDist(engine));
+			data.translateZ.push_back(positionDist(engine));
+
+			const Vector3 scale = { data.scaleX[i], data.scaleY[i], data.scaleZ[i] };
+			const Vector3 rotate = { data.rotateX[i], data.rotateY[i], data.rotateZ[i] };
+			const Vector3 translate = { data.translateX[i], data.translateY[i], data.translateZ[i] };
+			data.worlds.push_back(MakeAffine(scale, rotate, translate));
+			data.rigids.push_back(MakeAffine({ 1.0f, 1.0f, 1.0f }, rotate, translate));
+			data.wvps.push_back(Multipty(data.worlds.back(), viewProjection));
+
+			data.vectors.push_back({ positionDist(engine), positionDist(engine), positionDist(engine) });
+			data.quaternionsFrom.push_back(QuaternionMath::MakeFromEuler(rotate));
+			data.quaternionsTo.push_back(QuaternionMath::MakeFromEuler({ angleDist(engine), angleDist(engine), angleDist(engine) }));
+			data.t.push_back(unitDist(engine));
+
+			data.fovY.push_back(0.3f + unitDist(engine));
+			data.aspectRatio.push_back(1.0f + unitDist(engine));
+
+			data.centerX.push_back(data.translateX[i]);
+			data.centerY.push_back(data.translateY[i]);
+			data.centerZ.push_back(data.translateZ[i]);
+			data.extentX.push_back(data.scaleX[i]);
+			data.extentY.push_back(data.scaleY[i]);
+			data.extentZ.push_back(data.scaleZ[i]);
+		}
+		return data;
+	}
+
+	// 行列演算
+	void RunMatrixBenchmarks(Runner& runner, const InputData& data)
+	{
+		std::vector<Matrix4x4> results(kElementCount);
+		const Matrix4x4 viewProjection = data.wvps[0];
+
+		runner.Run("Multipty", kElementCount, [&]()
+			{
+				for (size_t i = 0; i < kElementCount; ++i)
+				{
+					results[i] = Multipty(data.worlds[i], data.wvps[i]);
+				}
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("MultiptyBatch", kElementCount, [&]()
+			{
+				MultiptyBatch(data.worlds.data(), data.wvps.data(), results.data(), kElementCount);
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("MultiptyBatch/shared", kElementCount, [&]()
+			{
+				MultiptyBatch(data.worlds.data(), viewProjection, results.data(), kElementCount);
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("Inverse", kElementCount, [&]()
+			{
+				for (size_t i = 0; i < kElementCount; ++i)
+				{
+					results[i] = Inverse(data.wvps[i]);
+				}
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("InverseBatch", kElementCount, [&]()
+			{
+				InverseBatch(data.wvps.data(), results.data(), kElementCount);
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("InverseAffine", kElementCount, [&]()
+			{
+				for (size_t i = 0; i < kElementCount; ++i)
+				{
+					results[i] = InverseAffine(data.worlds[i]);
+				}
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("InverseRigid", kElementCount, [&]()
+			{
+				for (size_t i = 0; i < kElementCount; ++i)
+				{
+					results[i] = InverseRigid(data.rigids[i]);
+				}
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("Transpoce", kElementCount, [&]()
+			{
+				for (size_t i = 0; i < kElementCount; ++i)
+				{
+					results[i] = Transpoce(data.wvps[i]);
+				}
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("PerspectiveFov", kElementCount, [&]()
+			{
+				for (size_t i = 0; i < kElementCount; ++i)
+				{
+					results[i] = PerspectiveFov(data.fovY[i], data.aspectRatio[i], 0.1f, 1000.0f);
+				}
+				DoNotOptimize(results[0]);
+			});
+
+		// アフィン変換行列の作成（sin/cosの精度ごと）
+		const struct { const char* name; TrigPrecision precision; } precisions[] =
+		{
+			{ "Exact", TrigPrecision::Exact },
+			{ "Precise", TrigPrecision::Precise },
+			{ "Fast", TrigPrecision::Fast },
+		};
+		for (const auto& precision : precisions)
+		{
+			runner.Run(std::string("MakeAffine/") + precision.name, kElementCount, [&]()
+				{
+					for (size_t i = 0; i < kElementCount; ++i)
+					{
+						results[i] = MakeAffine(
+							{ data.scaleX[i], data.scaleY[i], data.scaleZ[i] },
+							{ data.rotateX[i], data.rotateY[i], data.rotateZ[i] },
+							{ data.translateX[i], data.translateY[i], data.translateZ[i] },
+							precision.precision);
+					}
+					DoNotOptimize(results[0]);
+				});
+			runner.Run(std::string("MakeAffineBatch/") + precision.name, kElementCount, [&]()
+				{
+					MakeAffineBatch(data.GetAffineSoA(), results.data(), kElementCount, precision.precision);
+					DoNotOptimize(results[0]);
+				});
+			runner.Run(std::string("MakeRotateX/") + precision.name, kElementCount, [&]()
+				{
+					for (size_t i = 0; i < kElementCount; ++i)
+					{
+						results[i] = MakeRotateX(data.rotateX[i], precision.precision);
+					}
+					DoNotOptimize(results[0]);
+				});
+
+			// sin/cos
+			std::vector<float> sines(kElementCount);
+			std::vector<float> cosines(kElementCount);
+			runner.Run(std::string("SinCosBatch/") + precision.name, kElementCount, [&]()
+				{
+					FastTrig::SinCosBatch(data.rotateX.data(), sines.data(), cosines.data(), kElementCount, precision.precision);
+					DoNotOptimize(sines[0]);
+					DoNotOptimize(cosines[0]);
+				});
+		}
+
+#if defined(MATH_SIMD_SSE)
+		// 特殊な形の逆行列は一般の逆行列より速くなければ使う意味がない
+		// 時間の比はJSONのspeed_ratiosに出す（スカラー版はどちらもスカラーで差が計測のばらつきに埋もれるので比べない）
+		{
+			const auto inverse = [&]()
+				{
+					for (size_t i = 0; i < kElementCount; ++i)
+					{
+						results[i] = Inverse(data.worlds[i]);
+					}
+					DoNotOptimize(results[0]);
+				};
+			runner.CompareSpeed("InverseAffine/fasterThanInverse", [&]()
+				{
+					for (size_t i = 0; i < kElementCount; ++i)
+					{
+						results[i] = InverseAffine(data.worlds[i]);
+					}
+					DoNotOptimize(results[0]);
+				}, inverse);
+			runner.CompareSpeed("InverseRigid/fasterThanInverse", [&]()
+				{
+					for (size_t i = 0; i < kElementCount; ++i)
+					{
+						results[i] = InverseRigid(data.rigids[i]);
+					}
+					DoNotOptimize(results[0]);
+				}, inverse);
+		}
+#endif
+	}
+
+	// ベクトル演算
+	void RunVectorBenchmarks(Runner& runner, const InputData& data)
+	{
+		std::vector<Vector3> results(kElementCount);
+
+		runner.Run("Vector3/Normalize", kElementCount, [&]()
+			{
+				for (size_t i = 0; i < kElementCount; ++i)
+				{
+					results[i] = VectorMath::Normalize(data.vectors[i]);
+				}
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("Vector3/Cross", kElementCount, [&]()
+			{
+				for (size_t i = 0; i + 1 < kElementCount; ++i)
+				{
+					results[i] = VectorMath::Cross(data.vectors[i], data.vectors[i + 1]);
+				}
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("TransformCoord", kElementCount, [&]()
+			{
+				for (size_t i = 0; i < kElementCount; ++i)
+				{
+					results[i] = TransformCoord(data.vectors[i], data.wvps[i]);
+				}
+				DoNotOptimize(results[0]);
+			});
+	}
+
+	// クォータニオン
+	void RunQuaternionBenchmarks(Runner& runner, const InputData& data)
+	{
+		std::vector<Quaternion> results(kElementCount);
+		std::vector<Matrix4x4> matrices(kElementCount);
+
+		runner.Run("Quaternion/Multiply", kElementCount, [&]()
+			{
+				for (size_t i = 0; i < kElementCount; ++i)
+				{
+					results[i] = QuaternionMath::Multiply(data.quaternionsFrom[i], data.quaternionsTo[i]);
+				}
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("Quaternion/Slerp", kElementCount, [&]()
+			{
+				for (size_t i = 0; i < kElementCount; ++i)
+				{
+					results[i] = QuaternionMath::Slerp(data.quaternionsFrom[i], data.quaternionsTo[i], data.t[i]);
+				}
+				DoNotOptimize(results[0]);
+			});
+		runner.Run("Quaternion/NlerpToMatrixBatch", kElementCount, [&]()
+			{
+				QuaternionMath::NlerpToMatrixBatch(data.quaternionsFrom.data(), data.quaternionsTo.data(), data.t.data(), matrices.data(), kElementCount);
+				DoNotOptimize(matrices[0]);
+			});
+		runner.Run("Quaternion/SlerpToMatrixBatch", kElementCount, [&]()
+			{
+				QuaternionMath::SlerpToMatrixBatch(data.quaternionsFrom.data(), data.quaternionsTo.data(), data.t.data(), matrices.data(), kElementCount);
+				DoNotOptimize(matrices[0]);
+			});
+	}
+
+	// カリングに使う視錐台（オブジェクトの一部だけが入るカメラ）
+	Frustum MakeSceneFrustum()
+	{
+		return Culling::ExtractFrustum(Multipty(
+			InverseRigid(MakeAffine({ 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -150.0f })),
+			PerspectiveFov(0.45f, 1280.0f / 720.0f, 0.1f, 1000.0f)));
+	}
+
+	// 親は自分より前のノードからランダムに選んだ階層を作る
+	void BuildHierarchy(const InputData& data, TransformHierarchy& hierarchy)
+	{
+		hierarchy.Clear();
+		hierarchy.Reserve(kElementCount);
+		std::mt19937 engine(7u);
+		for (size_t i = 0; i < kElementCount; ++i)
+		{
+			const uint32_t parent = i == 0 ? TransformHierarchy::kNoParent : static_cast<uint32_t>(engine() % i);
+			hierarchy.AddNode({ { data.scaleX[i], data.scaleY[i], data.scaleZ[i] }, { data.rotateX[i], data.rotateY[i], data.rotateZ[i] }, { data.translateX[i], data.translateY[i], data.translateZ[i] } }, parent);
+		}
+	}
+
+	// カリングと階層更新
+	void RunSceneBenchmarks(Runner& runner, const InputData& data)
+	{
+		const Frustum frustum = MakeSceneFrustum();
+		std::vector<uint32_t> visibleIndices(kElementCount);
+
+		const AABBSoA aabbs = { data.centerX.data(), data.centerY.data(), data.centerZ.data(), data.extentX.data(), data.extentY.data(), data.extentZ.data() };
+		runner.Run("Culling/CullAABBs", kElementCount, [&]()
+			{
+				DoNotOptimize(Culling::CullAABBs(frustum, aabbs, kElementCount, visibleIndices.data()));
+			});
+		const SphereSoA spheres = { data.centerX.data(), data.centerY.data(), data.centerZ.data(), data.extentX.data() };
+		runner.Run("Culling/CullSpheres", kElementCount, [&]()
+			{
+				DoNotOptimize(Culling::CullSpheres(frustum, spheres, kElementCount, visibleIndices.data()));
+			});
+
+		TransformHierarchy hierarchy;
+		BuildHierarchy(data, hierarchy);
+		hierarchy.Update();
+		runner.Run("TransformHierarchy/Update/static", kElementCount, [&]()
+			{
+				DoNotOptimize(hierarchy.Update());
+			});
+		runner.Run("TransformHierarchy/Update/rootDirty", kElementCount, [&]()
+			{
+				hierarchy.MarkDirty(0);
+				DoNotOptimize(hierarchy.Update());
+			});
+	}
+
+	// 精度チェック
+	void RunAccuracyChecks(Runner& runner, const InputData& data)
+	{
+		// sin/cos（libmの倍精度と比べる）
+		// 範囲縮小の誤差は引数が大きいほど増えるので、精度ごとに範囲を広げながら確かめる
+		// （Fastは±100ラジアン、Preciseは±10万ラジアンを超えると計算の仕方が切り替わるので、どちらもその前後を含める）
+		{
+			constexpr size_t kSampleCount = 1 << 18;
+			const struct { const char* name; float range; } ranges[] =
+			{
+				{ "100", 1.0e2f },
+				{ "1e3", 1.0e3f },
+				{ "1e4", 1.0e4f },
+				{ "1e5", 1.0e5f },
+				{ "1e6", 1.0e6f },
+			};
+			std::vector<float> radians(kSampleCount);
+			std::vector<float> sines(kSampleCount);
+			std::vector<float> cosines(kSampleCount);
+
+			const struct { const char* name; TrigPrecision precision; double limit; } precisions[] =
+			{
+				{ "SinCos/Precise", TrigPrecision::Precise, 1.0e-6 },
+				{ "SinCos/Fast", TrigPrecision::Fast, 2.0e-5 },
+			};
+			for (const auto& range : ranges)
+			{
+				for (size_t i = 0; i < kSampleCount; ++i)
+				{
+					radians[i] = -range.range + 2.0f * range.range * float(i) / float(kSampleCount - 1);
+				}
+				for (const auto& precision : precisions)
+				{
+					FastTrig::SinCosBatch(radians.data(), sines.data(), cosines.data(), kSampleCount, precision.precision);
+					double batchError = 0.0;
+					double scalarError = 0.0;
+					for (size_t i = 0; i < kSampleCount; ++i)
+					{
+						const double x = radians[i];
+						batchError = (std::max)(batchError, std::fabs(sines[i] - std::sin(x)));
+						batchError = (std::max)(batchError, std::fabs(cosines[i] - std::cos(x)));
+
+						float sine;
+						float cosine;
+						FastTrig::SinCos(radians[i], sine, cosine, precision.precision);
+						scalarError = (std::max)(scalarError, std::fabs(sine - std::sin(x)));
+						scalarError = (std::max)(scalarError, std::fabs(cosine - std::cos(x)));
+					}
+					const std::string name = std::string(precision.name) + "/" + range.name;
+					runner.Check(name + "/batch", batchError, precision.limit);
+					runner.Check(name + "/scalar", scalarError, precision.limit);
+				}
+			}
+
+			// 象限の丸めはSIMD版（_mm_cvtps_epi32）と同じく、ちょうど半分なら偶数に丸める
+			double roundingMismatch = 0.0;
+			for (int quadrant = -64; quadrant < 64; ++quadrant)
+			{
+				const int32_t expected = quadrant % 2 == 0 ? quadrant : quadrant + 1;
+				if (FastTrig::Detail::RoundToInt(static_cast<float>(quadrant) + 0.5f) != expected)
+				{
+					roundingMismatch = 1.0;
+				}
+			}
+			runner.Check("SinCos/roundToNearestEven", roundingMismatch, 0.0);
+
+			// 範囲縮小できない大きな値・NaN・無限大は、まとめて計算しても1つずつでも標準ライブラリと同じになる
+			std::vector<float> largeRadians = { 2.0e5f, -3.0e6f, 1.0e10f, -4.0e30f, 3.0e38f, std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity() };
+			largeRadians.resize(16, 1.0f);
+			std::vector<float> largeSines(largeRadians.size());
+			std::vector<float> largeCosines(largeRadians.size());
+			// NaNどうしは一致とみなす
+			const auto isSame = [](float a, float b) { return a == b || (std::isnan(a) && std::isnan(b)); };
+			for (const auto& precision : precisions)
+			{
+				FastTrig::SinCosBatch(largeRadians.data(), largeSines.data(), largeCosines.data(), largeRadians.size(), precision.precision);
+				double mismatch = 0.0;
+				for (size_t i = 0; i < 7; ++i)
+				{
+					float sine;
+					float cosine;
+					FastTrig::SinCos(largeRadians[i], sine, cosine, precision.precision);
+					const float exactSine = std::sin(largeRadians[i]);
+					const float exactCosine = std::cos(largeRadians[i]);
+					if (!isSame(sine, exactSine) || !isSame(cosine, exactCosine) || !isSame(largeSines[i], exactSine) || !isSame(largeCosines[i], exactCosine))
+					{
+						mismatch = 1.0;
+					}
+				}
+				runner.Check(std::string(precision.name) + "/outOfRange", mismatch, 0.0);
+			}
+		}
+
+		// 逆行列
+		// ワールド行列は A * A^-1 と単位行列の差を見る。
+		// WVP行列は条件数が大きく、正しく丸めた逆行列でも残差が大きくなるので倍精度の逆行列との相対誤差を見る
+		{
+			const Matrix4x4 identity = MakeIdentity4x4();
+			std::vector<Matrix4x4> inverses(kElementCount);
+			InverseBatch(data.wvps.data(), inverses.data(), kElementCount);
+			float generalError = 0.0f;
+			float affineError = 0.0f;
+			float rigidError = 0.0f;
+			double wvpError = 0.0;
+			double batchError = 0.0;
+			for (size_t i = 0; i < kElementCount; ++i)
+			{
+				generalError = (std::max)(generalError, MaxDifference(Multipty(data.worlds[i], Inverse(data.worlds[i])), identity));
+				affineError = (std::max)(affineError, MaxDifference(Multipty(data.worlds[i], InverseAffine(data.worlds[i])), identity));
+				rigidError = (std::max)(rigidError, MaxDifference(Multipty(data.rigids[i], InverseRigid(data.rigids[i])), identity));
+				wvpError = (std::max)(wvpError, InverseRelativeError(data.wvps[i], Inverse(data.wvps[i])));
+				batchError = (std::max)(batchError, InverseRelativeError(data.wvps[i], inverses[i]));
+			}
+			runner.Check("Inverse/residual", generalError, 1.0e-4);
+			runner.Check("InverseAffine/residual", affineError, 1.0e-4);
+			runner.Check("InverseRigid/residual", rigidError, 1.0e-4);
+			runner.Check("Inverse/wvpRelative", wvpError, 1.0e-2);
+			runner.Check("InverseBatch/wvpRelative", batchError, 1.0e-2);
+		}
+
+		// まとめて計算した結果と1つずつ計算した結果の比較
+		{
+			std::vector<Matrix4x4> results(kElementCount);
+			MakeAffineBatch(data.GetAffineSoA(), results.data(), kElementCount);
+			float affineError = 0.0f;
+			for (size_t i = 0; i < kElementCount; ++i)
+			{
+				affineError = (std::max)(affineError, MaxDifference(results[i], data.worlds[i]));
+			}
+			runner.Check("MakeAffineBatch/vsMakeAffine", affineError, 1.0e-5);
+
+			MultiptyBatch(data.worlds.data(), data.wvps.data(), results.data(), kElementCount);
+			float multiplyError = 0.0f;
+			for (size_t i = 0; i < kElementCount; ++i)
+			{
+				multiplyError = (std::max)(multiplyError, MaxDifference(results[i], Multipty(data.worlds[i], data.wvps[i])));
+			}
+			runner.Check("MultiptyBatch/vsMultipty", multiplyError, 1.0e-4);
+
+			// 4つずつまとめる逆行列は、端数と特異な行列（単位行列になる）が混ざっても1つずつと同じ結果になる
+			std::vector<Matrix4x4> matrices(data.worlds.begin(), data.worlds.end() - 1);
+			for (size_t i = 0; i < matrices.size(); i += 7)
+			{
+				matrices[i].m[2][0] = matrices[i].m[2][1] = matrices[i].m[2][2] = 0.0f;
+			}
+			InverseBatch(matrices.data(), results.data(), matrices.size());
+			float inverseError = 0.0f;
+			for (size_t i = 0; i < matrices.size(); ++i)
+			{
+				inverseError = (std::max)(inverseError, MaxDifference(results[i], Inverse(matrices[i])));
+			}
+			runner.Check("InverseBatch/vsInverse", inverseError, 1.0e-4);
+
+			float quaternionError = 0.0f;
+			for (size_t i = 0; i < kElementCount; ++i)
+			{
+				const Matrix4x4 rotateMatrix = MakeAffine({ 1.0f, 1.0f, 1.0f }, { data.rotateX[i], data.rotateY[i], data.rotateZ[i] }, { 0.0f, 0.0f, 0.0f });
+				quaternionError = (std::max)(quaternionError, MaxDifference(QuaternionMath::MakeRotateMatrix(data.quaternionsFrom[i]), rotateMatrix));
+			}
+			runner.Check("Quaternion/MakeFromEuler", quaternionError, 1.0e-5);
+
+			// 補間して行列にするまとめての計算と1つずつの計算（端数も含めるため1つ減らす）
+			const size_t interpolateCount = kElementCount - 1;
+			QuaternionMath::NlerpToMatrixBatch(data.quaternionsFrom.data(), data.quaternionsTo.data(), data.t.data(), results.data(), interpolateCount);
+			float nlerpError = 0.0f;
+			for (size_t i = 0; i < interpolateCount; ++i)
+			{
+				const Quaternion q = QuaternionMath::Nlerp(data.quaternionsFrom[i], data.quaternionsTo[i], data.t[i]);
+				nlerpError = (std::max)(nlerpError, MaxDifference(results[i], QuaternionMath::MakeRotateMatrix(q)));
+			}
+			runner.Check("NlerpToMatrixBatch/vsNlerp", nlerpError, 1.0e-5);
+
+			QuaternionMath::SlerpToMatrixBatch(data.quaternionsFrom.data(), data.quaternionsTo.data(), data.t.data(), results.data(), interpolateCount);
+			float slerpError = 0.0f;
+			for (size_t i = 0; i < interpolateCount; ++i)
+			{
+				const Quaternion q = QuaternionMath::Slerp(data.quaternionsFrom[i], data.quaternionsTo[i], data.t[i]);
+				slerpError = (std::max)(slerpError, MaxDifference(results[i], QuaternionMath::MakeRotateMatrix(q)));
+			}
+			runner.Check("SlerpToMatrixBatch/vsSlerp", slerpError, 1.0e-5);
+
+			// 補間した結果の長さが0になるもの（長さ0の入力）や真逆の向きの組は、1つずつの計算と同じく単位クォータニオン・有限の行列になる
+			{
+				const Quaternion q = data.quaternionsFrom[0];
+				const Quaternion zero = { 0.0f, 0.0f, 0.0f, 0.0f };
+				const Quaternion degenerateFrom[8] = { q, zero, zero, q, q, zero, data.quaternionsFrom[1], q };
+				const Quaternion degenerateTo[8] = { q * -1.0f, q, zero, zero, q * -1.0f, q * -1.0f, data.quaternionsTo[1], q };
+				const float degenerateT[8] = { 0.5f, 0.0f, 0.5f, 1.0f, 0.25f, 0.0f, 0.5f, 0.5f };
+				Matrix4x4 degenerateResults[8];
+				float degenerateError = 0.0f;
+				const auto accumulate = [&](const Quaternion& expected, const Matrix4x4& result)
+					{
+						for (int row = 0; row < 4; ++row)
+						{
+							for (int col = 0; col < 4; ++col)
+							{
+								if (!std::isfinite(result.m[row][col]))
+								{
+									degenerateError = std::numeric_limits<float>::infinity();
+								}
+							}
+						}
+						degenerateError = (std::max)(degenerateError, MaxDifference(result, QuaternionMath::MakeRotateMatrix(expected)));
+					};
+				QuaternionMath::NlerpToMatrixBatch(degenerateFrom, degenerateTo, degenerateT, degenerateResults, 8);
+				for (size_t i = 0; i < 8; ++i)
+				{
+					accumulate(QuaternionMath::Nlerp(degenerateFrom[i], degenerateTo[i], degenerateT[i]), degenerateResults[i]);
+				}
+				QuaternionMath::SlerpToMatrixBatch(degenerateFrom, degenerateTo, degenerateT, degenerateResults, 8);
+				for (size_t i = 0; i < 8; ++i)
+				{
+					accumulate(QuaternionMath::Slerp(degenerateFrom[i], degenerateTo[i], degenerateT[i]), degenerateResults[i]);
+				}
+				runner.Check("ToMatrixBatch/degenerate", degenerateError, 1.0e-5);
+			}
+		}
+
+		// まとめてのカリングは1つずつのIsVisibleと同じものを、番号の小さい順に詰めて返す（食い違った数を誤差とする）
+		{
+			const Frustum frustum = MakeSceneFrustum();
+			const size_t cullCount = kElementCount - 3;
+			std::vector<uint32_t> visibleIndices(kElementCount);
+			std::vector<uint32_t> expectedIndices;
+
+			const AABBSoA aabbs = { data.centerX.data(), data.centerY.data(), data.centerZ.data(), data.extentX.data(), data.extentY.data(), data.extentZ.data() };
+			for (size_t i = 0; i < cullCount; ++i)
+			{
+				const Vector3 center = { data.centerX[i], data.centerY[i], data.centerZ[i] };
+				const Vector3 extent = { data.extentX[i], data.extentY[i], data.extentZ[i] };
+				if (Culling::IsVisible(frustum, AABB{ center - extent, center + extent }))
+				{
+					expectedIndices.push_back(static_cast<uint32_t>(i));
+				}
+			}
+			const auto countMismatches = [&](size_t visibleCount)
+				{
+					size_t mismatches = visibleCount > expectedIndices.size() ? visibleCount - expectedIndices.size() : expectedIndices.size() - visibleCount;
+					for (size_t i = 0; i < (std::min)(visibleCount, expectedIndices.size()); ++i)
+					{
+						mismatches += visibleIndices[i] != expectedIndices[i] ? 1 : 0;
+					}
+					// 全部見えている・全部見えていないでは詰め方を確かめられない
+					if (expectedIndices.empty() || expectedIndices.size() == cullCount)
+					{
+						++mismatches;
+					}
+					return static_cast<double>(mismatches);
+				};
+			runner.Check("CullAABBs/vsIsVisible", countMismatches(Culling::CullAABBs(frustum, aabbs, cullCount, visibleIndices.data())), 0.0);
+
+			expectedIndices.clear();
+			const SphereSoA spheres = { data.centerX.data(), data.centerY.data(), data.centerZ.data(), data.extentX.data() };
+			for (size_t i = 0; i < cullCount; ++i)
+			{
+				if (Culling::IsVisible(frustum, Sphere{ { data.centerX[i], data.centerY[i], data.centerZ[i] }, data.extentX[i] }))
+				{
+					expectedIndices.push_back(static_cast<uint32_t>(i));
+				}
+			}
+			runner.Check("CullSpheres/vsIsVisible", countMismatches(Culling::CullSpheres(frustum, spheres, cullCount, visibleIndices.data())), 0.0);
+		}
+
+		// 変更したノードだけを更新した結果は、全ノードを親から順に計算し直した結果と一致する
+		{
+			TransformHierarchy hierarchy;
+			BuildHierarchy(data, hierarchy);
+			hierarchy.Update();
+
+			std::mt19937 engine(11u);
+			std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f);
+			std::vector<Matrix4x4> expected(hierarchy.GetNodeCount());
+			float hierarchyError = 0.0f;
+			for (int round = 0; round < 16; ++round)
+			{
+				// 何か所か変えてから更新する（同じノードを何度も変えたり、根を変えたりもする）
+				const int changeCount = 1 + static_cast<int>(engine() % 32);
+				for (int change = 0; change < changeCount; ++change)
+				{
+					const uint32_t index = static_cast<uint32_t>(engine() % hierarchy.GetNodeCount());
+					Transform local = hierarchy.GetLocal(index);
+					local.rotate = { angleDist(engine), angleDist(engine), angleDist(engine) };
+					local.translate.x += 1.0f;
+					hierarchy.SetLocal(index, local);
+				}
+				hierarchy.Update();
+
+				for (uint32_t i = 0; i < hierarchy.GetNodeCount(); ++i)
+				{
+					const Transform& local = hierarchy.GetLocal(i);
+					const Matrix4x4 localMatrix = MakeAffine(local.scale, local.rotate, local.translate);
+					const uint32_t parent = hierarchy.GetParent(i);
+					expected[i] = parent == TransformHierarchy::kNoParent ? localMatrix : Multipty(localMatrix, expected[parent]);
+					hierarchyError = (std::max)(hierarchyError, MaxDifference(hierarchy.GetWorldMatrix(i), expected[i]));
+				}
+			}
+			runner.Check("TransformHierarchy/Update/vsFullRecompute", hierarchyError, 0.0);
+		}
+	}
+
+	// メッシュ処理のチェックで使う球（同じものをPrimitiveGenerator::Getで使い回す）
+	constexpr PrimitiveDesc kCheckSphereDesc = { PrimitiveShape::Sphere, 48, 24, 0.0f };
+
+	// メッシュレットの分割と、法線の円錐による裏向きの判定
+	void RunMeshletChecks(Runner& runner)
+	{
+		const PrimitiveMesh& sphere = PrimitiveGenerator::Get(kCheckSphereDesc);
+		const size_t indexCount = sphere.indices.size();
+		MeshletData meshletData;
+		MeshletUtility::BuildMeshlets(meshletData, sphere.indices.data(), 0, indexCount, sphere.vertices.data());
+
+		// 上限を超えたメッシュレットの数
+		double limitViolations = 0.0;
+		// インデックスはどれもちょうど1つのメッシュレットに入り、メッシュレットの中の番号から元の番号に戻せる
+		std::vector<uint32_t> coverage(indexCount, 0);
+		double coverageErrors = 0.0;
+		for (const Meshlet& meshlet : meshletData.meshlets)
+		{
+			if (meshlet.vertexCount > MeshletUtility::kMaxVertices || meshlet.triangleCount > MeshletUtility::kMaxTriangles)
+			{
+				limitViolations += 1.0;
+			}
+			for (uint32_t i = 0; i < uint32_t(meshlet.triangleCount) * 3; ++i)
+			{
+				const uint32_t index = meshlet.indexOffset + i;
+				if (index >= indexCount)
+				{
+					coverageErrors += 1.0;
+					continue;
+				}
+				++coverage[index];
+				const uint8_t local = meshletData.triangles[meshlet.triangleOffset + i];
+				if (local >= meshlet.vertexCount || meshletData.vertices[meshlet.vertexOffset + local] != sphere.indices[index])
+				{
+					coverageErrors += 1.0;
+				}
+			}
+		}
+		coverageErrors += static_cast<double>(std::count_if(coverage.begin(), coverage.end(), [](uint32_t count) { return count != 1; }));
+		runner.Check("Meshlet/limits", limitViolations, 0.0);
+		runner.Check("Meshlet/coverage", coverageErrors, 0.0);
+
+		// 球の外のランダムな位置から見て、表を向いた三角形を含むメッシュレットを捨てていないか
+		// 視錐台は全体を含む大きさにして、裏向きの判定だけを確かめる。一度も捨てなければ円錐の判定が動いていないので失敗にする
+		Frustum frustum;
+		const Vector3 axes[3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			frustum.planes[axis * 2] = { axes[axis], 1000.0f };
+			frustum.planes[axis * 2 + 1] = { -axes[axis], 1000.0f };
+		}
+		const Vector3 center = { 5.0f, -2.0f, 7.0f };
+		const float scale = 2.0f;
+		const Matrix4x4 world = MakeAffine({ scale, scale, scale }, { 0.3f, 1.1f, -0.4f }, center);
+		std::vector<Vector3> worldPositions;
+		for (const VertexData& vertex : sphere.vertices)
+		{
+			worldPositions.push_back(TransformCoord({ vertex.position.x, vertex.position.y, vertex.position.z }, world));
+		}
+
+		std::mt19937 engine(5u);
+		std::uniform_real_distribution<float> directionDist(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> distanceDist(1.05f * scale, 20.0f * scale);
+		std::vector<IndexRange> ranges(meshletData.meshlets.size());
+		std::vector<uint8_t> isDrawn(indexCount);
+		double falseCulls = 0.0;
+		size_t culledCount = 0;
+		for (int view = 0; view < 256; ++view)
+		{
+			const Vector3 direction = VectorMath::Normalize(Vector3{ directionDist(engine), directionDist(engine), directionDist(engine) });
+			const Vector3 cameraPosition = center + direction * distanceDist(engine);
+			const size_t rangeCount = MeshletUtility::CullMeshlets(meshletData.meshlets.data(), meshletData.bounds.data(), meshletData.meshlets.size(),
+				world, frustum, cameraPosition, true, ranges.data());
+
+			std::fill(isDrawn.begin(), isDrawn.end(), uint8_t(0));
+			for (size_t range = 0; range < rangeCount; ++range)
+			{
+				std::fill(isDrawn.begin() + ranges[range].indexOffset, isDrawn.begin() + ranges[range].indexOffset + ranges[range].indexCount, uint8_t(1));
+			}
+			for (const Meshlet& meshlet : meshletData.meshlets)
+			{
+				if (isDrawn[meshlet.indexOffset])
+				{
+					continue;
+				}
+				++culledCount;
+				for (uint32_t i = meshlet.indexOffset; i < meshlet.indexOffset + uint32_t(meshlet.triangleCount) * 3; i += 3)
+				{
+					const Vector3& p0 = worldPositions[sphere.indices[i]];
+					const Vector3 normal = VectorMath::Cross(worldPositions[sphere.indices[i + 1]] - p0, worldPositions[sphere.indices[i + 2]] - p0);
+					if (VectorMath::Dot(normal, cameraPosition - p0) > 0.0f)
+					{
+						falseCulls += 1.0;
+						break;
+					}
+				}
+			}
+		}
+		runner.Check("Meshlet/coneNoFalseCull", falseCulls + (culledCount == 0 ? 1.0 : 0.0), 0.0);
+	}
+
+	// 三角形を頂点の中身で表したもの（頂点の並べ替えや番号の付け替えをしても変わらない）
+	using TriangleKey = std::array<float, 27>;
+
+	// indicesの三角形を、周り順を保ったまま一番小さい頂点から始まるように回して並べる
+	std::vector<TriangleKey> MakeTriangleKeys(const std::vector<VertexData>& vertices, const uint32_t* indices, size_t indexCount)
+	{
+		const auto toFloats = [&](uint32_t index)
+			{
+				const VertexData& v = vertices[index];
+				return std::array<float, 9>{ v.position.x, v.position.y, v.position.z, v.position.w, v.texcoord.x, v.texcoord.y, v.normal.x, v.normal.y, v.normal.z };
+			};
+		std::vector<TriangleKey> keys;
+		keys.reserve(indexCount / 3);
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			const std::array<float, 9> corners[3] = { toFloats(indices[i]), toFloats(indices[i + 1]), toFloats(indices[i + 2]) };
+			const size_t first = static_cast<size_t>(std::min_element(corners, corners + 3) - corners);
+			TriangleKey key;
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				std::copy(corners[(first + corner) % 3].begin(), corners[(first + corner) % 3].end(), key.begin() + corner * 9);
+			}
+			keys.push_back(key);
+		}
+		std::sort(keys.begin(), keys.end());
+		return keys;
+	}
+
+	// 頂点の番号がvertexCount以上のインデックスの数
+	double CountOutOfRangeIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount)
+	{
+		return static_cast<double>(std::count_if(indices, indices + indexCount, [&](uint32_t index) { return index >= vertexCount; }));
+	}
+
+	// 同じ位置の頂点をまとめたときに、向きの逆な相手がいない辺の数（閉じていて周り順がそろっていれば0）
+	// UVの継ぎ目で位置が重なる頂点は1つとみなし、まとめてつぶれた三角形は数えない
+	double CountOpenEdges(const std::vector<VertexData>& vertices, const uint32_t* indices, size_t indexCount)
+	{
+		std::map<std::array<float, 3>, uint32_t> positionIds;
+		std::vector<uint32_t> welded(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			const std::array<float, 3> position = { vertices[i].position.x, vertices[i].position.y, vertices[i].position.z };
+			welded[i] = positionIds.emplace(position, static_cast<uint32_t>(positionIds.size())).first->second;
+		}
+		// 辺を小さい番号から見て、正の向きで+1、逆の向きで-1
+		std::map<std::pair<uint32_t, uint32_t>, int> balance;
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			const uint32_t corners[3] = { welded[indices[i]], welded[indices[i + 1]], welded[indices[i + 2]] };
+			if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0])
+			{
+				continue;
+			}
+			for (int edge = 0; edge < 3; ++edge)
+			{
+				const uint32_t a = corners[edge];
+				const uint32_t b = corners[(edge + 1) % 3];
+				balance[{ (std::min)(a, b), (std::max)(a, b) }] += a < b ? 1 : -1;
+			}
+		}
+		double openEdges = 0.0;
+		for (const auto& [edge, count] : balance)
+		{
+			openEdges += std::abs(count);
+		}
+		return openEdges;
+	}
+
+	// 三角形の並べ替えと頂点の並べ直し
+	// 三角形の順番を混ぜた球で、キャッシュの効率が良くなり、三角形の集まりと周り順が変わらず、インデックスが頂点の範囲に収まるか
+	void RunMeshOptimizerChecks(Runner& runner)
+	{
+		const PrimitiveMesh& sphere = PrimitiveGenerator::Get(kCheckSphereDesc);
+		ModelData modelData;
+		modelData.vertices = sphere.vertices;
+		// 生成した順はもともとキャッシュに乗りやすいので、三角形の順番を混ぜてから最適化する
+		std::vector<uint32_t> triangleOrder(sphere.indices.size() / 3);
+		for (uint32_t i = 0; i < triangleOrder.size(); ++i)
+		{
+			triangleOrder[i] = i;
+		}
+		std::mt19937 engine(15u);
+		std::shuffle(triangleOrder.begin(), triangleOrder.end(), engine);
+		for (uint32_t triangle : triangleOrder)
+		{
+			modelData.indices.insert(modelData.indices.end(), sphere.indices.begin() + triangle * 3, sphere.indices.begin() + triangle * 3 + 3);
+		}
+		modelData.submeshes.push_back({ 0, static_cast<uint32_t>(modelData.indices.size()), 0, 0, 0 });
+
+		const std::vector<TriangleKey> trianglesBefore = MakeTriangleKeys(modelData.vertices, modelData.indices.data(), modelData.indices.size());
+		const MeshOptimizationReport report = MeshOptimizer::Optimize(modelData);
+
+		// 最適化の後と前のACMRの比（混ぜた順番からなら大きく下がる）
+		runner.Check("MeshOptimizer/acmrRatio", double(report.after.acmr) / double(report.before.acmr), 0.9);
+		const double outOfRange = CountOutOfRangeIndices(modelData.indices.data(), modelData.indices.size(), modelData.vertices.size());
+		runner.Check("MeshOptimizer/indicesInRange", outOfRange, 0.0);
+		const double changedTriangles = outOfRange > 0.0 ? double(trianglesBefore.size()) :
+			(MakeTriangleKeys(modelData.vertices, modelData.indices.data(), modelData.indices.size()) == trianglesBefore ? 0.0 : 1.0);
+		runner.Check("MeshOptimizer/trianglesPreserved", changedTriangles, 0.0);
+	}
+
+	// LODの生成
+	// 閉じた球から作ったLODごとに、三角形が前のLODより減り、誤差が前のLODより小さくならず、閉じたままで、インデックスが頂点の範囲に収まるか
+	void RunMeshSimplifierChecks(Runner& runner)
+	{
+		const PrimitiveMesh& sphere = PrimitiveGenerator::Get(kCheckSphereDesc);
+		ModelData modelData;
+		modelData.vertices = sphere.vertices;
+		modelData.indices = sphere.indices;
+		modelData.submeshes.push_back({ 0, static_cast<uint32_t>(modelData.indices.size()), 0, 0, 0 });
+		modelData.bounds = { { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } };
+		MeshSimplifier::GenerateLods(modelData);
+
+		// LODが1つもできなければ確かめられないので失敗にする
+		double reductionErrors = modelData.lods.size() < 2 ? 1.0 : 0.0;
+		double errorOrderErrors = 0.0;
+		double openEdges = CountOpenEdges(modelData.vertices, sphere.indices.data(), sphere.indices.size());
+		double outOfRange = 0.0;
+		size_t previousIndexCount = 0;
+		for (size_t level = 0; level < modelData.lods.size(); ++level)
+		{
+			const MeshLod& lod = modelData.lods[level];
+			size_t indexCount = 0;
+			for (uint32_t submesh = lod.submeshOffset; submesh < lod.submeshOffset + lod.submeshCount; ++submesh)
+			{
+				const Submesh& range = modelData.submeshes[submesh];
+				const uint32_t* indices = modelData.indices.data() + range.indexOffset;
+				indexCount += range.indexCount;
+				outOfRange += CountOutOfRangeIndices(indices, range.indexCount, modelData.vertices.size());
+				if (level > 0)
+				{
+					openEdges += CountOpenEdges(modelData.vertices, indices, range.indexCount);
+				}
+			}
+			if (level > 0)
+			{
+				reductionErrors += indexCount < previousIndexCount ? 0.0 : 1.0;
+				errorOrderErrors += lod.error >= modelData.lods[level - 1].error ? 0.0 : 1.0;
+			}
+			previousIndexCount = indexCount;
+		}
+		runner.Check("MeshSimplifier/lodReduction", reductionErrors, 0.0);
+		runner.Check("MeshSimplifier/lodErrorOrder", errorOrderErrors, 0.0);
+		runner.Check("MeshSimplifier/closed", openEdges, 0.0);
+		runner.Check("MeshSimplifier/indicesInRange", outOfRange, 0.0);
+	}
+
+	// 頂点の圧縮
+	// 半精度は表せる値がそのまま戻り、丸めの誤差が半精度の刻みの半分以内か。八面体写像の法線は復元した向きの誤差が上限以内か
+	void RunVertexCompressionChecks(Runner& runner)
+	{
+		// NaN以外の半精度の値は、floatにしてから戻すと同じビットになる
+		double halfMismatches = 0.0;
+		for (uint32_t bits = 0; bits <= 0xFFFF; ++bits)
+		{
+			const uint16_t half = static_cast<uint16_t>(bits);
+			const bool isNaN = (half & 0x7C00) == 0x7C00 && (half & 0x03FF) != 0;
+			if (!isNaN && VertexCompression::FloatToHalf(VertexCompression::HalfToFloat(half)) != half)
+			{
+				halfMismatches += 1.0;
+			}
+		}
+		runner.Check("VertexCompression/half/roundTrip", halfMismatches, 0.0);
+
+		// 正規化数の範囲は相対誤差が2^-11以下、非正規化数の範囲は絶対誤差が2^-25以下（どちらも刻みの半分）
+		std::mt19937 engine(16u);
+		std::uniform_real_distribution<float> exponentDist(-14.0f, 15.99f);
+		std::uniform_real_distribution<float> subnormalDist(-std::ldexp(1.0f, -14), std::ldexp(1.0f, -14));
+		double halfRelativeError = 0.0;
+		double halfSubnormalError = 0.0;
+		for (int i = 0; i < 1 << 20; ++i)
+		{
+			const float value = ((i & 1) ? -1.0f : 1.0f) * (std::min)(std::exp2(exponentDist(engine)), 65504.0f);
+			const float roundTrip = VertexCompression::HalfToFloat(VertexCompression::FloatToHalf(value));
+			halfRelativeError = (std::max)(halfRelativeError, std::abs(double(roundTrip) - double(value)) / std::abs(double(value)));
+			const float subnormal = subnormalDist(engine);
+			const float subnormalRoundTrip = VertexCompression::HalfToFloat(VertexCompression::FloatToHalf(subnormal));
+			halfSubnormalError = (std::max)(halfSubnormalError, std::abs(double(subnormalRoundTrip) - double(subnormal)));
+		}
+		runner.Check("VertexCompression/half/relativeError", halfRelativeError, std::ldexp(1.0, -11));
+		runner.Check("VertexCompression/half/subnormalError", halfSubnormalError, std::ldexp(1.0, -25));
+
+		// 向きが一様になるように正規分布から法線を作り、なす角はdoubleで求める
+		std::normal_distribution<float> normalDist;
+		double maxNormalErrorDegrees = 0.0;
+		for (int i = 0; i < 1000000; ++i)
+		{
+			const Vector3 normal = { normalDist(engine), normalDist(engine), normalDist(engine) };
+			int16_t encoded[2];
+			VertexCompression::EncodeOctahedral(normal, encoded);
+			const Vector3 decoded = VertexCompression::DecodeOctahedral(encoded);
+			const double length = std::sqrt(double(normal.x) * normal.x + double(normal.y) * normal.y + double(normal.z) * normal.z);
+			const double x = normal.x / length;
+			const double y = normal.y / length;
+			const double z = normal.z / length;
+			const double crossX = y * decoded.z - z * decoded.y;
+			const double crossY = z * decoded.x - x * decoded.z;
+			const double crossZ = x * decoded.y - y * decoded.x;
+			const double angle = std::atan2(std::sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ), x * decoded.x + y * decoded.y + z * decoded.z);
+			maxNormalErrorDegrees = (std::max)(maxNormalErrorDegrees, angle * 180.0 / 3.14159265358979323846);
+		}
+		runner.Check("VertexCompression/octahedral/degrees", maxNormalErrorDegrees, 0.04);
+	}
+
+	// プリミティブの形とキャッシュ
+	// 平面以外は閉じていて、どの形も三角形が外（平面は上）を向いているか。Getは同じパラメーターなら作ったものを返すか
+	void RunPrimitiveChecks(Runner& runner)
+	{
+		const struct { const char* name; PrimitiveDesc desc; } shapes[] =
+		{
+			{ "Sphere", { PrimitiveShape::Sphere, 32, 16, 0.0f } },
+			{ "Box", { PrimitiveShape::Box, 4, 0, 0.0f } },
+			{ "Plane", { PrimitiveShape::Plane, 5, 3, 0.0f } },
+			{ "Cylinder", { PrimitiveShape::Cylinder, 24, 3, 0.0f } },
+			{ "Torus", { PrimitiveShape::Torus, 32, 12, 0.25f } },
+		};
+		for (const auto& shape : shapes)
+		{
+			const PrimitiveMesh mesh = PrimitiveGenerator::Create(shape.desc);
+			const std::string name = std::string("Primitive/") + shape.name;
+			if (shape.desc.shape != PrimitiveShape::Plane)
+			{
+				runner.Check(name + "/closed", CountOpenEdges(mesh.vertices, mesh.indices.data(), mesh.indices.size()), 0.0);
+			}
+
+			// 三角形の面の向きと、面の中心から形の芯（トーラスは中心の円、平面は下向き）へ向かう向きが逆か（つぶれた三角形も失敗にする）
+			double inwardTriangles = 0.0;
+			for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+			{
+				Vector3 corners[3];
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const Vector4& position = mesh.vertices[mesh.indices[i + corner]].position;
+					corners[corner] = { position.x, position.y, position.z };
+				}
+				const Vector3 normal = VectorMath::Cross(corners[1] - corners[0], corners[2] - corners[0]);
+				const Vector3 center = (corners[0] + corners[1] + corners[2]) * (1.0f / 3.0f);
+				Vector3 outward = center;
+				if (shape.desc.shape == PrimitiveShape::Plane)
+				{
+					outward = { 0.0f, 1.0f, 0.0f };
+				}
+				else if (shape.desc.shape == PrimitiveShape::Torus)
+				{
+					outward = center - VectorMath::Normalize(Vector3{ center.x, 0.0f, center.z });
+				}
+				if (!(VectorMath::Dot(normal, outward) > 0.0f))
+				{
+					inwardTriangles += 1.0;
+				}
+			}
+			runner.Check(name + "/outward", inwardTriangles, 0.0);
+		}
+
+		// 同じパラメーターなら同じメッシュを返し、形に関係ないパラメーターの違いは無視する
+		double cacheErrors = 0.0;
+		const PrimitiveDesc torusDesc = { PrimitiveShape::Torus, 16, 8, 0.3f };
+		const PrimitiveMesh* torus = &PrimitiveGenerator::Get(torusDesc);
+		cacheErrors += &PrimitiveGenerator::Get(torusDesc) == torus ? 0.0 : 1.0;
+		cacheErrors += &PrimitiveGenerator::Get({ PrimitiveShape::Box, 2, 0, 0.0f }) == &PrimitiveGenerator::Get({ PrimitiveShape::Box, 2, 5, 1.0f }) ? 0.0 : 1.0;
+		cacheErrors += &PrimitiveGenerator::Get({ PrimitiveShape::Sphere, 8, 4, 0.0f }) != &PrimitiveGenerator::Get({ PrimitiveShape::Sphere, 8, 5, 0.0f }) ? 0.0 : 1.0;
+		// 作り直したものは同じ中身
+		const PrimitiveMesh created = PrimitiveGenerator::Create(torusDesc);
+		cacheErrors += torus->indices == created.indices && torus->vertices.size() == created.vertices.size() ? 0.0 : 1.0;
+		PrimitiveGenerator::ClearCache();
+		cacheErrors += PrimitiveGenerator::Get(torusDesc).indices == created.indices ? 0.0 : 1.0;
+		runner.Check("Primitive/cache", cacheErrors, 0.0);
+	}
+
+	// 引数の解析
+	Options ParseOptions(int argc, char** argv)
+	{
+		Options options;
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			if (arg.rfind("--filter=", 0) == 0)
+			{
+				options.filter = arg.substr(std::strlen("--filter="));
+			}
+			else if (arg.rfind("--min-time-ms=", 0) == 0)
+			{
+				options.minTimeMs = std::atof(arg.c_str() + std::strlen("--min-time-ms="));
+			}
+			else if (arg == "--check")
+			{
+				options.check = true;
+			}
+			else if (arg == "--check-speed")
+			{
+				options.check = true;
+				options.checkSpeed = true;
+			}
+			else
+			{
+				std::fprintf(stderr, "usage: %s [--filter=name] [--min-time-ms=200] [--check] [--check-speed]\n", argv[0]);
+				std::exit(2);
+			}
+		}
+		return options;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const Options options = ParseOptions(argc, argv);
+	Runner runner(options);
+	const InputData data = MakeInputData();
+
+	RunMatrixBenchmarks(runner, data);
+	RunVectorBenchmarks(runner, data);
+	RunQuaternionBenchmarks(runner, data);
+	RunSceneBenchmarks(runner, data);
+	RunAccuracyChecks(runner, data);
+	RunMeshletChecks(runner);
+	RunMeshOptimizerChecks(runner);
+	RunMeshSimplifierChecks(runner);
+	RunVertexCompressionChecks(runner);
+	RunPrimitiveChecks(runner);
+
+	runner.WriteJson(stdout);
+
+	if (options.check && !runner.AllPassed())
+	{
+		return 1;
+	}
+	return 0;
+}
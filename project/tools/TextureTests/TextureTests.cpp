@@ -0,0 +1,529 @@
+// テクスチャ周りのうちD3D12を使わない部分のテスト
+// TexturePathTableはランダムな登録・検索・解放を、std::mapで持った正解と比べる
+// TextureStreamerはCPUだけの偽物のバックエンドにつないで、読み込む順番・行ったり来たりしないこと・上限を守ることを確かめる
+//
+// 使い方:
+//   TextureTests [--filter=名前の一部]
+//   失敗したテストがあれば終了コード1を返す
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TexturePathTable.h"
+#include "TextureStreamer.h"
+
+namespace
+{
+	// 実行オプション
+	struct Options
+	{
+		std::string filter;
+	};
+
+	// テストの実行
+	class Runner
+	{
+	public:
+		explicit Runner(const Options& options) : options_(options) {}
+
+		// funcは失敗した数を返す（詳しい内容は標準エラーに出す）
+		void Run(const std::string& name, const std::function<uint32_t()>& func)
+		{
+			if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos)
+			{
+				return;
+			}
+			const uint32_t failureCount = func();
+			std::fprintf(stderr, "[%s] %s", failureCount == 0 ? "  OK  " : " FAIL ", name.c_str());
+			if (failureCount > 0)
+			{
+				std::fprintf(stderr, " (%u failures)", failureCount);
+				++failedTestCount_;
+			}
+			std::fprintf(stderr, "\n");
+		}
+
+		bool AllPassed() const { return failedTestCount_ == 0; }
+
+	private:
+		Options options_;
+		uint32_t failedTestCount_ = 0;
+	};
+
+	// 条件を満たさなければ内容を出して1を返す
+	uint32_t Expect(bool condition, const char* message)
+	{
+		if (condition)
+		{
+			return 0;
+		}
+		std::fprintf(stderr, "    %s\n", message);
+		return 1;
+	}
+
+	// ランダムな登録・検索・解放で、見つかるハンドルと世代が正解と一致する
+	// 同時に登録する数を上限近くまで増やし、ハッシュテーブルの詰め直し（後ろの要素を前にずらす）を何度も通す
+	uint32_t TestPathTableRandom(uint32_t maxCount, uint32_t pathCount, uint32_t operationCount)
+	{
+		uint32_t failureCount = 0;
+		std::mt19937 random(maxCount);
+		TexturePathTable table;
+		table.Initialize(maxCount);
+		std::map<std::string, TextureHandle> liveHandles;
+		std::vector<TextureHandle> deadHandles;
+
+		for (uint32_t operation = 0; operation < operationCount; ++operation)
+		{
+			const std::string path = "Resources/texture" + std::to_string(random() % pathCount) + ".png";
+			const auto live = liveHandles.find(path);
+			const TextureHandle found = table.Find(path);
+			failureCount += Expect(live != liveHandles.end() ? found == live->second : found.generation == 0, "find matches the reference");
+
+			switch (random() % 3)
+			{
+			case 0:
+				// 読み込み（TextureManager::LoadTextureと同じく、なければ登録する）
+				if (live == liveHandles.end() && !table.IsFull())
+				{
+					const TextureHandle handle = table.Insert(path);
+					failureCount += Expect(handle.index < maxCount && handle.generation != 0, "inserted handle in range");
+					failureCount += Expect(table.Find(path) == handle, "inserted path is found");
+					liveHandles[path] = handle;
+				}
+				break;
+			case 1:
+				// 解放
+				if (live != liveHandles.end())
+				{
+					table.Remove(live->second);
+					failureCount += Expect(!table.IsValid(live->second), "removed handle is invalid");
+					failureCount += Expect(table.Find(path).generation == 0, "removed path is not found");
+					deadHandles.push_back(live->second);
+					liveHandles.erase(live);
+				}
+				break;
+			default:
+				// 解放したハンドルは、番号が使い回されても無効のまま
+				if (!deadHandles.empty())
+				{
+					failureCount += Expect(!table.IsValid(deadHandles[random() % deadHandles.size()]), "stale handle stays invalid");
+				}
+				break;
+			}
+		}
+
+		// 残っているものは全部見つかり、番号は重ならない
+		std::vector<bool> isIndexUsed(maxCount, false);
+		for (const auto& [path, handle] : liveHandles)
+		{
+			failureCount += Expect(table.IsValid(handle) && table.Find(path) == handle, "live handle is found");
+			failureCount += Expect(!isIndexUsed[handle.index], "indices are unique");
+			isIndexUsed[handle.index] = true;
+		}
+		failureCount += Expect(table.GetIndexCount() <= maxCount, "index count within the capacity");
+		return failureCount;
+	}
+
+	// BC圧縮（4x4画素で16バイト）のミップごとのバイト数
+	std::vector<uint64_t> MakeMipSizes(uint32_t width, uint32_t height)
+	{
+		std::vector<uint64_t> mipSizes;
+		for (;;)
+		{
+			mipSizes.push_back(uint64_t((width + 3) / 4) * ((height + 3) / 4) * 16);
+			if (width == 1 && height == 1)
+			{
+				break;
+			}
+			width = (std::max)(1u, width / 2);
+			height = (std::max)(1u, height / 2);
+		}
+		return mipSizes;
+	}
+
+	// CPUだけの偽物のバックエンド（TextureManagerと同じく、ミップを変えるたびに残すミップを全部転送したとみなす）
+	class MockBackend : public TextureStreamingBackend
+	{
+	public:
+		void SetResidentMip(uint32_t textureId, uint32_t mostDetailedMip) override
+		{
+			const std::vector<uint64_t>& mipSizes = mipSizes_.at(textureId);
+			for (uint32_t mip = mostDetailedMip; mip < mipSizes.size(); ++mip)
+			{
+				uploadedBytes_ += mipSizes[mip];
+			}
+			// 細かくしたか（読み込み）、粗くしたか（解放）
+			const auto found = residentMips_.find(textureId);
+			if (found != residentMips_.end() && mostDetailedMip < found->second)
+			{
+				++loadCount_;
+			}
+			residentMips_[textureId] = mostDetailedMip;
+			calls_.push_back(textureId);
+		}
+
+		// テクスチャを登録する（ミップテールの転送も、そのフレームの転送として数える）
+		void Register(TextureStreamer& streamer, uint32_t textureId, uint32_t width, uint32_t height, const std::vector<uint64_t>& mipSizes)
+		{
+			mipSizes_[textureId] = mipSizes;
+			streamer.Register(textureId, width, height, mipSizes.data(), static_cast<uint32_t>(mipSizes.size()));
+		}
+		void Unregister(TextureStreamer& streamer, uint32_t textureId)
+		{
+			streamer.Unregister(textureId);
+			mipSizes_.erase(textureId);
+			residentMips_.erase(textureId);
+		}
+
+		// 1回のUpdateの分を数え直す
+		void BeginUpdate()
+		{
+			uploadedBytes_ = 0;
+			loadCount_ = 0;
+			calls_.clear();
+		}
+
+		// 置いているミップの合計
+		uint64_t ComputeResidentBytes() const
+		{
+			uint64_t residentBytes = 0;
+			for (const auto& [textureId, residentMip] : residentMips_)
+			{
+				const std::vector<uint64_t>& mipSizes = mipSizes_.at(textureId);
+				for (uint32_t mip = residentMip; mip < mipSizes.size(); ++mip)
+				{
+					residentBytes += mipSizes[mip];
+				}
+			}
+			return residentBytes;
+		}
+
+		uint32_t GetResidentMip(uint32_t textureId) const { return residentMips_.at(textureId); }
+		uint64_t GetUploadedBytes() const { return uploadedBytes_; }
+		uint32_t GetLoadCount() const { return loadCount_; }
+		const std::vector<uint32_t>& GetCalls() const { return calls_; }
+
+	private:
+		std::map<uint32_t, std::vector<uint64_t>> mipSizes_;
+		std::map<uint32_t, uint32_t> residentMips_;
+		uint64_t uploadedBytes_ = 0;
+		uint32_t loadCount_ = 0;
+		std::vector<uint32_t> calls_;
+	};
+
+	// ミップを全部持ったときのバイト数
+	uint64_t SumBytes(const std::vector<uint64_t>& mipSizes, uint32_t firstMip = 0)
+	{
+		uint64_t bytes = 0;
+		for (uint32_t mip = firstMip; mip < mipSizes.size(); ++mip)
+		{
+			bytes += mipSizes[mip];
+		}
+		return bytes;
+	}
+
+	// ぼやけて見えているもの（拡大率が大きいもの）から読み込む
+	uint32_t TestStreamerPriorityOrder()
+	{
+		uint32_t failureCount = 0;
+		const std::vector<uint64_t> mipSizes = MakeMipSizes(1024, 1024);
+		MockBackend backend;
+		TextureStreamer streamer;
+		// 1回のUpdateで、ミップ1から下を1枚分しか転送できない
+		streamer.Initialize(&backend, 1ull << 30, SumBytes(mipSizes, 1));
+		for (uint32_t textureId = 0; textureId < 3; ++textureId)
+		{
+			backend.Register(streamer, textureId, 1024, 1024, mipSizes);
+		}
+		// 登録したミップテールの転送はこのフレームで済ませる
+		streamer.Update();
+
+		// ミップテール（64）での拡大率は0が8、1が16、2が4
+		const float screenSizes[] = { 512.0f, 1024.0f, 256.0f };
+		const uint32_t expectedOrder[] = { 1, 0, 2 };
+		for (uint32_t expectedId : expectedOrder)
+		{
+			for (uint32_t textureId = 0; textureId < 3; ++textureId)
+			{
+				streamer.ReportUsage(textureId, screenSizes[textureId]);
+			}
+			backend.BeginUpdate();
+			streamer.Update();
+			failureCount += Expect(backend.GetCalls() == std::vector<uint32_t>{ expectedId }, "one texture per update, blurriest first");
+			failureCount += Expect(streamer.GetResidentMip(expectedId) == streamer.GetWantedMip(expectedId), "loaded up to the wanted mip");
+		}
+		return failureCount;
+	}
+
+	// 捨てる側が十分安いときだけほかのテクスチャのために捨て、落ち着いたら何もしない
+	uint32_t TestStreamerHysteresis()
+	{
+		uint32_t failureCount = 0;
+		const std::vector<uint64_t> mipSizes = MakeMipSizes(1024, 1024);
+		MockBackend backend;
+		TextureStreamer streamer;
+		// 2枚は全部置けて、3枚目はミップテールだけ
+		streamer.Initialize(&backend, SumBytes(mipSizes) * 2 + SumBytes(mipSizes, 4), 1ull << 30);
+		for (uint32_t textureId = 0; textureId < 3; ++textureId)
+		{
+			backend.Register(streamer, textureId, 1024, 1024, mipSizes);
+		}
+		for (uint32_t frame = 0; frame < 4; ++frame)
+		{
+			streamer.ReportUsage(0, 1024.0f);
+			streamer.ReportUsage(1, 1024.0f);
+			streamer.Update();
+		}
+		failureCount += Expect(streamer.GetResidentMip(0) == 0 && streamer.GetResidentMip(1) == 0, "visible textures fully loaded");
+
+		// 2の拡大率（128の大きさ）はミップを捨てたときの0と1の拡大率（2）の2倍に届かないので、捨てない
+		for (uint32_t frame = 0; frame < 50; ++frame)
+		{
+			streamer.ReportUsage(0, 1024.0f);
+			streamer.ReportUsage(1, 1024.0f);
+			streamer.ReportUsage(2, 128.0f);
+			backend.BeginUpdate();
+			streamer.Update();
+			failureCount += Expect(backend.GetCalls().empty(), "no eviction below the hysteresis");
+		}
+
+		// 2の拡大率（1024の大きさ）が十分大きくなれば捨てて読み込み、そのあとは落ち着く
+		for (uint32_t frame = 0; frame < 4; ++frame)
+		{
+			streamer.ReportUsage(0, 1024.0f);
+			streamer.ReportUsage(1, 1024.0f);
+			streamer.ReportUsage(2, 1024.0f);
+			streamer.Update();
+		}
+		failureCount += Expect(streamer.GetResidentMip(2) < 4, "evicted for a much blurrier texture");
+		for (uint32_t frame = 0; frame < 50; ++frame)
+		{
+			streamer.ReportUsage(0, 1024.0f);
+			streamer.ReportUsage(1, 1024.0f);
+			streamer.ReportUsage(2, 1024.0f);
+			backend.BeginUpdate();
+			streamer.Update();
+			failureCount += Expect(backend.GetCalls().empty(), "steady state without backend calls");
+		}
+		failureCount += Expect(streamer.GetResidentBytes() <= streamer.GetMemoryBudget(), "within the memory budget");
+		return failureCount;
+	}
+
+	// 捨てても入らない読み込みでは、何も捨てない（捨てたぶんの転送や解放を無駄にしない）
+	uint32_t TestStreamerNoWastedEviction()
+	{
+		uint32_t failureCount = 0;
+		const std::vector<uint64_t> bigMipSizes = MakeMipSizes(1024, 1024);
+		// 0は安く捨てられるが、捨てても1000バイトしか空かない
+		std::vector<uint64_t> smallMipSizes = MakeMipSizes(128, 128);
+		smallMipSizes[0] = 1000;
+		MockBackend backend;
+		TextureStreamer streamer;
+		streamer.Initialize(&backend, SumBytes(smallMipSizes) + SumBytes(bigMipSizes) + SumBytes(bigMipSizes, 4), 1ull << 30);
+		backend.Register(streamer, 0, 128, 128, smallMipSizes);
+		backend.Register(streamer, 1, 1024, 1024, bigMipSizes);
+		backend.Register(streamer, 2, 1024, 1024, bigMipSizes);
+		for (uint32_t frame = 0; frame < 4; ++frame)
+		{
+			streamer.ReportUsage(0, 128.0f);
+			streamer.ReportUsage(1, 2048.0f);
+			streamer.Update();
+		}
+		failureCount += Expect(streamer.GetResidentMip(0) == 0 && streamer.GetResidentMip(1) == 0, "textures fully loaded");
+
+		// 2（拡大率8）のためなら0（捨てたときの拡大率0.25）は捨てられるが、1（4）は捨てられず、0を捨てても足りない
+		streamer.ReportUsage(0, 32.0f);
+		streamer.ReportUsage(1, 2048.0f);
+		streamer.ReportUsage(2, 512.0f);
+		backend.BeginUpdate();
+		streamer.Update();
+		failureCount += Expect(backend.GetCalls().empty(), "no backend calls when the load does not fit");
+		failureCount += Expect(streamer.GetResidentMip(0) == 0, "nothing evicted when the load does not fit");
+		failureCount += Expect(streamer.GetResidentBytes() == backend.ComputeResidentBytes(), "resident bytes match the backend");
+		return failureCount;
+	}
+
+	// 上限を下げたときは、転送の上限に入る分ずつ捨てる
+	uint32_t TestStreamerShrinkBudget()
+	{
+		uint32_t failureCount = 0;
+		const std::vector<uint64_t> mipSizes = MakeMipSizes(1024, 1024);
+		MockBackend backend;
+		TextureStreamer streamer;
+		const uint64_t uploadBudget = SumBytes(mipSizes, 1) * 2;
+		streamer.Initialize(&backend, 1ull << 30, uploadBudget);
+		for (uint32_t textureId = 0; textureId < 16; ++textureId)
+		{
+			backend.Register(streamer, textureId, 1024, 1024, mipSizes);
+		}
+		for (uint32_t frame = 0; frame < 32; ++frame)
+		{
+			for (uint32_t textureId = 0; textureId < 16; ++textureId)
+			{
+				streamer.ReportUsage(textureId, 1024.0f);
+			}
+			streamer.Update();
+		}
+		failureCount += Expect(streamer.GetResidentBytes() == SumBytes(mipSizes) * 16, "all textures fully loaded");
+
+		// 使われなくなったあとで上限を下げる
+		streamer.SetMemoryBudget(SumBytes(mipSizes, 1) * 16);
+		uint32_t updateCount = 0;
+		while (streamer.GetResidentBytes() > streamer.GetMemoryBudget() && updateCount < 64)
+		{
+			backend.BeginUpdate();
+			streamer.Update();
+			failureCount += Expect(backend.GetUploadedBytes() <= uploadBudget || backend.GetCalls().size() == 1, "eviction uploads within the budget");
+			++updateCount;
+		}
+		failureCount += Expect(streamer.GetResidentBytes() <= streamer.GetMemoryBudget(), "back within the memory budget");
+		failureCount += Expect(updateCount > 1, "eviction spread over several updates");
+		failureCount += Expect(streamer.GetResidentBytes() == backend.ComputeResidentBytes(), "resident bytes match the backend");
+		return failureCount;
+	}
+
+	// TextureManager::Updateと同じく、デコードが済んだものを登録してからUpdateする
+	// 登録したミップテールとストリーミングの転送を合わせて、1フレームの転送が上限を超えない
+	uint32_t TestStreamerFrameBudget()
+	{
+		uint32_t failureCount = 0;
+		constexpr uint32_t kTextureCount = 64;
+		const std::vector<uint64_t> mipSizes = MakeMipSizes(1024, 1024);
+		const uint64_t tailBytes = TextureStreamer::GetMipTailBytes(1024, 1024, mipSizes.data(), static_cast<uint32_t>(mipSizes.size()));
+		// 1フレームにミップテールなら10枚、ミップ1から下なら1枚だけ
+		const uint64_t uploadBudget = (std::max)(tailBytes * 10, SumBytes(mipSizes, 1));
+		MockBackend backend;
+		TextureStreamer streamer;
+		streamer.Initialize(&backend, 1ull << 30, uploadBudget);
+
+		uint32_t registeredCount = 0;
+		uint32_t frameCount = 0;
+		for (; frameCount < 256; ++frameCount)
+		{
+			backend.BeginUpdate();
+			// デコードが済んだものは全部そろっているが、上限に入る分だけ登録する
+			while (registeredCount < kTextureCount && streamer.HasUploadBudget(tailBytes))
+			{
+				backend.Register(streamer, registeredCount, 1024, 1024, mipSizes);
+				++registeredCount;
+			}
+			// 欲しいのはミップ1（ちょうど上限と同じ転送量）
+			for (uint32_t textureId = 0; textureId < registeredCount; ++textureId)
+			{
+				streamer.ReportUsage(textureId, 512.0f);
+			}
+			streamer.Update();
+			failureCount += Expect(backend.GetUploadedBytes() <= uploadBudget, "frame uploads within the budget");
+			failureCount += Expect(!backend.GetCalls().empty() || registeredCount == kTextureCount, "registration is never starved");
+
+			if (registeredCount == kTextureCount && backend.GetCalls().empty())
+			{
+				break;
+			}
+		}
+		failureCount += Expect(frameCount > kTextureCount / 10, "registration spread over several frames");
+		for (uint32_t textureId = 0; textureId < kTextureCount; ++textureId)
+		{
+			failureCount += Expect(streamer.GetResidentMip(textureId) == streamer.GetWantedMip(textureId), "every texture loaded to the wanted mip");
+		}
+		return failureCount;
+	}
+
+	// ランダムな登録・報告・上限の変更で、上限と帳簿が崩れない
+	uint32_t TestStreamerRandom()
+	{
+		uint32_t failureCount = 0;
+		constexpr uint32_t kTextureCount = 200;
+		constexpr uint64_t kUploadBudget = 4ull << 20;
+		std::mt19937 random(3);
+		MockBackend backend;
+		TextureStreamer streamer;
+		streamer.Initialize(&backend, 32ull << 20, kUploadBudget);
+		std::vector<bool> isRegistered(kTextureCount, false);
+
+		for (uint32_t frame = 0; frame < 3000; ++frame)
+		{
+			// 登録したミップテールの転送も同じフレームの転送に数える
+			backend.BeginUpdate();
+			const uint32_t changedId = random() % kTextureCount;
+			if (!isRegistered[changedId])
+			{
+				const uint32_t size = 32u << (random() % 7);
+				backend.Register(streamer, changedId, size, size, MakeMipSizes(size, size));
+				isRegistered[changedId] = true;
+			}
+			else if (random() % 20 == 0)
+			{
+				backend.Unregister(streamer, changedId);
+				isRegistered[changedId] = false;
+			}
+			if (random() % 500 == 0)
+			{
+				streamer.SetMemoryBudget((8ull + random() % 32) << 20);
+			}
+			for (uint32_t report = 0; report < 20; ++report)
+			{
+				streamer.ReportUsage(random() % kTextureCount, static_cast<float>(random() % 2048));
+			}
+
+			const bool wasWithinBudget = streamer.GetResidentBytes() <= streamer.GetMemoryBudget();
+			const uint32_t loadCountBefore = backend.GetLoadCount();
+			streamer.Update();
+
+			// 読み込みで上限を超えることはない（超えていたときに捨てきれないのは、転送の上限に入らないときだけ）
+			const bool isWithinBudget = streamer.GetResidentBytes() <= streamer.GetMemoryBudget();
+			failureCount += Expect(isWithinBudget || backend.GetLoadCount() == loadCountBefore, "loads never exceed the memory budget");
+			failureCount += Expect(isWithinBudget || !wasWithinBudget, "update never leaves the memory budget");
+			// 転送は登録の分も含めて上限まで（何も転送しないフレームにならないように、1枚だけなら超えてもよい）
+			failureCount += Expect(backend.GetUploadedBytes() <= kUploadBudget || backend.GetCalls().size() == 1, "uploads within the upload budget");
+			failureCount += Expect(streamer.GetResidentBytes() == backend.ComputeResidentBytes(), "resident bytes match the backend");
+			for (uint32_t textureId = 0; textureId < kTextureCount; ++textureId)
+			{
+				if (isRegistered[textureId] && streamer.GetResidentMip(textureId) != backend.GetResidentMip(textureId))
+				{
+					failureCount += Expect(false, "resident mip matches the backend");
+				}
+			}
+		}
+		return failureCount;
+	}
+
+	// コマンドライン引数の解析
+	Options ParseOptions(int argc, char** argv)
+	{
+		Options options;
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* arg = argv[i];
+			if (std::strncmp(arg, "--filter=", 9) == 0)
+			{
+				options.filter = arg + 9;
+			}
+		}
+		return options;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const Options options = ParseOptions(argc, argv);
+	Runner runner(options);
+
+	// 小さいテーブルは毎回ほぼ満杯にして、長い探索とずらしを通す
+	runner.Run("TexturePathTable/random", [] { return TestPathTableRandom(512, 700, 200000); });
+	runner.Run("TexturePathTable/randomFull", [] { return TestPathTableRandom(64, 80, 200000); });
+	runner.Run("TextureStreamer/priorityOrder", TestStreamerPriorityOrder);
+	runner.Run("TextureStreamer/hysteresis", TestStreamerHysteresis);
+	runner.Run("TextureStreamer/noWastedEviction", TestStreamerNoWastedEviction);
+	runner.Run("TextureStreamer/shrinkBudget", TestStreamerShrinkBudget);
+	runner.Run("TextureStreamer/frameBudget", TestStreamerFrameBudget);
+	runner.Run("TextureStreamer/random", TestStreamerRandom);
+
+	return runner.AllPassed() ? 0 : 1;
+}